@@ -0,0 +1,529 @@
+#include "async_log.h"
+#include "thread_safe_queue.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#define ALOG_OUT_SIZE   (64 * 1024)     // flusher 가 write 한 번에 모으는 양
+#define ALOG_LINE_MAX   2048
+#define ALOG_SKIP       0xFF            // 링 끝에서 남은 칸을 건너뛰라는 표시 (level 자리)
+
+// 링 안의 기록 머리. 뒤에 alog_arg nargs 개, 그 뒤에 복사한 문자열들 (8 바이트 정렬)
+typedef struct
+{
+    uint32_t    size;
+    uint8_t     level;
+    uint8_t     nargs;
+    uint16_t    pad;
+    const char *fmt;
+    long long   ts_ns;      // CLOCK_REALTIME
+} alog_hdr;
+
+typedef struct alog_ring
+{
+    char             *buf;
+    atomic_size_t     head;     // 생산자(소유 스레드)가 쓴 끝
+    atomic_size_t     tail;     // flusher 가 읽은 끝
+    atomic_long       dropped;
+    atomic_int        dead;     // 소유 스레드 종료 → 비우면 flusher 가 해제
+    atomic_int        busy;     // 소유 스레드가 링에 쓰는 중 (alog_shutdown 이 끝나길 기다림)
+    struct alog_ring *next;
+} alog_ring;
+
+atomic_int alog_min_level = ALOG_INFO;
+
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;  // g_rings 목록
+static alog_ring      *g_rings;
+static pthread_key_t   g_key;
+static pthread_once_t  g_key_once = PTHREAD_ONCE_INIT;
+static __thread alog_ring *t_ring;
+
+static atomic_int  g_running;
+static atomic_int  g_stop;
+static pthread_t   g_flusher;
+static int         g_out_fd = 1;
+static int         g_err_fd = 2;
+static atomic_long g_dropped_total;
+
+static const char *LEVEL_NAME[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+// ─── 포맷 (flusher 에서, 또는 init 전 동기 경로) ─────────────────
+
+// 변환 하나(spec = "%-08.3" 처럼 길이 수식어와 변환 문자를 뺀 부분)를 인자로 출력
+static int format_one(char *out, size_t cap, const char *spec, const char *len_mod, char conv,
+                      const alog_arg *a)
+{
+    char f[48];
+
+    switch (conv)
+    {
+    case 'd': case 'i':
+        if (a->type != ALOG_T_INT)
+            break;
+        snprintf(f, sizeof(f), "%sll%c", spec, conv);
+        if (len_mod[0] == '\0')
+            return snprintf(out, cap, f, (long long)(int)a->v.i);
+        if (strcmp(len_mod, "h") == 0)
+            return snprintf(out, cap, f, (long long)(short)a->v.i);
+        if (strcmp(len_mod, "hh") == 0)
+            return snprintf(out, cap, f, (long long)(signed char)a->v.i);
+        return snprintf(out, cap, f, a->v.i);
+    case 'u': case 'o': case 'x': case 'X':
+        if (a->type != ALOG_T_INT)
+            break;
+        snprintf(f, sizeof(f), "%sll%c", spec, conv);
+        if (len_mod[0] == '\0')
+            return snprintf(out, cap, f, (unsigned long long)(unsigned int)a->v.i);
+        if (strcmp(len_mod, "h") == 0)
+            return snprintf(out, cap, f, (unsigned long long)(unsigned short)a->v.i);
+        if (strcmp(len_mod, "hh") == 0)
+            return snprintf(out, cap, f, (unsigned long long)(unsigned char)a->v.i);
+        return snprintf(out, cap, f, (unsigned long long)a->v.i);
+    case 'c':
+        if (a->type != ALOG_T_INT)
+            break;
+        snprintf(f, sizeof(f), "%sc", spec);
+        return snprintf(out, cap, f, (int)a->v.i);
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        if (a->type != ALOG_T_DBL && a->type != ALOG_T_INT)
+            break;
+        snprintf(f, sizeof(f), "%s%c", spec, conv);
+        return snprintf(out, cap, f, a->type == ALOG_T_DBL ? a->v.d : (double)a->v.i);
+    case 's':
+        if (a->type != ALOG_T_STR)
+            break;
+        snprintf(f, sizeof(f), "%ss", spec);
+        return snprintf(out, cap, f, a->v.s ? a->v.s : "(null)");
+    case 'p':
+        if (a->type != ALOG_T_PTR && a->type != ALOG_T_STR)
+            break;
+        snprintf(f, sizeof(f), "%sp", spec);
+        return snprintf(out, cap, f, a->v.p);
+    default:
+        break;
+    }
+    return snprintf(out, cap, "<?>");
+}
+
+// printf 와 같은 모양으로 한 줄을 만듦 (반환 = 쓴 길이, cap 에서 잘림)
+static size_t format_record(char *out, size_t cap, const char *fmt, int nargs, const alog_arg *args)
+{
+    size_t n = 0;
+    int ai = 0;
+    const char *p = fmt;
+
+    while (*p && n + 1 < cap)
+    {
+        char spec[32], len_mod[3] = "";
+        size_t sl = 0, ll = 0;
+
+        if (*p != '%')
+        {
+            out[n++] = *p++;
+            continue;
+        }
+        if (p[1] == '%')
+        {
+            out[n++] = '%';
+            p += 2;
+            continue;
+        }
+        spec[sl++] = *p++;
+        // 플래그, 폭, 정밀도 (* 는 int 인자를 숫자로 바꿔 넣음)
+        while (*p && strchr("-+ #0123456789.*", *p) && sl + 12 < sizeof(spec))
+        {
+            if (*p == '*')
+            {
+                long long v = ai < nargs && args[ai].type == ALOG_T_INT ? args[ai].v.i : 0;
+                ai++;
+                sl += snprintf(spec + sl, sizeof(spec) - sl, "%d", (int)v);
+                p++;
+            }
+            else
+                spec[sl++] = *p++;
+        }
+        spec[sl] = '\0';
+        while (*p && strchr("hlzjtL", *p) && ll < 2)
+            len_mod[ll++] = *p++;
+        len_mod[ll] = '\0';
+        if (*p == '\0')
+            break;
+        char conv = *p++;
+
+        int w = ai < nargs ? format_one(out + n, cap - n, spec, len_mod, conv, &args[ai])
+                           : snprintf(out + n, cap - n, "<?>");
+        ai++;
+        if (w > 0)
+            n += (size_t)w < cap - n ? (size_t)w : cap - n - 1;
+    }
+    out[n] = '\0';
+    return n;
+}
+
+// "HH:MM:SS.uuuuuu LEVEL 메시지\n"
+static size_t format_line(char *out, size_t cap, long long ts_ns, int level, const char *fmt,
+                          int nargs, const alog_arg *args)
+{
+    time_t sec = (time_t)(ts_ns / 1000000000LL);
+    struct tm tm;
+    size_t n;
+
+    localtime_r(&sec, &tm);
+    n = (size_t)snprintf(out, cap, "%02d:%02d:%02d.%06lld %-5s ", tm.tm_hour, tm.tm_min, tm.tm_sec,
+                         ts_ns % 1000000000LL / 1000, LEVEL_NAME[level & 3]);
+    n += format_record(out + n, cap - n - 1, fmt, nargs, args);
+    out[n++] = '\n';
+    return n;
+}
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void write_all(int fd, const char *p, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t w = write(fd, p, len);
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w <= 0)
+            return;
+        p += w;
+        len -= (size_t)w;
+    }
+}
+
+// ─── 스레드별 링 ───────────────────────────────────────────────
+
+static void ring_release(void *arg)
+{
+    alog_ring *ring = (alog_ring *)arg;
+    atomic_store_explicit(&ring->dead, TRUE, memory_order_release);
+    t_ring = NULL;
+}
+
+static void key_create(void)
+{
+    pthread_key_create(&g_key, ring_release);
+}
+
+static alog_ring *ring_get(void)
+{
+    alog_ring *ring = t_ring;
+
+    if (ring != NULL)
+        return ring;
+    ring = calloc(1, sizeof(alog_ring));
+    if (ring == NULL)
+        return NULL;
+    ring->buf = malloc(ALOG_RING_SIZE);
+    if (ring->buf == NULL)
+    {
+        free(ring);
+        return NULL;
+    }
+    pthread_once(&g_key_once, key_create);
+    pthread_setspecific(g_key, ring);
+
+    pthread_mutex_lock(&g_lock);
+    ring->next = g_rings;
+    g_rings = ring;
+    pthread_mutex_unlock(&g_lock);
+    t_ring = ring;
+    return ring;
+}
+
+#define ALIGN8(x) (((x) + 7) & ~(size_t)7)
+
+void alog_write(int level, const char *fmt, int nargs, const alog_arg *args)
+{
+    alog_ring *ring = NULL;
+    size_t slen[8];
+    size_t size = sizeof(alog_hdr) + sizeof(alog_arg) * (size_t)nargs;
+    int i;
+
+    if (atomic_load_explicit(&g_running, memory_order_acquire) && (ring = ring_get()) != NULL)
+    {
+        // busy 를 먼저 세우고 g_running 을 다시 봄 (둘 다 seq_cst). alog_shutdown 은 반대 순서라
+        // 둘 중 하나는 반드시 상대를 봄: 여기서 꺼진 것을 보거나, shutdown 이 busy 를 보고 기다림
+        atomic_store(&ring->busy, TRUE);
+        if (!atomic_load(&g_running))
+        {
+            atomic_store_explicit(&ring->busy, FALSE, memory_order_release);
+            ring = NULL;
+        }
+    }
+    if (ring == NULL)
+    {
+        // flusher 가 없음: 바로 포맷해서 씀
+        char line[ALOG_LINE_MAX];
+        size_t n = format_line(line, sizeof(line), now_ns(), level, fmt, nargs, args);
+        write_all(level >= ALOG_WARN ? g_err_fd : g_out_fd, line, n);
+        return;
+    }
+
+    for (i = 0; i < nargs; i++)
+    {
+        slen[i] = 0;
+        if (args[i].type == ALOG_T_STR && args[i].v.s != NULL)
+        {
+            slen[i] = strnlen(args[i].v.s, ALOG_STR_MAX);
+            size += slen[i] + 1;
+        }
+    }
+    size = ALIGN8(size);
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t off = head & (ALOG_RING_SIZE - 1);
+    size_t skip = ALOG_RING_SIZE - off < size ? ALOG_RING_SIZE - off : 0;   // 끝에 안 들어가면 처음부터
+
+    if (ALOG_RING_SIZE - (head - tail) < skip + size)
+    {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        atomic_store_explicit(&ring->busy, FALSE, memory_order_release);
+        return;
+    }
+    if (skip)
+    {
+        if (skip >= sizeof(alog_hdr))
+        {
+            alog_hdr *mark = (alog_hdr *)(ring->buf + off);
+            mark->size = (uint32_t)skip;
+            mark->level = ALOG_SKIP;
+        }
+        head += skip;
+        off = 0;
+    }
+
+    alog_hdr *hdr = (alog_hdr *)(ring->buf + off);
+    alog_arg *dst = (alog_arg *)(hdr + 1);
+    char *str = (char *)(dst + nargs);
+
+    hdr->size = (uint32_t)size;
+    hdr->level = (uint8_t)level;
+    hdr->nargs = (uint8_t)nargs;
+    hdr->fmt = fmt;
+    hdr->ts_ns = now_ns();
+    for (i = 0; i < nargs; i++)
+    {
+        dst[i] = args[i];
+        if (args[i].type == ALOG_T_STR && args[i].v.s != NULL)
+        {
+            // 문자열은 기록 안으로 복사 (호출자 버퍼는 곧 바뀜). 위치는 기록 시작 기준
+            memcpy(str, args[i].v.s, slen[i]);
+            str[slen[i]] = '\0';
+            dst[i].v.i = str - (char *)hdr;
+            str += slen[i] + 1;
+        }
+    }
+    // 기록 내용 → head 순서 (flusher 는 acquire 로 읽음)
+    atomic_store_explicit(&ring->head, head + size, memory_order_release);
+    atomic_store_explicit(&ring->busy, FALSE, memory_order_release);
+}
+
+// ─── flusher ───────────────────────────────────────────────────
+
+typedef struct
+{
+    char   buf[ALOG_OUT_SIZE];
+    size_t len;
+    int    fd;
+} out_buf;
+
+static void out_flush(out_buf *o)
+{
+    write_all(o->fd, o->buf, o->len);
+    o->len = 0;
+}
+
+static void out_line(out_buf *o, const char *line, size_t n)
+{
+    if (o->len + n > sizeof(o->buf))
+        out_flush(o);
+    memcpy(o->buf + o->len, line, n);
+    o->len += n;
+}
+
+// 링 하나를 비움. 반환 = 처리한 기록 수
+static long drain_ring(alog_ring *ring, out_buf *out, out_buf *err)
+{
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    char line[ALOG_LINE_MAX];
+    alog_arg args[8];
+    long count = 0;
+
+    while (tail != head)
+    {
+        size_t off = tail & (ALOG_RING_SIZE - 1);
+        size_t rest = ALOG_RING_SIZE - off;
+        alog_hdr *hdr = (alog_hdr *)(ring->buf + off);
+
+        // 끝에 남은 칸: 머리가 들어갈 수 없을 만큼 작거나 건너뛰기 표시
+        if (rest < sizeof(alog_hdr) || hdr->level == ALOG_SKIP)
+        {
+            tail += rest;
+            continue;
+        }
+        const alog_arg *src = (const alog_arg *)(hdr + 1);
+        for (int i = 0; i < hdr->nargs; i++)
+        {
+            args[i] = src[i];
+            if (args[i].type == ALOG_T_STR && args[i].v.s != NULL)
+                args[i].v.s = (const char *)hdr + args[i].v.i;
+        }
+        size_t n = format_line(line, sizeof(line), hdr->ts_ns, hdr->level, hdr->fmt, hdr->nargs, args);
+        out_line(hdr->level >= ALOG_WARN ? err : out, line, n);
+        tail += hdr->size;
+        count++;
+    }
+    atomic_store_explicit(&ring->tail, tail, memory_order_release);
+
+    long dropped = atomic_exchange_explicit(&ring->dropped, 0, memory_order_relaxed);
+    if (dropped > 0)
+    {
+        alog_arg a = alog_arg_int(dropped);
+        atomic_fetch_add_explicit(&g_dropped_total, dropped, memory_order_relaxed);
+        size_t n = format_line(line, sizeof(line), now_ns(), ALOG_WARN,
+                               "alog: %ld records dropped (thread log ring full)", 1, &a);
+        out_line(err, line, n);
+    }
+    return count;
+}
+
+// 모든 링을 한 바퀴. 종료한 스레드의 링은 비운 뒤 해제
+static long drain_all(out_buf *out, out_buf *err)
+{
+    alog_ring **pp = NULL;
+    long count = 0;
+
+    pthread_mutex_lock(&g_lock);
+    pp = &g_rings;
+    while (*pp)
+    {
+        alog_ring *ring = *pp;
+        int dead = atomic_load_explicit(&ring->dead, memory_order_acquire);
+        count += drain_ring(ring, out, err);
+        if (dead)
+        {
+            *pp = ring->next;
+            free(ring->buf);
+            free(ring);
+            continue;
+        }
+        pp = &ring->next;
+    }
+    pthread_mutex_unlock(&g_lock);
+    if (out->len)
+        out_flush(out);
+    if (err->len)
+        out_flush(err);
+    return count;
+}
+
+static void *flusher_main(void *arg)
+{
+    out_buf *bufs = (out_buf *)arg;     // [0] = out, [1] = err
+    struct timespec idle = { 0, ALOG_FLUSH_MS * 1000000L };
+
+    while (!atomic_load_explicit(&g_stop, memory_order_acquire))
+    {
+        if (drain_all(&bufs[0], &bufs[1]) == 0)
+            nanosleep(&idle, NULL);
+    }
+    drain_all(&bufs[0], &bufs[1]);
+    free(bufs);
+    return NULL;
+}
+
+// ─── 공개 API ──────────────────────────────────────────────────
+
+int alog_init(int out_fd, int err_fd)
+{
+    const char *env = getenv("ALOG_LEVEL");
+    out_buf *bufs = NULL;
+
+    if (atomic_load(&g_running))
+        return FAIL;
+    if (env)
+    {
+        for (int l = ALOG_DEBUG; l <= ALOG_ERROR; l++)
+            if (strcasecmp(env, LEVEL_NAME[l]) == 0)
+                alog_set_level(l);
+    }
+    bufs = malloc(sizeof(out_buf) * 2);
+    if (bufs == NULL)
+        return FAIL;
+    g_out_fd = bufs[0].fd = out_fd;
+    g_err_fd = bufs[1].fd = err_fd;
+    bufs[0].len = bufs[1].len = 0;
+    atomic_store(&g_stop, FALSE);
+    if (pthread_create(&g_flusher, NULL, flusher_main, bufs) != 0)
+    {
+        free(bufs);
+        return FAIL;
+    }
+    atomic_store_explicit(&g_running, TRUE, memory_order_release);
+    return SUCCESS;
+}
+
+void alog_shutdown(void)
+{
+    if (!atomic_exchange(&g_running, FALSE))
+        return;
+    // 이후 alog_write 는 동기 경로. 꺼지기 직전에 링에 쓰기 시작한 스레드가 head 를 공개할
+    // 때까지 기다린 뒤 flusher 를 멈춤 → 그 기록도 flusher 의 마지막 drain 이 가져감
+    pthread_mutex_lock(&g_lock);
+    for (alog_ring *ring = g_rings; ring != NULL; ring = ring->next)
+    {
+        while (atomic_load(&ring->busy))
+            sched_yield();
+    }
+    pthread_mutex_unlock(&g_lock);
+    atomic_store_explicit(&g_stop, TRUE, memory_order_release);
+    pthread_join(g_flusher, NULL);
+}
+
+void alog_set_level(int level)
+{
+    atomic_store_explicit(&alog_min_level, level, memory_order_relaxed);
+}
+
+long alog_dropped(void)
+{
+    return atomic_load_explicit(&g_dropped_total, memory_order_relaxed);
+}
+
+int alog_rate_ok(alog_rate *rate, int limit, int level, const char *fmt)
+{
+    long now = (long)time(NULL);
+    long window = atomic_load_explicit(&rate->window, memory_order_relaxed);
+
+    if (window != now && atomic_compare_exchange_strong_explicit(&rate->window, &window, now,
+                                                                 memory_order_relaxed,
+                                                                 memory_order_relaxed))
+    {
+        // 새 창을 연 스레드가 지난 창에서 버린 수를 알림
+        int suppressed = atomic_exchange_explicit(&rate->suppressed, 0, memory_order_relaxed);
+        atomic_store_explicit(&rate->count, 0, memory_order_relaxed);
+        if (suppressed > 0)
+            ALOG(level, "(%d more like \"%s\" suppressed)", suppressed, fmt);
+    }
+    if (atomic_fetch_add_explicit(&rate->count, 1, memory_order_relaxed) < limit)
+        return TRUE;
+    atomic_fetch_add_explicit(&rate->suppressed, 1, memory_order_relaxed);
+    return FALSE;
+}
@@ -0,0 +1,121 @@
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <stdatomic.h>
+
+// 비동기 로거: 호출 스레드는 포맷하지 않고 기록만 남김
+//   스레드마다 lock-free SPSC 바이트 링 (첫 로그 때 등록). 기록 = 포맷 문자열 포인터 +
+//   인자 값(문자열은 복사) + 시각. 링이 가득이면 기다리지 않고 버린 수만 셈
+//   flusher 스레드가 모든 링을 돌며 포맷해서 write 한 번에 모아 씀 → 느린 터미널/파이프가
+//   이벤트 루프를 막지 않음
+//   포맷 문자열은 수명이 끝나지 않는 것(문자열 리터럴)이어야 함. 인자는 최대 8 개
+//   지원 변환: d i u o x X c s p f F e E g G a A %% (+ 플래그/폭/정밀도/*, hh h l ll z j t 길이)
+//   alog_init 전이나 alog_shutdown 후에는 호출 스레드에서 바로 포맷해서 씀
+
+enum alog_level
+{
+    ALOG_DEBUG = 0,
+    ALOG_INFO,
+    ALOG_WARN,
+    ALOG_ERROR
+};
+
+#define ALOG_RING_SIZE  (64 * 1024)     // 스레드당 링 (2의 거듭제곱)
+#define ALOG_STR_MAX    256             // 문자열 인자 하나당 복사하는 최대 바이트
+#define ALOG_FLUSH_MS   5               // 링이 모두 비었을 때 flusher 가 쉬는 시간
+
+enum alog_type
+{
+    ALOG_T_INT = 1,
+    ALOG_T_DBL,
+    ALOG_T_PTR,
+    ALOG_T_STR
+};
+
+typedef struct
+{
+    int type;
+    union
+    {
+        long long   i;
+        double      d;
+        const void *p;
+        const char *s;
+    } v;
+} alog_arg;
+
+// 호출 위치마다 하나 (alog_limited 가 static 으로 만듦): 초당 limit 개까지만 통과
+typedef struct
+{
+    atomic_long window;         // 현재 창의 시작 초
+    atomic_int  count;          // 이번 창에서 통과시킨 수
+    atomic_int  suppressed;     // 이번 창에서 버린 수 (다음 창 첫 통과 때 알림)
+} alog_rate;
+
+extern atomic_int alog_min_level;
+
+int  alog_init(int out_fd, int err_fd);     // WARN 이상은 err_fd. ALOG_LEVEL=debug|info|warn|error 로 수준
+void alog_shutdown(void);                   // 남은 기록을 다 쓰고 flusher 종료
+void alog_set_level(int level);
+void alog_write(int level, const char *fmt, int nargs, const alog_arg *args);
+int  alog_rate_ok(alog_rate *rate, int limit, int level, const char *fmt);
+long alog_dropped(void);                    // 지금까지 링이 가득해 버린 기록 수
+
+static inline alog_arg alog_arg_int(long long x) { alog_arg a; a.type = ALOG_T_INT; a.v.i = x; return a; }
+static inline alog_arg alog_arg_dbl(double x)    { alog_arg a; a.type = ALOG_T_DBL; a.v.d = x; return a; }
+static inline alog_arg alog_arg_ptr(const void *x) { alog_arg a; a.type = ALOG_T_PTR; a.v.p = x; return a; }
+static inline alog_arg alog_arg_str(const char *x) { alog_arg a; a.type = ALOG_T_STR; a.v.s = x; return a; }
+
+#define ALOG_ARG(x) _Generic((x),                               \
+    char *: alog_arg_str, const char *: alog_arg_str,           \
+    float: alog_arg_dbl, double: alog_arg_dbl,                  \
+    void *: alog_arg_ptr, const void *: alog_arg_ptr,           \
+    default: alog_arg_int)(x)
+
+// 포맷 뒤 인자 수(0~8)에 따라 alog_write 호출을 만듦
+#define ALOG_NARGS(...) ALOG_NARGS_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0, _)
+#define ALOG_NARGS_(f, a1, a2, a3, a4, a5, a6, a7, a8, n, ...) n
+#define ALOG_CAT(a, b)  ALOG_CAT_(a, b)
+#define ALOG_CAT_(a, b) a##b
+
+#define ALOG_W0(l, f) alog_write(l, f, 0, 0)
+#define ALOG_W1(l, f, a) alog_write(l, f, 1, (alog_arg[]){ ALOG_ARG(a) })
+#define ALOG_W2(l, f, a, b) alog_write(l, f, 2, (alog_arg[]){ ALOG_ARG(a), ALOG_ARG(b) })
+#define ALOG_W3(l, f, a, b, c) \
+    alog_write(l, f, 3, (alog_arg[]){ ALOG_ARG(a), ALOG_ARG(b), ALOG_ARG(c) })
+#define ALOG_W4(l, f, a, b, c, d) \
+    alog_write(l, f, 4, (alog_arg[]){ ALOG_ARG(a), ALOG_ARG(b), ALOG_ARG(c), ALOG_ARG(d) })
+#define ALOG_W5(l, f, a, b, c, d, e) \
+    alog_write(l, f, 5, (alog_arg[]){ ALOG_ARG(a), ALOG_ARG(b), ALOG_ARG(c), ALOG_ARG(d), ALOG_ARG(e) })
+#define ALOG_W6(l, f, a, b, c, d, e, g) \
+    alog_write(l, f, 6, (alog_arg[]){ ALOG_ARG(a), ALOG_ARG(b), ALOG_ARG(c), ALOG_ARG(d), ALOG_ARG(e), \
+                                      ALOG_ARG(g) })
+#define ALOG_W7(l, f, a, b, c, d, e, g, h) \
+    alog_write(l, f, 7, (alog_arg[]){ ALOG_ARG(a), ALOG_ARG(b), ALOG_ARG(c), ALOG_ARG(d), ALOG_ARG(e), \
+                                      ALOG_ARG(g), ALOG_ARG(h) })
+#define ALOG_W8(l, f, a, b, c, d, e, g, h, k) \
+    alog_write(l, f, 8, (alog_arg[]){ ALOG_ARG(a), ALOG_ARG(b), ALOG_ARG(c), ALOG_ARG(d), ALOG_ARG(e), \
+                                      ALOG_ARG(g), ALOG_ARG(h), ALOG_ARG(k) })
+
+// 수준이 낮으면 인자도 평가하지 않음
+#define ALOG(level, ...)                                                            \
+    do {                                                                            \
+        if ((level) >= atomic_load_explicit(&alog_min_level, memory_order_relaxed)) \
+            ALOG_CAT(ALOG_W, ALOG_NARGS(__VA_ARGS__))(level, __VA_ARGS__);          \
+    } while (0)
+
+// 호출 위치별 초당 limit 개 (넘친 수는 다음 창에서 한 줄로 알림)
+#define alog_limited(level, limit, fmt, ...)                                        \
+    do {                                                                            \
+        static alog_rate alog_rate_site_;                                           \
+        if ((level) >= atomic_load_explicit(&alog_min_level, memory_order_relaxed) && \
+            alog_rate_ok(&alog_rate_site_, limit, level, fmt))                      \
+            ALOG(level, fmt, ##__VA_ARGS__);                                        \
+    } while (0)
+
+#define alog_debug(...) ALOG(ALOG_DEBUG, __VA_ARGS__)
+#define alog_info(...)  ALOG(ALOG_INFO, __VA_ARGS__)
+#define alog_warn(...)  ALOG(ALOG_WARN, __VA_ARGS__)
+#define alog_error(...) ALOG(ALOG_ERROR, __VA_ARGS__)
+
+#endif // ASYNC_LOG_H
@@ -0,0 +1,107 @@
+// COPY text escape 처리량 벤치: scalar / SSE2 / AVX2 구현 비교
+//   메시지 길이   : MSG_LEN[] (서버 프레임 최대 BUF_SIZE 근처 + 작은/큰 것)
+//   특수 문자 비율 : SPECIAL_PCT[] (\ \n \r \t 가 섞인 비율)
+// 입력 바이트 / 벽시계 시간 = GB/s. 결과는 CSV 한 줄씩 stdout
+// build: make bench   (connection_cas 디렉터리에서)
+// run:   ./copy_bench [run_ms] > copy.csv
+
+#include "../copy_text.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RUN_MS    200
+#define SRC_BYTES (4 << 20)     // 이 크기의 입력을 MSG_LEN 단위로 잘라 차례로 escape (캐시에 다 안 들어감)
+
+static const size_t MSG_LEN[]     = { 64, 1024, 65536 };
+static const int    SPECIAL_PCT[] = { 0, 1, 10, 50 };
+
+#define ARRAY_LEN(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+typedef struct
+{
+    const char    *name;
+    copy_escape_fn fn;
+} impl_t;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void fill(char *src, size_t n, int pct)
+{
+    static const char special[] = { '\\', '\n', '\r', '\t' };
+    size_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        if (rand() % 100 < pct)
+            src[i] = special[rand() % 4];
+        else
+            src[i] = (char)(' ' + rand() % 95);
+    }
+}
+
+// run_ms 동안 입력 전체를 msg_len 단위로 반복 escape
+static double run(copy_escape_fn fn, const char *src, char *dst, size_t msg_len, int run_ms)
+{
+    double start = now_sec();
+    double end = start + run_ms / 1000.0;
+    double t = start;
+    size_t bytes = 0;
+    size_t sink = 0;
+
+    while (t < end)
+    {
+        size_t off;
+        for (off = 0; off + msg_len <= SRC_BYTES; off += msg_len)
+            sink += fn(dst, src + off, msg_len);
+        bytes += SRC_BYTES / msg_len * msg_len;
+        t = now_sec();
+    }
+    if (sink == 0)
+        fprintf(stderr, " ");   // 결과를 써서 호출이 지워지지 않게
+    return bytes / (t - start) / 1e9;
+}
+
+int main(int argc, char **argv)
+{
+    int run_ms = argc > 1 ? atoi(argv[1]) : RUN_MS;
+    impl_t impls[3];
+    int nimpl = 0;
+    char *src = malloc(SRC_BYTES);
+    char *dst = malloc((size_t)65536 * 2);
+    int s, m, k;
+
+    impls[nimpl++] = (impl_t){ "scalar", copy_escape_scalar };
+#if defined(__x86_64__)
+    impls[nimpl++] = (impl_t){ "sse2", copy_escape_sse2 };
+    if (__builtin_cpu_supports("avx2"))
+        impls[nimpl++] = (impl_t){ "avx2", copy_escape_avx2 };
+#endif
+    fprintf(stderr, "dispatch: %s\n", copy_escape_impl());
+
+    printf("impl,msg_len,special_pct,GBps\n");
+    for (s = 0; s < ARRAY_LEN(SPECIAL_PCT); s++)
+    {
+        srand(1);
+        fill(src, SRC_BYTES, SPECIAL_PCT[s]);
+        for (m = 0; m < ARRAY_LEN(MSG_LEN); m++)
+        {
+            for (k = 0; k < nimpl; k++)
+            {
+                double gbps = run(impls[k].fn, src, dst, MSG_LEN[m], run_ms);
+                printf("%s,%zu,%d,%.2f\n", impls[k].name, MSG_LEN[m], SPECIAL_PCT[s], gbps);
+                fflush(stdout);
+            }
+        }
+    }
+    free(src);
+    free(dst);
+    return 0;
+}
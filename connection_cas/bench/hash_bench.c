@@ -0,0 +1,224 @@
+// hash_map 벤치: open addressing(현재) vs 체이닝(이전 구현)
+// build: make bench   (connection_cas 디렉터리에서)
+// run:   ./hash_bench
+
+#include "../thread_safe_queue.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BUDGET_MS   2000.0   // 이전 구현은 키가 한 버킷에 몰리면 O(n^2) → 시간 제한
+#define CHECK_EVERY 1024
+
+// ─── 이전 구현: 256 버킷 체이닝, tid % 256 ───────────────────
+
+#define CHAIN_SIZE 256
+
+typedef struct chain_entry
+{
+    unsigned long       key;
+    int                 value;
+    int                 delete_flag;
+    struct chain_entry *next;
+} chain_entry;
+
+typedef struct
+{
+    chain_entry *bucket[CHAIN_SIZE];
+    int          bucket_use[CHAIN_SIZE];
+} chain_map;
+
+static void chain_init(chain_map *map)
+{
+    memset(map, 0, sizeof(*map));
+}
+
+static int chain_insert(chain_map *map, unsigned long tid, int value)
+{
+    int index = tid % CHAIN_SIZE;
+    chain_entry *new_entry = malloc(sizeof(chain_entry));
+    if (!new_entry) return FAIL;
+    new_entry->key = tid;
+    new_entry->value = value;
+    new_entry->delete_flag = FALSE;
+    new_entry->next = NULL;
+
+    while (!__sync_bool_compare_and_swap(&map->bucket_use[index], FALSE, TRUE));
+    chain_entry *entry = map->bucket[index];
+    if (!entry)
+    {
+        map->bucket[index] = new_entry;
+        map->bucket_use[index] = FALSE;
+        return SUCCESS;
+    }
+    while (entry)
+    {
+        if (entry->key == tid)
+        {
+            entry->value = value;
+            entry->delete_flag = FALSE;
+            free(new_entry);
+            break;
+        }
+        if (!entry->next)
+        {
+            entry->next = new_entry;
+            break;
+        }
+        entry = entry->next;
+    }
+    map->bucket_use[index] = FALSE;
+    return SUCCESS;
+}
+
+static int chain_get(chain_map *map, unsigned long tid)
+{
+    chain_entry *entry = map->bucket[tid % CHAIN_SIZE];
+    while (entry)
+    {
+        if (entry->key == tid && !entry->delete_flag)
+            return entry->value;
+        entry = entry->next;
+    }
+    return FAIL;
+}
+
+static void chain_destroy(chain_map *map)
+{
+    int i;
+    for (i = 0; i < CHAIN_SIZE; i++)
+    {
+        chain_entry *entry = map->bucket[i];
+        while (entry)
+        {
+            chain_entry *next = entry->next;
+            free(entry);
+            entry = next;
+        }
+    }
+}
+
+// ─── 공통 ────────────────────────────────────────────────────
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// tid: pthread_t 처럼 스택 크기 간격으로 정렬된 포인터 / seq: 연속 정수
+static unsigned long make_key(const char *pattern, long i)
+{
+    if (pattern[0] == 't')
+        return 0x7f0000000000UL + (unsigned long)i * 0x801000UL;
+    return (unsigned long)i;
+}
+
+static void report(const char *impl, const char *pattern, const char *op,
+                   long n, long done, double ms)
+{
+    printf("[BENCH] %-6s %-4s %-6s n=%-8ld ops=%-8ld %10.2f ms %10.2f Mops/s%s\n",
+           impl, pattern, op, n, done, ms, done / ms / 1000.0,
+           done < n ? "  (budget 초과, 부분 측정)" : "");
+}
+
+static void bench_open(const char *pattern, long n)
+{
+    hash_map map;
+    long i;
+    double s;
+    volatile int sink = 0;
+
+    hash_init(&map);
+
+    s = now_ms();
+    for (i = 0; i < n; i++)
+        hash_insert(&map, make_key(pattern, i), (int)i);
+    report("open", pattern, "insert", n, n, now_ms() - s);
+
+    s = now_ms();
+    for (i = 0; i < n; i++)
+        sink += hash_get(&map, make_key(pattern, i));
+    report("open", pattern, "hit", n, n, now_ms() - s);
+
+    s = now_ms();
+    for (i = 0; i < n; i++)
+        sink += hash_get(&map, make_key(pattern, i + n));
+    report("open", pattern, "miss", n, n, now_ms() - s);
+
+    (void)sink;
+    hash_destroy(&map);
+}
+
+static void bench_chain(const char *pattern, long n)
+{
+    chain_map *map = malloc(sizeof(chain_map));
+    long i, inserted;
+    double s, e;
+    volatile int sink = 0;
+
+    chain_init(map);
+
+    s = now_ms();
+    for (i = 0; i < n; i++)
+    {
+        chain_insert(map, make_key(pattern, i), (int)i);
+        if (i % CHECK_EVERY == 0 && now_ms() - s > BUDGET_MS)
+        {
+            i++;
+            break;
+        }
+    }
+    inserted = i;
+    e = now_ms();
+    report("chain", pattern, "insert", n, inserted, e - s);
+
+    s = now_ms();
+    for (i = 0; i < inserted; i++)
+    {
+        sink += chain_get(map, make_key(pattern, i));
+        if (i % CHECK_EVERY == 0 && now_ms() - s > BUDGET_MS)
+        {
+            i++;
+            break;
+        }
+    }
+    report("chain", pattern, "hit", n, i, now_ms() - s);
+
+    s = now_ms();
+    for (i = 0; i < inserted; i++)
+    {
+        sink += chain_get(map, make_key(pattern, i + n));
+        if (i % CHECK_EVERY == 0 && now_ms() - s > BUDGET_MS)
+        {
+            i++;
+            break;
+        }
+    }
+    report("chain", pattern, "miss", n, i, now_ms() - s);
+
+    (void)sink;
+    chain_destroy(map);
+    free(map);
+}
+
+int main()
+{
+    long sizes[] = { 1000, 100000, 1000000 };
+    const char *patterns[] = { "tid", "seq" };
+    int i, p;
+
+    for (p = 0; p < 2; p++)
+    {
+        for (i = 0; i < 3; i++)
+        {
+            printf("\n=== %s keys, n=%ld ===\n", patterns[p], sizes[i]);
+            bench_open(patterns[p], sizes[i]);
+            bench_chain(patterns[p], sizes[i]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,187 @@
+// hash_map 읽기/쓰기 혼합 벤치: 읽기 N 개 + 쓰기 1 개
+// seqlock 읽기(현재) vs pthread_rwlock 으로 감싼 읽기(비교용)
+// 쓰기는 값 갱신 / soft delete → 부활 / 새 키 insert(리사이즈 유발) 를 계속 반복
+// build: make bench   (connection_cas 디렉터리에서)
+// run:   ./hash_rw_bench
+
+#include "../thread_safe_queue.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RUN_MS       500
+#define HOT_KEYS     1024
+#define SAMPLE_EVERY 64        // 지연 시간은 64 번에 한 번만 잼 (clock_gettime 비용)
+#define MAX_SAMPLES  (1 << 16)
+#define MAX_READERS  8
+
+typedef struct
+{
+    hash_map          *map;
+    pthread_rwlock_t  *rw;          // NULL 이면 락 없이 읽음
+    volatile int      *stop;
+    long               ops;
+    int                nsample;
+    double             sample[MAX_SAMPLES];   // 나노초
+} reader_arg;
+
+typedef struct
+{
+    hash_map          *map;
+    pthread_rwlock_t  *rw;
+    volatile int      *stop;
+    long               ops;
+} writer_arg;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void *reader_main(void *arg)
+{
+    reader_arg *a = (reader_arg *)arg;
+    unsigned long i = 0;
+    volatile int sink = 0;
+
+    while (!*a->stop)
+    {
+        unsigned long key = i % HOT_KEYS;
+        double s = 0;
+        int timed = (i % SAMPLE_EVERY) == 0 && a->nsample < MAX_SAMPLES;
+
+        if (timed)
+            s = now_ns();
+        if (a->rw)
+            pthread_rwlock_rdlock(a->rw);
+        sink += hash_get(a->map, key);
+        if (a->rw)
+            pthread_rwlock_unlock(a->rw);
+        if (timed)
+            a->sample[a->nsample++] = now_ns() - s;
+        i++;
+    }
+    a->ops = (long)i;
+    (void)sink;
+    return NULL;
+}
+
+static void *writer_main(void *arg)
+{
+    writer_arg *a = (writer_arg *)arg;
+    unsigned long i = 0;
+    unsigned long fresh = HOT_KEYS;
+
+    while (!*a->stop)
+    {
+        unsigned long key = i % HOT_KEYS;
+        if (a->rw)
+            pthread_rwlock_wrlock(a->rw);
+        if (i % 16 == 0)
+            hash_delete_soft(a->map, key);
+        hash_insert(a->map, key, (int)i);
+        // 새 키를 섞어 주기적으로 리사이즈 → 읽기가 옛 테이블/새 테이블을 오가게
+        if (i % 4 == 0)
+            hash_insert(a->map, fresh++, 0);
+        if (fresh % 65536 == 0)
+        {
+            unsigned long k;
+            for (k = HOT_KEYS; k < fresh; k++)
+                hash_delete_soft(a->map, k);
+            hash_delete(a->map);
+            fresh++;
+        }
+        if (a->rw)
+            pthread_rwlock_unlock(a->rw);
+        i++;
+    }
+    a->ops = (long)i;
+    return NULL;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void run(const char *name, int nreader, int use_rwlock)
+{
+    hash_map map;
+    pthread_rwlock_t rw;
+    pthread_t rt[MAX_READERS], wt;
+    reader_arg *ra = calloc(nreader, sizeof(reader_arg));
+    writer_arg wa;
+    volatile int stop = 0;
+    double *all = NULL;
+    long reads = 0;
+    int total = 0, i, j;
+
+    hash_init(&map);
+    pthread_rwlock_init(&rw, NULL);
+    for (i = 0; i < HOT_KEYS; i++)
+        hash_insert(&map, (unsigned long)i, i);
+
+    for (i = 0; i < nreader; i++)
+    {
+        ra[i].map = &map;
+        ra[i].rw = use_rwlock ? &rw : NULL;
+        ra[i].stop = &stop;
+        pthread_create(&rt[i], NULL, reader_main, &ra[i]);
+    }
+    wa.map = &map;
+    wa.rw = use_rwlock ? &rw : NULL;
+    wa.stop = &stop;
+    wa.ops = 0;
+    pthread_create(&wt, NULL, writer_main, &wa);
+
+    struct timespec ts = { RUN_MS / 1000, (RUN_MS % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+    stop = 1;
+
+    pthread_join(wt, NULL);
+    for (i = 0; i < nreader; i++)
+    {
+        pthread_join(rt[i], NULL);
+        reads += ra[i].ops;
+        total += ra[i].nsample;
+    }
+
+    all = malloc(sizeof(double) * (total ? total : 1));
+    for (i = 0, j = 0; i < nreader; i++)
+    {
+        memcpy(all + j, ra[i].sample, sizeof(double) * ra[i].nsample);
+        j += ra[i].nsample;
+    }
+    qsort(all, total, sizeof(double), cmp_double);
+
+    printf("[BENCH] %-7s readers=%d  read %8.2f Mops/s  write %6.2f Mops/s"
+           "  read p50 %6.0f ns  p99 %8.0f ns  max %10.0f ns\n",
+           name, nreader,
+           reads / (RUN_MS * 1000.0), wa.ops / (RUN_MS * 1000.0),
+           total ? all[total / 2] : 0,
+           total ? all[(long)(total * 0.99)] : 0,
+           total ? all[total - 1] : 0);
+
+    free(all);
+    free(ra);
+    pthread_rwlock_destroy(&rw);
+    hash_destroy(&map);
+}
+
+int main()
+{
+    int readers[] = { 1, 2, 4, 8 };
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        run("seqlock", readers[i], FALSE);
+        run("rwlock", readers[i], TRUE);
+    }
+    return 0;
+}
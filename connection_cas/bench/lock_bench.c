@@ -0,0 +1,445 @@
+// 락/원자 연산 벤치: 프로젝트가 쓰는 동기화 수단을 같은 조건에서 비교
+//   스레드 수      : 1, 2, 4, ... 2 x 코어 수
+//   임계 구역 길이 : 공유 데이터 CS_LEN[] 칸 읽기/쓰기
+//   읽기 비율      : READ_PCT[] (읽기는 rwlock/seqlock 이면 공유, 나머지는 배타)
+// 시간은 CLOCK_MONOTONIC 벽시계. 결과는 CSV 한 줄씩 stdout, 진행 상황은 stderr
+//   ops/s, 스레드별 ops 최소/최대 + Jain 공정성 지수, 획득 대기/점유 시간 p50/p99
+// build: make bench   (connection_cas 디렉터리에서)
+// run:   ./lock_bench [run_ms] [primitive] > lock.csv
+
+#include "../thread_safe_queue.h"
+#include "../cas_lock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RUN_MS       200
+#define SAMPLE_EVERY 64        // 지연 시간은 64 번에 한 번만 잼 (clock_gettime 비용)
+#define MAX_SAMPLES  (1 << 14)
+#define DATA_LEN     64        // 임계 구역이 만지는 공유 데이터 (long 64 개 = 캐시 라인 8 개)
+#define SLOT_COUNT   10        // cas_slot: conn_pool 의 CONN_SIZE 와 같은 슬롯 수
+#define HOT_KEYS     256       // seqlock: hash_map 키 수
+#define MAX_COUNTS   32        // 스레드 수 단계 상한
+
+static const int CS_LEN[]   = { 0, 16, 256 };
+static const int READ_PCT[] = { 0, 90, 99 };
+
+#define ARRAY_LEN(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+enum primitive
+{
+    P_MUTEX = 0,    // pthread_mutex (conn_pool 대기 큐, ebr limbo, registry)
+    P_SPIN,         // pthread_spinlock
+    P_NAIVE,        // 기존 get_lock / cas_bench: backoff 없는 CAS 스핀
+    P_TTAS,         // cas_lock 4 종
+    P_TICKET,
+    P_MCS,
+    P_ADAPTIVE,
+    P_RWLOCK,       // pthread_rwlock (읽기 공유)
+    P_SEQLOCK,      // hash_map: seqlock 읽기 + cas_lock 쓰기
+    P_FAA,          // relaxed fetch_add (통계 카운터)
+    P_CAS_SLOT,     // conn_pool 슬롯 점유: acquire CAS + release store
+    P_COUNT
+};
+
+static const char *P_NAME[P_COUNT] = {
+    "mutex", "spin", "naive", "ttas", "ticket", "mcs", "adaptive",
+    "rwlock", "seqlock", "faa", "cas_slot"
+};
+
+// 임계 구역 길이를 의미 있게 쓰는 종류만 CS_LEN 전체를 돎 (faa/seqlock 은 연산 자체가 구역)
+static int uses_cs(int p)
+{
+    return p != P_FAA && p != P_SEQLOCK;
+}
+
+// cas_slot 은 항상 점유 → 반납이라 읽기 비율이 없음
+static int uses_read(int p)
+{
+    return p != P_CAS_SLOT;
+}
+
+typedef struct
+{
+    int                 prim;
+    int                 cs;
+    int                 read_pct;
+    atomic_int         *stop;
+    pthread_barrier_t  *start;
+    unsigned long       rng;
+    long                ops;
+    int                 nsample;
+    double             *wait;       // 획득까지 걸린 시간 (나노초)
+    double             *hold;       // 획득 ~ 해제 직전
+} __attribute__((aligned(64))) worker_arg;
+
+// ─── 공유 상태 ──────────────────────────────────────────────
+
+static pthread_mutex_t    g_mutex;
+static pthread_spinlock_t g_spin;
+static atomic_int         g_naive;
+static cas_lock           g_lock;
+static pthread_rwlock_t   g_rw;
+static hash_map           g_map;
+static atomic_long        g_faa;
+static atomic_int         g_slot[SLOT_COUNT];
+static long               g_slot_data[SLOT_COUNT][8] __attribute__((aligned(64)));
+static long               g_data[DATA_LEN] __attribute__((aligned(64)));
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static unsigned long xorshift(unsigned long *s)
+{
+    unsigned long x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
+
+static void prim_init(int p)
+{
+    int i;
+    memset(g_data, 0, sizeof(g_data));
+    switch (p)
+    {
+        case P_MUTEX:    pthread_mutex_init(&g_mutex, NULL); break;
+        case P_SPIN:     pthread_spin_init(&g_spin, PTHREAD_PROCESS_PRIVATE); break;
+        case P_NAIVE:    atomic_init(&g_naive, 0); break;
+        case P_TTAS:     cas_lock_init(&g_lock, LOCK_TTAS); break;
+        case P_TICKET:   cas_lock_init(&g_lock, LOCK_TICKET); break;
+        case P_MCS:      cas_lock_init(&g_lock, LOCK_MCS); break;
+        case P_ADAPTIVE: cas_lock_init(&g_lock, LOCK_ADAPTIVE); break;
+        case P_RWLOCK:   pthread_rwlock_init(&g_rw, NULL); break;
+        case P_SEQLOCK:
+            hash_init(&g_map);
+            for (i = 0; i < HOT_KEYS; i++)
+                hash_insert(&g_map, (unsigned long)i, i);
+            break;
+        case P_FAA:      atomic_init(&g_faa, 0); break;
+        case P_CAS_SLOT:
+            for (i = 0; i < SLOT_COUNT; i++)
+                atomic_init(&g_slot[i], 0);
+            break;
+    }
+}
+
+static void prim_destroy(int p)
+{
+    switch (p)
+    {
+        case P_MUTEX:   pthread_mutex_destroy(&g_mutex); break;
+        case P_SPIN:    pthread_spin_destroy(&g_spin); break;
+        case P_RWLOCK:  pthread_rwlock_destroy(&g_rw); break;
+        case P_SEQLOCK: hash_destroy(&g_map); break;
+    }
+}
+
+// 배타 락 종류의 잡기/풀기 (읽기도 배타)
+static void excl_acquire(int p)
+{
+    int expected;
+    switch (p)
+    {
+        case P_MUTEX: pthread_mutex_lock(&g_mutex); break;
+        case P_SPIN:  pthread_spin_lock(&g_spin); break;
+        case P_NAIVE:
+            expected = 0;
+            while (!atomic_compare_exchange_strong(&g_naive, &expected, 1))
+                expected = 0;
+            break;
+        case P_RWLOCK: pthread_rwlock_wrlock(&g_rw); break;
+        default:       cas_lock_acquire(&g_lock); break;
+    }
+}
+
+static void excl_release(int p)
+{
+    switch (p)
+    {
+        case P_MUTEX:  pthread_mutex_unlock(&g_mutex); break;
+        case P_SPIN:   pthread_spin_unlock(&g_spin); break;
+        case P_NAIVE:  atomic_store_explicit(&g_naive, 0, memory_order_release); break;
+        case P_RWLOCK: pthread_rwlock_unlock(&g_rw); break;
+        default:       cas_lock_release(&g_lock); break;
+    }
+}
+
+// 임계 구역 본문: 쓰기는 공유 데이터 cs 칸 증가, 읽기는 합만 구함
+static long critical(long *data, int len, int cs, int is_read)
+{
+    long sum = 0;
+    int i;
+    for (i = 0; i < cs; i++)
+    {
+        if (is_read)
+            sum += data[i % len];
+        else
+            data[i % len]++;
+    }
+    return sum;
+}
+
+// 연산 1 회. 잰 구간은 *wait / *hold 에 (timed 일 때만)
+static long one_op(worker_arg *a, int is_read, int timed, double *wait, double *hold)
+{
+    double t0 = 0, t1 = 0;
+    long sink = 0;
+    int i;
+
+    if (timed)
+        t0 = now_ns();
+
+    switch (a->prim)
+    {
+        case P_SEQLOCK:
+        {
+            unsigned long key = xorshift(&a->rng) % HOT_KEYS;
+            if (is_read)
+                sink = hash_get(&g_map, key);
+            else
+                hash_insert(&g_map, key, (int)a->ops);
+            if (timed)
+                t1 = now_ns();
+            break;
+        }
+        case P_FAA:
+            if (is_read)
+                sink = atomic_load_explicit(&g_faa, memory_order_relaxed);
+            else
+                atomic_fetch_add_explicit(&g_faa, 1, memory_order_relaxed);
+            if (timed)
+                t1 = now_ns();
+            break;
+        case P_CAS_SLOT:
+            // 읽기 비율과 무관하게 항상 점유 → 작업 → 반납 (conn_pool 획득 경로)
+            for (i = (int)(xorshift(&a->rng) % SLOT_COUNT);; i = (i + 1) % SLOT_COUNT)
+            {
+                int expected = 0;
+                if (!atomic_load_explicit(&g_slot[i], memory_order_relaxed)
+                    && atomic_compare_exchange_weak_explicit(&g_slot[i], &expected, 1,
+                                                             memory_order_acquire,
+                                                             memory_order_relaxed))
+                    break;
+                cpu_relax();
+            }
+            if (timed)
+                t1 = now_ns();
+            sink = critical(g_slot_data[i], 8, a->cs, FALSE);
+            if (timed)
+                *hold = now_ns() - t1;
+            atomic_store_explicit(&g_slot[i], 0, memory_order_release);
+            break;
+        case P_RWLOCK:
+            if (is_read)
+                pthread_rwlock_rdlock(&g_rw);
+            else
+                pthread_rwlock_wrlock(&g_rw);
+            if (timed)
+                t1 = now_ns();
+            sink = critical(g_data, DATA_LEN, a->cs, is_read);
+            if (timed)
+                *hold = now_ns() - t1;
+            pthread_rwlock_unlock(&g_rw);
+            break;
+        default:
+            excl_acquire(a->prim);
+            if (timed)
+                t1 = now_ns();
+            sink = critical(g_data, DATA_LEN, a->cs, is_read);
+            if (timed)
+                *hold = now_ns() - t1;
+            excl_release(a->prim);
+            break;
+    }
+
+    if (timed)
+        *wait = t1 - t0;
+    return sink;
+}
+
+static void *worker_main(void *arg)
+{
+    worker_arg *a = (worker_arg *)arg;
+    volatile long sink = 0;
+
+    pthread_barrier_wait(a->start);
+    while (!atomic_load_explicit(a->stop, memory_order_relaxed))
+    {
+        int is_read = (int)(xorshift(&a->rng) % 100) < a->read_pct;
+        int timed = (a->ops % SAMPLE_EVERY) == 0 && a->nsample < MAX_SAMPLES;
+        double wait = 0, hold = 0;
+
+        sink += one_op(a, is_read, timed, &wait, &hold);
+        if (timed)
+        {
+            a->wait[a->nsample] = wait;
+            a->hold[a->nsample] = hold;
+            a->nsample++;
+        }
+        a->ops++;
+    }
+    (void)sink;
+    return NULL;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double pct(double *v, int n, double p)
+{
+    if (n == 0)
+        return 0;
+    return v[(long)((n - 1) * p)];
+}
+
+static void run(int p, int nthread, int cs, int read_pct, int run_ms)
+{
+    worker_arg *args = NULL;
+    pthread_t *threads = calloc(nthread, sizeof(pthread_t));
+    pthread_barrier_t start;
+    atomic_int stop = 0;
+    struct timespec s, e;
+    struct timespec wait = { run_ms / 1000, (run_ms % 1000) * 1000000L };
+    double *all_wait = NULL, *all_hold = NULL;
+    double sum = 0, sum_sq = 0, ms;
+    long min_ops = -1, max_ops = 0, total = 0;
+    int nsample = 0, i;
+
+    if (posix_memalign((void **)&args, 64, sizeof(worker_arg) * nthread) != 0)
+        abort();
+    memset(args, 0, sizeof(worker_arg) * nthread);
+    prim_init(p);
+    pthread_barrier_init(&start, NULL, nthread + 1);
+
+    for (i = 0; i < nthread; i++)
+    {
+        args[i].prim = p;
+        args[i].cs = cs;
+        args[i].read_pct = read_pct;
+        args[i].stop = &stop;
+        args[i].start = &start;
+        args[i].rng = 0x9E3779B97F4A7C15UL * (unsigned long)(i + 1);
+        args[i].wait = malloc(sizeof(double) * MAX_SAMPLES);
+        args[i].hold = malloc(sizeof(double) * MAX_SAMPLES);
+        pthread_create(&threads[i], NULL, worker_main, &args[i]);
+    }
+
+    pthread_barrier_wait(&start);
+    clock_gettime(CLOCK_MONOTONIC, &s);
+    nanosleep(&wait, NULL);
+    atomic_store_explicit(&stop, 1, memory_order_relaxed);
+    for (i = 0; i < nthread; i++)
+        pthread_join(threads[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &e);
+    ms = (e.tv_sec - s.tv_sec) * 1000.0 + (e.tv_nsec - s.tv_nsec) / 1e6;
+
+    for (i = 0; i < nthread; i++)
+    {
+        long ops = args[i].ops;
+        total += ops;
+        sum += ops;
+        sum_sq += (double)ops * ops;
+        if (min_ops < 0 || ops < min_ops)
+            min_ops = ops;
+        if (ops > max_ops)
+            max_ops = ops;
+        nsample += args[i].nsample;
+    }
+
+    all_wait = malloc(sizeof(double) * (nsample ? nsample : 1));
+    all_hold = malloc(sizeof(double) * (nsample ? nsample : 1));
+    for (i = 0, nsample = 0; i < nthread; i++)
+    {
+        memcpy(all_wait + nsample, args[i].wait, sizeof(double) * args[i].nsample);
+        memcpy(all_hold + nsample, args[i].hold, sizeof(double) * args[i].nsample);
+        nsample += args[i].nsample;
+        free(args[i].wait);
+        free(args[i].hold);
+    }
+    qsort(all_wait, nsample, sizeof(double), cmp_double);
+    qsort(all_hold, nsample, sizeof(double), cmp_double);
+
+    // Jain 지수: 모든 스레드가 같은 몫이면 1, 한 스레드가 독식하면 1/n
+    printf("%s,%d,%d,%d,%ld,%.2f,%.3f,%ld,%ld,%.3f,%.0f,%.0f,%.0f,%.0f\n",
+           P_NAME[p], nthread, cs, read_pct, total, ms, total / ms / 1000.0,
+           min_ops, max_ops, sum_sq > 0 ? sum * sum / (nthread * sum_sq) : 1.0,
+           pct(all_wait, nsample, 0.50), pct(all_wait, nsample, 0.99),
+           pct(all_hold, nsample, 0.50), pct(all_hold, nsample, 0.99));
+    fflush(stdout);
+
+    free(all_wait);
+    free(all_hold);
+    pthread_barrier_destroy(&start);
+    prim_destroy(p);
+    free(args);
+    free(threads);
+}
+
+// 정렬 + 중복 제거하며 추가
+static int add_count(int *counts, int n, int t)
+{
+    int i, j;
+    if (n >= MAX_COUNTS)
+        return n;
+    for (i = 0; i < n && counts[i] < t; i++)
+        ;
+    if (i < n && counts[i] == t)
+        return n;
+    for (j = n; j > i; j--)
+        counts[j] = counts[j - 1];
+    counts[i] = t;
+    return n + 1;
+}
+
+int main(int argc, char **argv)
+{
+    int run_ms = argc > 1 ? atoi(argv[1]) : RUN_MS;
+    const char *only = argc > 2 ? argv[2] : NULL;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int counts[MAX_COUNTS], ncount = 0;
+    int p, t, c, r;
+
+    if (run_ms <= 0)
+        run_ms = RUN_MS;
+    if (ncpu < 1)
+        ncpu = 1;
+    // 1, 2, 4, ... 에 코어 수와 2 x 코어 수(과구독)를 끼워 넣음
+    for (t = 1; t < 2 * ncpu; t <<= 1)
+        ncount = add_count(counts, ncount, t);
+    ncount = add_count(counts, ncount, (int)ncpu);
+    ncount = add_count(counts, ncount, (int)(2 * ncpu));
+
+    printf("primitive,threads,cs,read_pct,ops,ms,mops,thread_min_ops,thread_max_ops,"
+           "jain,wait_p50_ns,wait_p99_ns,hold_p50_ns,hold_p99_ns\n");
+    for (p = 0; p < P_COUNT; p++)
+    {
+        if (only && strcmp(only, P_NAME[p]) != 0)
+            continue;
+        fprintf(stderr, "[BENCH] %s\n", P_NAME[p]);
+        for (t = 0; t < ncount; t++)
+            for (c = 0; c < ARRAY_LEN(CS_LEN); c++)
+            {
+                if (c > 0 && !uses_cs(p))
+                    break;
+                for (r = 0; r < ARRAY_LEN(READ_PCT); r++)
+                {
+                    if (r > 0 && !uses_read(p))
+                        break;
+                    run(p, counts[t], CS_LEN[c], READ_PCT[r], run_ms);
+                }
+            }
+    }
+    return 0;
+}
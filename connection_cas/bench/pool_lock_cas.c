@@ -1,5 +1,7 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <pthread.h>
 #include <unistd.h>
 #include <sys/time.h>
@@ -25,10 +27,10 @@ enum conn_flag
 pthread_key_t key;
 struct aligned_int 
 {
-    int value;
+    atomic_int value;               // 0 = 비어 있음, 1 = 점유
     long updated;                   //커넥션 아이들 시작 시간 -> 오래 돠면 제거
     long created;                   //커넥션 생성 시간 -> 오래되면 재 연결
-    enum conn_flag flag;            //점유 상황
+    atomic_int flag;                //점유 상황 (enum conn_flag)
     PGconn* conn;                   // libpq 커넥션 핸들 추가
     char padding[40];               // 64바이트 정렬
 } __attribute__((aligned(64)));
@@ -48,7 +50,36 @@ int conn_lock_status[POOL_MAX_CNT] = {0,};
 struct aligned_int conn_cas_status[POOL_MAX_CNT];
 long conn_add_time[POOL_MAX_CNT] = {0,};
 
-volatile long now = 0;
+atomic_long now = 0;                // 하우스키퍼만 씀, 나머지는 대략적인 시각만 필요 → relaxed
+
+static long now_sec(void)
+{
+    return atomic_load_explicit(&now, memory_order_relaxed);
+}
+
+// 슬롯 점유: 성공하면 이전 주인이 쓴 conn/updated 가 보여야 함 → acquire
+static int slot_take(int i)
+{
+    int expected = 0;
+    return atomic_compare_exchange_strong_explicit(&conn_cas_status[i].value, &expected, 1,
+                                                   memory_order_acquire, memory_order_relaxed);
+}
+
+// 슬롯 반납: 주인만 호출하므로 CAS 대신 release store
+static void slot_give(int i)
+{
+    atomic_store_explicit(&conn_cas_status[i].value, 0, memory_order_release);
+}
+
+static int flag_get(int i)
+{
+    return atomic_load_explicit(&conn_cas_status[i].flag, memory_order_relaxed);
+}
+
+static void flag_set(int i, int flag)
+{
+    atomic_store_explicit(&conn_cas_status[i].flag, flag, memory_order_relaxed);
+}
 
 void *house_keeper(void *arg)
 {
@@ -57,13 +88,13 @@ void *house_keeper(void *arg)
     while(1)
     {
         conn_count = 0;
-        now = time(NULL);
+        atomic_store_explicit(&now, time(NULL), memory_order_relaxed);
         for (int i = 0; i < POOL_MAX_CNT; i++) 
         {
             //1.아이들
-            if(__sync_bool_compare_and_swap(&conn_cas_status[i].value, 0, 1))
+            if(slot_take(i))
             {
-                if(conn_count > POOL_MIN_CNT && conn_cas_status[i].updated + 10 * 60 < now)                 //아이들이 오래 됬다면 제거
+                if(conn_count > POOL_MIN_CNT && conn_cas_status[i].updated + 10 * 60 < now_sec())                 //아이들이 오래 됬다면 제거
                 {
                     //대충 연결 해제
                     printf("hk conn close\n");
@@ -71,17 +102,18 @@ void *house_keeper(void *arg)
                         PQfinish(conn_cas_status[i].conn);
                         conn_cas_status[i].conn = NULL;
                     }
-                    conn_cas_status[i].flag = CLOSED;
+                    flag_set(i, CLOSED);
                     conn_count--;
                 }
                 else
                 {
                     conn_count++;
                 }
-                __sync_bool_compare_and_swap(&conn_cas_status[i].value, 1, 0);
+                slot_give(i);
             }
-            //2. 닫힌 커넥션
-            else if (__sync_bool_compare_and_swap(&conn_cas_status[i].value, 1, 1) && conn_cas_status[i].flag == CLOSED)
+            //2. 닫힌 커넥션 (점유 표시가 남은 채 CLOSED → 닫은 쪽의 쓰기를 acquire 로 봄)
+            else if (atomic_load_explicit(&conn_cas_status[i].value, memory_order_acquire) == 1
+                     && flag_get(i) == CLOSED)
             {
                 //재연결
                 if (conn_cas_status[i].conn) {
@@ -94,10 +126,10 @@ void *house_keeper(void *arg)
                     conn_cas_status[i].conn = NULL;
                     continue;
                 }
-                conn_cas_status[i].created = now;
-                conn_cas_status[i].updated = now;
-                conn_cas_status[i].flag = IN_USING;
-                __sync_bool_compare_and_swap(&conn_cas_status[i].value, 1, 0);
+                conn_cas_status[i].created = now_sec();
+                conn_cas_status[i].updated = now_sec();
+                flag_set(i, IN_USING);
+                slot_give(i);
             }
             else
             {
@@ -192,11 +224,11 @@ int get_conn_long()
         i++;
         if(i == POOL_MAX_CNT)
             i = 0; 
-        if(__sync_bool_compare_and_swap(&conn_cas_status[i].value, 0, 1)) 
+        if(slot_take(i)) 
         {
             pthread_setspecific(key, (void *)(intptr_t)i);
-            conn_cas_status[i].flag = IN_USING;
-            conn_cas_status[i].updated = now;
+            flag_set(i, IN_USING);
+            conn_cas_status[i].updated = now_sec();
             //printf("%lu use %d\n", (unsigned long)pthread_self(), i);
             return i;
         }
@@ -210,11 +242,11 @@ int get_conn_short()
     if(ptr)
     {
         int index = (int)(intptr_t)ptr;
-        if(__sync_bool_compare_and_swap(&conn_cas_status[index].value, 0, 1)) 
+        if(slot_take(index)) 
         {
             pthread_setspecific(key, (void *)(intptr_t)index);
-            conn_cas_status[index].flag = IN_USING;
-            conn_cas_status[index].updated = now;
+            flag_set(index, IN_USING);
+            conn_cas_status[index].updated = now_sec();
             //printf("%lu use short %d\n", (unsigned long)pthread_self(), index);
             return index;
         }
@@ -228,7 +260,9 @@ int add_conn()
     for(i = 0; i < POOL_MAX_CNT; i++)
     {
         //대충 커넥션 만드는 로직 
-        if(__sync_bool_compare_and_swap(&conn_cas_status[i].flag, CLOSED, IN_USING))
+        int expected = CLOSED;
+        if(atomic_compare_exchange_strong_explicit(&conn_cas_status[i].flag, &expected, IN_USING,
+                                                   memory_order_acq_rel, memory_order_relaxed))
         {
             // libpq 커넥션 생성
             if (conn_cas_status[i].conn) {
@@ -239,12 +273,12 @@ int add_conn()
                 fprintf(stderr, "Connection to database failed: %s\n", PQerrorMessage(conn_cas_status[i].conn));
                 PQfinish(conn_cas_status[i].conn);
                 conn_cas_status[i].conn = NULL;
-                conn_cas_status[i].flag = CLOSED;
+                flag_set(i, CLOSED);
                 continue;
             }
             pthread_setspecific(key, (void *)(intptr_t)i);
-            conn_cas_status[i].updated = now;       //매번 시간 계산 대신 하우스 키퍼 계산한 시간 사용
-            conn_cas_status[i].created = now;
+            conn_cas_status[i].updated = now_sec();       //매번 시간 계산 대신 하우스 키퍼 계산한 시간 사용
+            conn_cas_status[i].created = now_sec();
             printf("addconn detected %d\n", i);
             return i;
         }
@@ -265,21 +299,22 @@ void return_conn(int i)
 void return_conn_cas(int i)
 {
     //반납때 오래됬으면 제거
-    if(is_valid(i) && conn_cas_status[i].created + 30 * 60 > now)
+    if(is_valid(i) && conn_cas_status[i].created + 30 * 60 > now_sec())
     {
         //커넥션이 멀정하면
-        conn_cas_status[i].updated = now;
-        __sync_bool_compare_and_swap(&conn_cas_status[i].value, 1, 0);
+        conn_cas_status[i].updated = now_sec();
+        slot_give(i);
     }
     else
     {
         //커넥션 닫기
-        printf("%ld %ld conn close\n", now, conn_cas_status[i].created );
+        printf("%ld %ld conn close\n", now_sec(), conn_cas_status[i].created );
         if (conn_cas_status[i].conn) {
             PQfinish(conn_cas_status[i].conn);
             conn_cas_status[i].conn = NULL;
         }
-        conn_cas_status[i].flag = CLOSED;
+        // 닫힌 채 점유 표시를 남김 → 하우스키퍼가 acquire 로 보고 재연결
+        atomic_store_explicit(&conn_cas_status[i].flag, CLOSED, memory_order_release);
     }
 }
 
@@ -325,25 +360,25 @@ int main()
     {
         if(i < POOL_MIN_CNT)
         {
-            conn_cas_status[i].value = 0;
+            atomic_init(&conn_cas_status[i].value, 0);
             conn_cas_status[i].updated = time(NULL);
             conn_cas_status[i].created = time(NULL);
-            conn_cas_status[i].flag = IN_USING;
+            atomic_init(&conn_cas_status[i].flag, IN_USING);
             // 커넥션 생성
             conn_cas_status[i].conn = PQconnectdb(PG_CONNINFO);
             if (PQstatus(conn_cas_status[i].conn) != CONNECTION_OK) {
                 fprintf(stderr, "Init connection failed: %s\n", PQerrorMessage(conn_cas_status[i].conn));
                 PQfinish(conn_cas_status[i].conn);
                 conn_cas_status[i].conn = NULL;
-                conn_cas_status[i].flag = CLOSED;
+                atomic_init(&conn_cas_status[i].flag, CLOSED);
             }
         }
         else
         {
-            conn_cas_status[i].value = 1;
+            atomic_init(&conn_cas_status[i].value, 1);
             conn_cas_status[i].updated = 0;
             conn_cas_status[i].created = 0;
-            conn_cas_status[i].flag = CLOSED;            
+            atomic_init(&conn_cas_status[i].flag, CLOSED);            
             conn_cas_status[i].conn = NULL;
         }
         //printf("%ld %ld\n", conn_cas_status[i].created, conn_cas_status[i].updated);
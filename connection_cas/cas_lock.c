@@ -0,0 +1,256 @@
+#include "cas_lock.h"
+#include "thread_safe_queue.h"
+
+#include <stdlib.h>
+#include <sched.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+static __thread mcs_node t_mcs[LOCK_MCS_NEST];
+static __thread int      t_mcs_depth = 0;
+
+// 오래 돌았으면 CPU 를 양보 (락 주인이 선점당해 있을 수 있음)
+static void spin_wait(unsigned int *spins)
+{
+    if (++*spins >= LOCK_SPIN_LIMIT)
+    {
+        *spins = 0;
+        sched_yield();
+    }
+    else
+        cpu_relax();
+}
+
+// ─── TTAS + 지수 backoff ──────────────────────────────────────
+
+static int ttas_try(cas_lock *lock)
+{
+    return !atomic_load_explicit(&lock->flag, memory_order_relaxed)
+        && !atomic_exchange_explicit(&lock->flag, 1, memory_order_acquire);
+}
+
+static void ttas_acquire(cas_lock *lock)
+{
+    unsigned int backoff = LOCK_BACKOFF_MIN;
+    unsigned int i;
+
+    while (!ttas_try(lock))
+    {
+        for (i = 0; i < backoff; i++)
+            cpu_relax();
+        if (backoff < LOCK_BACKOFF_MAX)
+            backoff <<= 1;
+        else
+            sched_yield();
+    }
+}
+
+static void ttas_release(cas_lock *lock)
+{
+    atomic_store_explicit(&lock->flag, 0, memory_order_release);
+}
+
+// ─── ticket ─────────────────────────────────────────────────
+
+static int ticket_try(cas_lock *lock)
+{
+    unsigned int owner = atomic_load_explicit(&lock->ticket.owner, memory_order_acquire);
+    unsigned int next = owner;
+    return atomic_compare_exchange_strong_explicit(&lock->ticket.next, &next, owner + 1,
+                                                   memory_order_acquire, memory_order_relaxed);
+}
+
+static void ticket_acquire(cas_lock *lock)
+{
+    unsigned int my = atomic_fetch_add_explicit(&lock->ticket.next, 1, memory_order_relaxed);
+    unsigned int spins = 0;
+
+    for (;;)
+    {
+        unsigned int owner = atomic_load_explicit(&lock->ticket.owner, memory_order_acquire);
+        unsigned int i;
+        if (owner == my)
+            return;
+        // 앞에 선 사람 수만큼 비례 대기 → owner 캐시 라인을 덜 읽음.
+        // 순서가 정해진 락이라 앞 사람이 선점당하면 모두 멈춤 → 대기한 만큼 양보 시점도 당김
+        for (i = 0; i < (my - owner) * LOCK_BACKOFF_MIN; i++)
+            cpu_relax();
+        spins += my - owner;
+        spin_wait(&spins);
+    }
+}
+
+static void ticket_release(cas_lock *lock)
+{
+    // owner 는 주인만 씀 → relaxed 읽기 + release store
+    unsigned int owner = atomic_load_explicit(&lock->ticket.owner, memory_order_relaxed);
+    atomic_store_explicit(&lock->ticket.owner, owner + 1, memory_order_release);
+}
+
+// ─── MCS ────────────────────────────────────────────────────
+
+static mcs_node *mcs_node_get(void)
+{
+    mcs_node *node = NULL;
+    if (t_mcs_depth >= LOCK_MCS_NEST)
+        abort();
+    node = &t_mcs[t_mcs_depth++];
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    atomic_store_explicit(&node->locked, TRUE, memory_order_relaxed);
+    return node;
+}
+
+static int mcs_try(cas_lock *lock)
+{
+    mcs_node *node = mcs_node_get();
+    mcs_node *expected = NULL;
+    if (!atomic_compare_exchange_strong_explicit(&lock->mcs.tail, &expected, node,
+                                                 memory_order_acq_rel, memory_order_relaxed))
+    {
+        t_mcs_depth--;
+        return FALSE;
+    }
+    lock->mcs.holder = node;
+    return TRUE;
+}
+
+static void mcs_acquire(cas_lock *lock)
+{
+    mcs_node *node = mcs_node_get();
+    // 노드 초기화(relaxed)를 다음 대기자에게 공개하므로 acq_rel
+    mcs_node *prev = atomic_exchange_explicit(&lock->mcs.tail, node, memory_order_acq_rel);
+    unsigned int spins = 0;
+
+    if (prev)
+    {
+        // 앞 노드에 나를 걸고, 내 노드의 locked 만 보며 대기
+        atomic_store_explicit(&prev->next, node, memory_order_release);
+        while (atomic_load_explicit(&node->locked, memory_order_acquire))
+            spin_wait(&spins);
+    }
+    lock->mcs.holder = node;
+}
+
+static void mcs_release(cas_lock *lock)
+{
+    mcs_node *node = lock->mcs.holder;
+    mcs_node *next = atomic_load_explicit(&node->next, memory_order_acquire);
+    unsigned int spins = 0;
+
+    if (!next)
+    {
+        // 뒤에 아무도 없으면 tail 을 비우고 끝
+        mcs_node *expected = node;
+        if (atomic_compare_exchange_strong_explicit(&lock->mcs.tail, &expected, NULL,
+                                                    memory_order_release, memory_order_relaxed))
+        {
+            t_mcs_depth--;
+            return;
+        }
+        // tail 은 바뀌었는데 아직 next 를 걸지 않은 대기자: 걸 때까지 기다림
+        while (!(next = atomic_load_explicit(&node->next, memory_order_acquire)))
+            spin_wait(&spins);
+    }
+    atomic_store_explicit(&next->locked, FALSE, memory_order_release);
+    t_mcs_depth--;
+}
+
+// ─── spin-then-futex ────────────────────────────────────────
+
+// atomic_int 는 int 와 표현이 같음 (커널은 주소의 32비트 값만 비교)
+static long futex(atomic_int *addr, int op, int val)
+{
+    return syscall(SYS_futex, (int *)addr, op, val, NULL, NULL, 0);
+}
+
+static int adaptive_try(cas_lock *lock)
+{
+    int expected = 0;
+    return atomic_compare_exchange_strong_explicit(&lock->futex, &expected, 1,
+                                                   memory_order_acquire, memory_order_relaxed);
+}
+
+static void adaptive_acquire(cas_lock *lock)
+{
+    int c = 0;
+    int i;
+
+    for (i = 0; i < LOCK_ADAPTIVE_SPIN; i++)
+    {
+        if (!atomic_load_explicit(&lock->futex, memory_order_relaxed) && adaptive_try(lock))
+            return;
+        cpu_relax();
+    }
+
+    // 2 로 표시하고 잠듦 → release 가 깨워야 한다는 것을 앎
+    c = atomic_exchange_explicit(&lock->futex, 2, memory_order_acquire);
+    while (c != 0)
+    {
+        futex(&lock->futex, FUTEX_WAIT_PRIVATE, 2);
+        c = atomic_exchange_explicit(&lock->futex, 2, memory_order_acquire);
+    }
+}
+
+static void adaptive_release(cas_lock *lock)
+{
+    // 1 → 0 이면 대기자 없음. 2 였으면 하나 깨움
+    if (atomic_fetch_sub_explicit(&lock->futex, 1, memory_order_release) != 1)
+    {
+        atomic_store_explicit(&lock->futex, 0, memory_order_release);
+        futex(&lock->futex, FUTEX_WAKE_PRIVATE, 1);
+    }
+}
+
+// ─── 공개 API ─────────────────────────────────────────────────
+
+void cas_lock_init(cas_lock *lock, int kind)
+{
+    lock->kind = (kind >= 0 && kind < LOCK_KIND_COUNT) ? kind : LOCK_TTAS;
+    // 공용체 멤버가 겹치므로 모든 종류를 0 으로 초기화 (flag/futex 는 ticket.next 와 같은 자리)
+    atomic_init(&lock->ticket.next, 0);
+    atomic_init(&lock->ticket.owner, 0);
+    atomic_init(&lock->mcs.tail, NULL);
+    lock->mcs.holder = NULL;
+    atomic_init(&lock->flag, 0);
+}
+
+void cas_lock_acquire(cas_lock *lock)
+{
+    switch (lock->kind)
+    {
+        case LOCK_TTAS:     ttas_acquire(lock);     break;
+        case LOCK_TICKET:   ticket_acquire(lock);   break;
+        case LOCK_MCS:      mcs_acquire(lock);      break;
+        case LOCK_ADAPTIVE: adaptive_acquire(lock); break;
+    }
+}
+
+int cas_lock_try(cas_lock *lock)
+{
+    switch (lock->kind)
+    {
+        case LOCK_TTAS:     return ttas_try(lock);
+        case LOCK_TICKET:   return ticket_try(lock);
+        case LOCK_MCS:      return mcs_try(lock);
+        case LOCK_ADAPTIVE: return adaptive_try(lock);
+    }
+    return FALSE;
+}
+
+void cas_lock_release(cas_lock *lock)
+{
+    switch (lock->kind)
+    {
+        case LOCK_TTAS:     ttas_release(lock);     break;
+        case LOCK_TICKET:   ticket_release(lock);   break;
+        case LOCK_MCS:      mcs_release(lock);      break;
+        case LOCK_ADAPTIVE: adaptive_release(lock); break;
+    }
+}
+
+const char *cas_lock_name(int kind)
+{
+    static const char *names[LOCK_KIND_COUNT] = { "ttas", "ticket", "mcs", "adaptive" };
+    return (kind >= 0 && kind < LOCK_KIND_COUNT) ? names[kind] : "?";
+}
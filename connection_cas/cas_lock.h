@@ -0,0 +1,68 @@
+#ifndef CAS_LOCK_H
+#define CAS_LOCK_H
+
+#include <stdatomic.h>
+
+// 짧은 임계 구역용 락 모음. 같은 cas_lock 인터페이스로 종류만 골라 씀
+//   TTAS     : 읽기로 먼저 확인 후 exchange, 실패하면 지수 backoff → 한계에서 sched_yield
+//   TICKET   : 번호표 순서대로 (공정), 앞 사람 수에 비례해 대기
+//   MCS      : 대기자마다 자기 노드에서 스핀 → 락 캐시 라인 하나에 몰리지 않음
+//   ADAPTIVE : 잠깐 스핀 후 futex 로 잠듦 → 코어보다 스레드가 많아도 CPU 를 태우지 않음
+// 모두 acquire/release 순서를 지킴 (release 는 임계 구역 쓰기가 먼저 보이도록 release store)
+
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define cpu_relax() __asm__ __volatile__("yield" ::: "memory")
+#else
+#define cpu_relax() __asm__ __volatile__("" ::: "memory")
+#endif
+
+#define LOCK_BACKOFF_MIN   4        // pause 횟수
+#define LOCK_BACKOFF_MAX   1024
+#define LOCK_SPIN_LIMIT    128      // 이만큼 돌아도 못 잡으면 sched_yield (과구독 대비)
+#define LOCK_ADAPTIVE_SPIN 100      // futex 로 잠들기 전 스핀 횟수
+#define LOCK_MCS_NEST      4        // 한 스레드가 동시에 잡을 수 있는 MCS 락 수
+
+enum lock_kind
+{
+    LOCK_TTAS = 0,
+    LOCK_TICKET,
+    LOCK_MCS,
+    LOCK_ADAPTIVE,
+    LOCK_KIND_COUNT
+};
+
+typedef struct mcs_node
+{
+    _Atomic(struct mcs_node *) next;
+    atomic_int                 locked;
+} __attribute__((aligned(64))) mcs_node;
+
+typedef struct
+{
+    int kind;                           // enum lock_kind
+    union
+    {
+        atomic_int flag;                // TTAS: 0/1
+        struct
+        {
+            atomic_uint next;           // 다음에 나눠 줄 번호
+            atomic_uint owner;          // 지금 들어갈 번호
+        } ticket;
+        struct
+        {
+            _Atomic(mcs_node *) tail;
+            mcs_node           *holder; // 잡은 스레드의 노드 (주인만 읽고 씀)
+        } mcs;
+        atomic_int futex;               // ADAPTIVE: 0 = 풀림, 1 = 잡힘, 2 = 잡힘 + 잠든 대기자
+    };
+} cas_lock;
+
+void        cas_lock_init(cas_lock *lock, int kind);
+void        cas_lock_acquire(cas_lock *lock);
+int         cas_lock_try(cas_lock *lock);       // 바로 잡으면 TRUE
+void        cas_lock_release(cas_lock *lock);   // MCS 는 잡은 역순으로 풀어야 함
+const char *cas_lock_name(int kind);
+
+#endif // CAS_LOCK_H
@@ -1,7 +1,181 @@
 #include "conn_pool.h"
+#include "ebr.h"
+#include <stdatomic.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
 
-PGconn *get_conn(conn_pool *pool)
+// connect_info 가 없는 풀(테스트용 mock)은 libpq 호출을 건너뜀
+static int is_real(conn_pool *pool)
+{
+    return pool->connect_info[0] != '\0';
+}
+
+static long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+// ─── 생성 / 해제 ─────────────────────────────────────────────
+
+// exit_key 소멸자: 종료하는 스레드의 tid 캐시를 soft delete → reclaimer 가 회수
+static void forget_thread(void *arg)
+{
+    conn_pool *pool = (conn_pool *)arg;
+    hash_delete_soft(pool->map, (unsigned long)pthread_self());
+}
+
+int conn_pool_init(conn_pool *pool)
+{
+    pool->map = malloc(sizeof(hash_map));
+    pool->que = malloc(sizeof(wait_que));
+    if(!pool->map || !pool->que)
+    {
+        free(pool->map);
+        free(pool->que);
+        pool->map = NULL;
+        pool->que = NULL;
+        return FAIL;
+    }
+    hash_init(pool->map);
+    queue_init(pool->que);
+    // tls_key 는 index+1 정수만 담으므로 소멸자 불필요
+    pthread_key_create(&pool->tls_key, NULL);
+    pthread_key_create(&pool->exit_key, forget_thread);
+    return SUCCESS;
+}
+
+conn_pool *conn_pool_create(const char *conninfo)
+{
+    int i;
+    int failed = 0;
+    conn_pool *pool = calloc(1, sizeof(conn_pool));
+    if(!pool)
+        return NULL;
+
+    strncpy(pool->connect_info, conninfo, sizeof(pool->connect_info) - 1);
+    if(conn_pool_init(pool) == FAIL)
+    {
+        free(pool);
+        return NULL;
+    }
+
+    for(i = 0; i < CONN_SIZE; i++)
+    {
+        pool->conn_list[i] = PQconnectdb(conninfo);
+        if(PQstatus(pool->conn_list[i]) != CONNECTION_OK)
+        {
+            fprintf(stderr, "[ERR] PQconnectdb[%d]: %s\n",
+                    i, PQerrorMessage(pool->conn_list[i]));
+            PQfinish(pool->conn_list[i]);
+            pool->conn_list[i] = NULL;
+            // 잠근 채 CLOSE 로 두면 나눠 주지 않고 하우스키퍼가 재연결
+            atomic_store_explicit(&pool->state[i], CONN_UNAVAILABLE, memory_order_relaxed);
+            atomic_store_explicit(&pool->flag[i], CLOSE, memory_order_relaxed);
+            failed++;
+        }
+    }
+    if(failed == CONN_SIZE)
+    {
+        conn_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void conn_pool_destroy(conn_pool *pool)
+{
+    int i;
+    conn_pool_housekeeper_stop(pool);
+    conn_pool_reclaimer_stop(pool);
+
+    if(is_real(pool))
+    {
+        for(i = 0; i < CONN_SIZE; i++)
+        {
+            if(pool->cancel[i])
+                PQfreeCancel(pool->cancel[i]);
+            if(pool->conn_list[i])
+                PQfinish(pool->conn_list[i]);
+        }
+    }
+
+    if(pool->classes)
+    {
+        for(i = 0; i < pool->nclass; i++)
+            queue_destroy(&pool->classes[i].que);
+        free(pool->classes);
+    }
+
+    // 이후 종료하는 스레드는 소멸자를 호출하지 않음
+    pthread_key_delete(pool->exit_key);
+    pthread_key_delete(pool->tls_key);
+    queue_destroy(pool->que);
+    hash_destroy(pool->map);
+    free(pool->map);
+    free(pool->que);
+    free(pool);
+}
+
+// ─── 획득 / 반납 ─────────────────────────────────────────────
+// state: 점유 CAS 는 acquire (이전 주인이 반납 전에 쓴 내용을 봄), 반납은 주인만 하므로 release store.
+// flag: 소유 스레드와 워치독/하우스키퍼가 넘겨받는 상태 → CAS 는 acq_rel, 읽기는 acquire
+
+static int try_take(conn_pool *pool, int index)
+{
+    int expected = CONN_AVAILABLE;
+    return atomic_compare_exchange_strong_explicit(&pool->state[index], &expected, CONN_UNAVAILABLE,
+                                                   memory_order_acquire, memory_order_relaxed);
+}
+
+static void give_back(conn_pool *pool, int index)
+{
+    atomic_store_explicit(&pool->state[index], CONN_AVAILABLE, memory_order_release);
+}
+
+static int flag_cas(conn_pool *pool, int index, int from, int to)
+{
+    return atomic_compare_exchange_strong_explicit(&pool->flag[index], &from, to,
+                                                   memory_order_acq_rel, memory_order_acquire);
+}
+
+static int flag_get(conn_pool *pool, int index)
+{
+    return atomic_load_explicit(&pool->flag[index], memory_order_acquire);
+}
+
+static void count(atomic_long *counter)
+{
+    atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
+}
+
+// 슬롯 점유 직후 호출. deadline 이 없으면 flag 는 NONE 그대로 두어
+// 워치독 대상에서 빠지고 반납 경로에도 CAS 가 추가되지 않음
+static PGconn *claim(conn_pool *pool, int index, long timeout_ms)
+{
+    if (timeout_ms <= 0)
+        return pool->conn_list[index];
+
+    // PQgetCancel 은 커넥션 소유 스레드에서만 안전 → 점유 중인 지금 생성
+    if (!pool->cancel[index] && is_real(pool) && pool->conn_list[index])
+        pool->cancel[index] = PQgetCancel(pool->conn_list[index]);
+    pool->hold_ms[index] = timeout_ms;
+    pool->cancel_sent[index] = FALSE;
+    atomic_store_explicit(&pool->deadline[index], now_ms() + timeout_ms, memory_order_relaxed);
+
+    // 점유 중인 NONE 슬롯은 소유 스레드만 바꿈 → deadline/cancel 기록 후 release store 로 공개
+    atomic_store_explicit(&pool->flag[index], IN_USING, memory_order_release);
+    return pool->conn_list[index];
+}
+
+// hash_map 캐시 → 전체 순회 순으로 빈 슬롯 점유. 없으면 -1
+static int find_slot(conn_pool *pool)
 {
     int i = 0;
     int index = -1;
@@ -9,23 +183,45 @@ PGconn *get_conn(conn_pool *pool)
 
     // fast path: 이 스레드가 마지막으로 쓴 커넥션 인덱스 캐시 조회
     index = hash_get(pool->map, tid);
-    if(index != -1 && __sync_bool_compare_and_swap(&pool->state[index], CONN_AVAILABLE, CONN_UNAVAILABLE))
-        return pool->conn_list[index];
+    if(index != -1 && try_take(pool, index))
+        return index;
 
     // slow path: 풀 전체 순회
     for(i = 0; i < CONN_SIZE; i++)
     {
-        if(!__sync_bool_compare_and_swap(&pool->state[i], CONN_AVAILABLE, CONN_UNAVAILABLE))
+        if(!try_take(pool, i))
             continue;
 
         // 찾은 인덱스를 해시맵에 캐싱 → 다음 요청은 fast path로
         hash_insert(pool->map, tid, i);
-        return pool->conn_list[i];
+
+        // 이 스레드가 종료될 때 캐시 항목을 지우도록 소멸자 등록 (스레드당 1회)
+        if(!pthread_getspecific(pool->exit_key))
+            pthread_setspecific(pool->exit_key, pool);
+        return i;
     }
+    return -1;
+}
 
-    // 풀 고갈: wait_que에 대기 후 깨어나면 재시도
-    enque(pool->que);
-    return get_conn(pool);
+// 풀 고갈: release_conn 이 깨울 때까지 wait_que 에서 잠든 뒤 재시도.
+// 빈 슬롯 확인과 잠들기 사이의 반납은 놓칠 수 있어 시간 제한을 둠 (큐가 가득 차면 양보)
+static void wait_release(conn_pool *pool)
+{
+    if(enque_timed(pool->que, POOL_WAIT_MS) == FAIL)
+        sched_yield();
+}
+
+PGconn *get_conn_timeout(conn_pool *pool, long timeout_ms)
+{
+    int index;
+    while((index = find_slot(pool)) == -1)
+        wait_release(pool);
+    return claim(pool, index, timeout_ms);
+}
+
+PGconn *get_conn(conn_pool *pool)
+{
+    return get_conn_timeout(pool, pool->hold_timeout_ms);
 }
 
 // ─── get_conn_2: per-pool pthread_key_t TLS fast path ────────
@@ -34,30 +230,35 @@ PGconn *get_conn_2(conn_pool *pool)
 {
     int i;
 
-    // fast path: 이 풀 전용 TLS에서 인덱스 조회 (저장값 = index+1, 0=미설정)
-    intptr_t cached = (intptr_t)pthread_getspecific(pool->tls_key);
-    if (cached > 0)
+    for (;;)
     {
-        int idx = (int)(cached - 1);
-        if (__sync_bool_compare_and_swap(&pool->state[idx], CONN_AVAILABLE, CONN_UNAVAILABLE))
-            return pool->conn_list[idx];
-    }
+        // fast path: 이 풀 전용 TLS에서 인덱스 조회 (저장값 = index+1, 0=미설정)
+        intptr_t cached = (intptr_t)pthread_getspecific(pool->tls_key);
+        if (cached > 0)
+        {
+            int idx = (int)(cached - 1);
+            if (try_take(pool, idx))
+                return claim(pool, idx, pool->hold_timeout_ms);
+        }
 
-    // slow path: 풀 전체 순회
-    for (i = 0; i < CONN_SIZE; i++)
-    {
-        if (!__sync_bool_compare_and_swap(&pool->state[i], CONN_AVAILABLE, CONN_UNAVAILABLE))
-            continue;
+        // slow path: 풀 전체 순회
+        for (i = 0; i < CONN_SIZE; i++)
+        {
+            if (!try_take(pool, i))
+                continue;
 
-        pthread_setspecific(pool->tls_key, (void *)(intptr_t)(i + 1));
-        return pool->conn_list[i];
-    }
+            pthread_setspecific(pool->tls_key, (void *)(intptr_t)(i + 1));
+            return claim(pool, i, pool->hold_timeout_ms);
+        }
 
-    // 풀 고갈: wait_que에 대기 후 재시도
-    enque(pool->que);
-    return get_conn_2(pool);
+        // 풀 고갈: wait_que에 대기 후 재시도
+        wait_release(pool);
+    }
 }
 
+static void put_token(conn_pool *pool, int cls, int kind);
+static void wake_waiter(conn_pool *pool, int cls, int kind);
+
 void release_conn(conn_pool *pool, PGconn *conn)
 {
     int i = 0;
@@ -66,10 +267,418 @@ void release_conn(conn_pool *pool, PGconn *conn)
         if(pool->conn_list[i] != conn)
             continue;
 
-        __sync_bool_compare_and_swap(&pool->state[i], CONN_UNAVAILABLE, CONN_AVAILABLE);
+        // 클래스 획득이었으면 몫(token)도 함께 반환
+        int cls  = pool->slot_class[i] - 1;
+        int kind = pool->slot_kind[i];
+        pool->slot_class[i] = 0;
+
+        // 반납하는 점유의 deadline 을 먼저 지움 → 다음 점유가 새 값을 쓰기 전에 워치독이
+        // 옛 deadline 으로 판단하지 않음 (IN_USING 인데 0 이면 expire_slot 이 그냥 돌려놓음)
+        atomic_store_explicit(&pool->deadline[i], 0, memory_order_release);
+
+        // deadline 없이 점유한 슬롯은 flag 가 NONE 그대로 → CAS 생략
+        while(flag_get(pool, i) != NONE && !flag_cas(pool, i, IN_USING, NONE))
+        {
+            int flag = flag_get(pool, i);
+
+            // 취소 실패한 커넥션: 슬롯은 잠근 채 하우스키퍼에 넘김
+            if(flag == BROKEN && flag_cas(pool, i, BROKEN, CLOSE))
+            {
+                put_token(pool, cls, kind);
+                return;
+            }
+            // 워치독이 PQcancel 중이면 끝날 때까지 양보
+            if(flag == CHECKING)
+            {
+                sched_yield();
+                continue;
+            }
+            // 이미 반납된 슬롯
+            if(flag == CLOSE)
+                return;
+            if(flag == NONE)
+                break;
+        }
+
+        // 세션이 끊긴 커넥션은 재사용하지 않고 재연결 대기
+        if(is_real(pool) && PQstatus(conn) != CONNECTION_OK)
+        {
+            flag_cas(pool, i, NONE, CLOSE);
+            count(&pool->broken_count);
+            put_token(pool, cls, kind);
+            return;
+        }
+
+        give_back(pool, i);
+
+        // 슬롯을 먼저 풀고 몫을 반환해야 깨어난 스레드가 빈 슬롯을 찾음
+        put_token(pool, cls, kind);
 
         // 대기 중인 스레드가 있으면 하나 깨움
+        wake_waiter(pool, cls, kind);
+        return;
+    }
+}
+
+// ─── 획득 클래스: 보장 슬롯 + 가중치 기반 공유 슬롯 ──────────
+// 전역 락 없이 클래스별 카운터 CAS 로 몫(token)을 잡은 뒤 실제 슬롯을 점유
+
+#define TOKEN_RESERVED  1
+#define TOKEN_SHARED    2
+#define CLASS_WAIT_MS   5     // 놓친 깨우기에 대한 안전망
+
+int conn_pool_set_classes(conn_pool *pool, const class_conf *conf, int n)
+{
+    int i;
+    int reserved = 0;
+    int weights = 0;
+    acq_class *classes = NULL;
+
+    if(n <= 0 || n > MAX_CLASS || pool->classes)
+        return FAIL;
+    for(i = 0; i < n; i++)
+    {
+        if(conf[i].min_slots < 0 || conf[i].weight < 0)
+            return FAIL;
+        reserved += conf[i].min_slots;
+        weights  += conf[i].weight;
+    }
+    if(reserved > CONN_SIZE)
+        return FAIL;
+
+    if(posix_memalign((void **)&classes, 64, sizeof(acq_class) * n) != 0)
+        return FAIL;
+    memset(classes, 0, sizeof(acq_class) * n);
+
+    pool->shared_size = CONN_SIZE - reserved;
+    for(i = 0; i < n; i++)
+    {
+        acq_class *c = &classes[i];
+        c->min_slots = conf[i].min_slots;
+        c->weight    = conf[i].weight;
+        // 가중치 비례 몫 (올림, 최소 1)
+        if(c->weight > 0 && pool->shared_size > 0)
+        {
+            c->cap = (pool->shared_size * c->weight + weights - 1) / weights;
+            if(c->cap < 1)
+                c->cap = 1;
+        }
+        queue_init(&c->que);
+    }
+    pool->nclass  = n;
+    pool->classes = classes;
+    return SUCCESS;
+}
+
+static int other_waiting(conn_pool *pool, int cls)
+{
+    int i;
+    for(i = 0; i < pool->nclass; i++)
+        if(i != cls && atomic_load_explicit(&pool->classes[i].waiting, memory_order_relaxed) > 0)
+            return TRUE;
+    return FALSE;
+}
+
+static int take_token(conn_pool *pool, int cls)
+{
+    acq_class *c = &pool->classes[cls];
+    int v, s;
+
+    // 1) 보장 슬롯
+    v = atomic_load_explicit(&c->reserved_used, memory_order_relaxed);
+    while(v < c->min_slots)
+        if(atomic_compare_exchange_weak_explicit(&c->reserved_used, &v, v + 1,
+                                                 memory_order_relaxed, memory_order_relaxed))
+            return TOKEN_RESERVED;
+
+    // 2) 공유 슬롯: 가중치 몫 안이거나, 기다리는 다른 클래스가 없으면 빌려 씀
+    v = atomic_load_explicit(&c->shared_used, memory_order_relaxed);
+    while(v < c->cap || (v < pool->shared_size && !other_waiting(pool, cls)))
+    {
+        if(!atomic_compare_exchange_weak_explicit(&c->shared_used, &v, v + 1,
+                                                  memory_order_relaxed, memory_order_relaxed))
+            continue;
+
+        s = atomic_load_explicit(&pool->shared_used, memory_order_relaxed);
+        while(s < pool->shared_size)
+            if(atomic_compare_exchange_weak_explicit(&pool->shared_used, &s, s + 1,
+                                                     memory_order_relaxed, memory_order_relaxed))
+                return TOKEN_SHARED;
+
+        atomic_fetch_sub_explicit(&c->shared_used, 1, memory_order_relaxed);
+        break;
+    }
+    return FALSE;
+}
+
+static void put_token(conn_pool *pool, int cls, int kind)
+{
+    acq_class *c;
+    if(cls < 0)
+        return;
+
+    c = &pool->classes[cls];
+    if(kind == TOKEN_RESERVED)
+        atomic_fetch_sub_explicit(&c->reserved_used, 1, memory_order_relaxed);
+    else
+    {
+        atomic_fetch_sub_explicit(&c->shared_used, 1, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&pool->shared_used, 1, memory_order_relaxed);
+    }
+}
+
+// 보장 몫은 같은 클래스에, 공유 몫은 가중치 대비 가장 덜 받은 대기 클래스에 넘김
+static void wake_waiter(conn_pool *pool, int cls, int kind)
+{
+    int i;
+    int best = -1;
+    long best_load = 0;
+
+    if(!pool->classes)
+    {
         deque(pool->que);
         return;
     }
+
+    if(cls >= 0 && kind == TOKEN_RESERVED && deque(&pool->classes[cls].que) == SUCCESS)
+        return;
+
+    for(i = 0; i < pool->nclass; i++)
+    {
+        acq_class *c = &pool->classes[i];
+        long load;
+        if(atomic_load_explicit(&c->waiting, memory_order_relaxed) == 0)
+            continue;
+        load = c->weight > 0
+             ? (long)atomic_load_explicit(&c->shared_used, memory_order_relaxed) * 1024 / c->weight
+             : 1L << 30;
+        if(best < 0 || load < best_load)
+        {
+            best = i;
+            best_load = load;
+        }
+    }
+    if(best < 0 || deque(&pool->classes[best].que) == FAIL)
+        deque(pool->que);
+}
+
+static long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+PGconn *get_conn_class(conn_pool *pool, int cls)
+{
+    acq_class *c = &pool->classes[cls];
+    long start = 0;
+    int kind;
+    int index;
+
+    for(;;)
+    {
+        kind = take_token(pool, cls);
+        if(kind)
+        {
+            index = find_slot(pool);
+            if(index != -1)
+                break;
+            // 몫은 있는데 슬롯이 하우스키퍼에 묶여 있음 → 돌려주고 대기
+            put_token(pool, cls, kind);
+        }
+
+        if(start == 0)
+            start = now_ns();
+        atomic_fetch_add_explicit(&c->waiting, 1, memory_order_relaxed);
+        if(enque_timed(&c->que, CLASS_WAIT_MS) == FAIL)
+            sched_yield();
+        atomic_fetch_sub_explicit(&c->waiting, 1, memory_order_relaxed);
+    }
+
+    pool->slot_class[index] = cls + 1;
+    pool->slot_kind[index]  = kind;
+
+    count(&c->acquired);
+    if(start)
+    {
+        long waited = now_ns() - start;
+        long max = atomic_load_explicit(&c->wait_ns_max, memory_order_relaxed);
+        count(&c->waits);
+        atomic_fetch_add_explicit(&c->wait_ns_total, waited, memory_order_relaxed);
+        while(max < waited
+              && !atomic_compare_exchange_weak_explicit(&c->wait_ns_max, &max, waited,
+                                                        memory_order_relaxed, memory_order_relaxed));
+    }
+    return claim(pool, index, pool->hold_timeout_ms);
+}
+
+void conn_pool_class_stats(conn_pool *pool, int cls, class_stats *out)
+{
+    acq_class *c = &pool->classes[cls];
+    out->acquired      = atomic_load_explicit(&c->acquired, memory_order_relaxed);
+    out->waits         = atomic_load_explicit(&c->waits, memory_order_relaxed);
+    out->wait_ns_total = atomic_load_explicit(&c->wait_ns_total, memory_order_relaxed);
+    out->wait_ns_max   = atomic_load_explicit(&c->wait_ns_max, memory_order_relaxed);
+}
+
+// ─── 워치독 / 하우스키퍼 ─────────────────────────────────────
+
+// 취소 요청 전송. mock 풀은 libpq 를 부르지 않고 핸들이 있으면 보낸 것으로 (테스트용 가짜 핸들)
+static int send_cancel(conn_pool *pool, int i)
+{
+    char errbuf[256];
+
+    if(!is_real(pool))
+        return TRUE;
+    return PQcancel(pool->cancel[i], errbuf, sizeof(errbuf));
+}
+
+// 점유 시간 초과: PQcancel 로 실행 중인 쿼리를 끊음. 소유 스레드는 에러를 받고 반납
+// 취소 후에도 같은 길이만큼 반납하지 않으면 (클라이언트 쪽에서 멈춤 등) BROKEN
+static void expire_slot(conn_pool *pool, int i, long now)
+{
+    long deadline;
+
+    if(!flag_cas(pool, i, IN_USING, CHECKING))
+        return;
+
+    // CAS 사이에 반납 → 재획득됐으면 새 deadline 기준으로 다시 판단
+    deadline = atomic_load_explicit(&pool->deadline[i], memory_order_relaxed);
+    if(deadline == 0 || now < deadline)
+    {
+        flag_cas(pool, i, CHECKING, IN_USING);
+        return;
+    }
+
+    // cancel_sent / hold_ms 는 CHECKING 인 동안 워치독만, 점유 직후(IN_USING 공개 전) 소유 스레드만 씀
+    if(!pool->cancel_sent[i] && pool->cancel[i] && send_cancel(pool, i))
+    {
+        pool->cancel_sent[i] = TRUE;
+        count(&pool->cancel_count);
+        atomic_store_explicit(&pool->deadline[i], now + pool->hold_ms[i], memory_order_relaxed);
+        flag_cas(pool, i, CHECKING, IN_USING);
+        return;
+    }
+
+    // 취소 불가(서버 무응답, 핸들 없음) 또는 취소 후에도 반납 안 함 → 반납 시 하우스키퍼가 재연결
+    atomic_store_explicit(&pool->deadline[i], 0, memory_order_relaxed);
+    count(&pool->broken_count);
+    flag_cas(pool, i, CHECKING, BROKEN);
+}
+
+// 반납된 CLOSE 슬롯 재연결 후 풀에 복귀
+static int recover_slot(conn_pool *pool, int i)
+{
+    if(!flag_cas(pool, i, CLOSE, CHECKING))
+        return FALSE;
+
+    if(is_real(pool))
+    {
+        // 재연결하면 backend pid 가 바뀌므로 취소 핸들도 새로 받아야 함
+        if(pool->cancel[i])
+        {
+            PQfreeCancel(pool->cancel[i]);
+            pool->cancel[i] = NULL;
+        }
+        if(pool->conn_list[i])
+            PQreset(pool->conn_list[i]);
+        else
+            pool->conn_list[i] = PQconnectdb(pool->connect_info);
+
+        if(PQstatus(pool->conn_list[i]) != CONNECTION_OK)
+        {
+            // 다음 주기에 재시도
+            flag_cas(pool, i, CHECKING, CLOSE);
+            return FALSE;
+        }
+    }
+
+    flag_cas(pool, i, CHECKING, NONE);
+    give_back(pool, i);
+    wake_waiter(pool, -1, 0);
+    return TRUE;
+}
+
+int conn_pool_check(conn_pool *pool)
+{
+    int i;
+    int recovered = 0;
+    long now = now_ms();
+
+    for(i = 0; i < CONN_SIZE; i++)
+    {
+        int flag = flag_get(pool, i);
+        long deadline = atomic_load_explicit(&pool->deadline[i], memory_order_relaxed);
+        if(flag == IN_USING && deadline != 0 && now >= deadline)
+            expire_slot(pool, i, now);
+        else if(flag == CLOSE)
+            recovered += recover_slot(pool, i);
+    }
+    return recovered;
+}
+
+static void *housekeeper_main(void *arg)
+{
+    conn_pool *pool = (conn_pool *)arg;
+    while(atomic_load_explicit(&pool->hk_running, memory_order_relaxed))
+    {
+        conn_pool_check(pool);
+        usleep(pool->hk_interval_ms * 1000);
+    }
+    return NULL;
+}
+
+int conn_pool_housekeeper_start(conn_pool *pool, long interval_ms)
+{
+    pool->hk_interval_ms = interval_ms;
+    atomic_store_explicit(&pool->hk_running, TRUE, memory_order_relaxed);
+    if(pthread_create(&pool->housekeeper, NULL, housekeeper_main, pool) != 0)
+    {
+        atomic_store_explicit(&pool->hk_running, FALSE, memory_order_relaxed);
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+void conn_pool_housekeeper_stop(conn_pool *pool)
+{
+    if(!atomic_load_explicit(&pool->hk_running, memory_order_relaxed))
+        return;
+    atomic_store_explicit(&pool->hk_running, FALSE, memory_order_relaxed);
+    pthread_join(pool->housekeeper, NULL);
+}
+
+static void *reclaimer_main(void *arg)
+{
+    conn_pool *pool = (conn_pool *)arg;
+    while(atomic_load_explicit(&pool->rc_running, memory_order_relaxed))
+    {
+        if(hash_deleted(pool->map) > 0)
+            hash_delete(pool->map);
+        else if(ebr_pending() > 0)
+            ebr_collect();      // 리사이즈로 retire 된 옛 테이블
+        usleep(pool->rc_interval_ms * 1000);
+    }
+    return NULL;
+}
+
+int conn_pool_reclaimer_start(conn_pool *pool, long interval_ms)
+{
+    pool->rc_interval_ms = interval_ms;
+    atomic_store_explicit(&pool->rc_running, TRUE, memory_order_relaxed);
+    if(pthread_create(&pool->reclaimer, NULL, reclaimer_main, pool) != 0)
+    {
+        atomic_store_explicit(&pool->rc_running, FALSE, memory_order_relaxed);
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+void conn_pool_reclaimer_stop(conn_pool *pool)
+{
+    if(!atomic_load_explicit(&pool->rc_running, memory_order_relaxed))
+        return;
+    atomic_store_explicit(&pool->rc_running, FALSE, memory_order_relaxed);
+    pthread_join(pool->reclaimer, NULL);
 }
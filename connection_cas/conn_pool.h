@@ -2,17 +2,19 @@
 #define CONN_POOL_H
 
 #include <libpq-fe.h>
+#include <stdatomic.h>
 #include "thread_safe_queue.h"
 
 #define CONN_SIZE   10
+#define POOL_WAIT_MS 50     // 풀 고갈 대기 1 회 상한 (놓친 깨우기에 대한 안전망)
 
 enum conn_flag
 {
-    NONE = 0,
-    IN_USING,
-    BROKEN,
-    CHECKING,
-    CLOSE
+    NONE = 0,       // 반납됨
+    IN_USING,       // 점유 중
+    BROKEN,         // 점유 중이지만 취소 실패/비정상 → 반납 시 CLOSE 로
+    CHECKING,       // 워치독/하우스키퍼가 작업 중
+    CLOSE           // 반납된 불량 커넥션, 하우스키퍼 재연결 대기
 };
 
 enum state_flag
@@ -21,18 +23,98 @@ enum state_flag
     CONN_UNAVAILABLE
 };
 
+#define MAX_CLASS   4
+
+// 획득 클래스 설정: 보장 슬롯 + 나머지(공유 슬롯)에 대한 가중치
+typedef struct
+{
+    int min_slots;
+    int weight;
+} class_conf;
+
+typedef struct
+{
+    long acquired;
+    long waits;             // 대기까지 간 획득 수
+    long wait_ns_total;
+    long wait_ns_max;
+} class_stats;
+
+// 클래스별 카운터는 캐시 라인을 나눠 서로 다른 클래스끼리 경합하지 않게 함.
+// 카운터는 몫을 세기만 하고 다른 데이터를 공개하지 않으므로 relaxed
+typedef struct
+{
+    int          min_slots;
+    int          cap;            // 공유 슬롯 상한 (가중치 비례)
+    int          weight;
+    atomic_int   reserved_used;
+    atomic_int   shared_used;
+    atomic_int   waiting;
+    atomic_long  acquired;       // class_stats 로 읽어 감
+    atomic_long  waits;
+    atomic_long  wait_ns_total;
+    atomic_long  wait_ns_max;
+    wait_que     que;            // 이 클래스 전용 대기 큐
+} __attribute__((aligned(64))) acq_class;
+
 typedef struct
 {
     PGconn        *conn_list[CONN_SIZE];
-    int            state[CONN_SIZE];   // CAS로 점유 관리 (AVAILABLE/UNAVAILABLE)
+    atomic_int     state[CONN_SIZE];   // CAS로 점유 관리 (AVAILABLE/UNAVAILABLE)
+    atomic_int     flag[CONN_SIZE];    // enum conn_flag: 워치독/하우스키퍼와 CAS로 조율
+    atomic_long    deadline[CONN_SIZE];// 점유 만료 시각 (CLOCK_MONOTONIC ms, 0 = 무제한)
+    PGcancel      *cancel[CONN_SIZE];  // 워치독이 쓰는 취소 핸들 (첫 타임아웃 획득 시 생성)
+    long           hold_ms[CONN_SIZE]; // 이번 점유의 제한 (PQcancel 후 유예도 같은 길이)
+    unsigned char  cancel_sent[CONN_SIZE]; // 이번 점유에 PQcancel 을 보냄 → 다음 만료는 BROKEN
+    long           hold_timeout_ms;    // get_conn/get_conn_2 기본 점유 제한 (0 = 무제한)
+    atomic_long    cancel_count;       // 워치독이 보낸 PQcancel 횟수
+    atomic_long    broken_count;       // BROKEN 처리된 횟수
     hash_map      *map;                // tid → conn index 캐시 (get_conn용)
     wait_que      *que;                // 풀 고갈 시 대기 큐
     pthread_key_t  tls_key;           // per-pool TLS 키 (get_conn_2용)
-    char           connect_info[1024];
+    pthread_key_t  exit_key;          // 스레드 종료 시 map 항목 soft delete (값 = pool)
+    pthread_t      housekeeper;
+    atomic_int     hk_running;
+    pthread_t      reclaimer;
+    atomic_int     rc_running;
+    long           rc_interval_ms;
+    long           hk_interval_ms;
+    acq_class     *classes;            // conn_pool_set_classes 전에는 NULL
+    int            nclass;
+    int            shared_size;        // CONN_SIZE - 보장 슬롯 합
+    atomic_int     shared_used;
+    int            slot_class[CONN_SIZE]; // 점유한 클래스 + 1 (0 = 클래스 없이 획득)
+    int            slot_kind[CONN_SIZE];  // 보장/공유 중 어느 몫으로 잡았는지
+    char           connect_info[1024]; // 비어 있으면 mock 풀: libpq 호출 생략
 } conn_pool;
 
+// 풀 전용 hash_map / wait_que / TLS 키 할당 (conn_list 는 호출자가 채움)
+int        conn_pool_init(conn_pool *pool);
+// calloc + conn_pool_init + CONN_SIZE 개 PQconnectdb.
+// 실패한 슬롯은 CLOSE 로 잠가 하우스키퍼가 재연결, 모두 실패하면 NULL
+conn_pool *conn_pool_create(const char *conninfo);
+// 하우스키퍼 정지, 커넥션/취소 핸들/맵/큐 해제 후 free
+void       conn_pool_destroy(conn_pool *pool);
+
 PGconn *get_conn(conn_pool *pool);    // 캐시: hash_map (tid → index)
 PGconn *get_conn_2(conn_pool *pool);  // 캐시: TLS (__thread)
+PGconn *get_conn_timeout(conn_pool *pool, long timeout_ms); // get_conn + 이번 점유만의 deadline
 void    release_conn(conn_pool *pool, PGconn *conn);
 
+// 클래스 설정 (풀 사용 전 1회). 보장 슬롯 합이 CONN_SIZE 를 넘으면 FAIL.
+// 설정 후에는 get_conn_class 만 사용 (get_conn 과 섞으면 보장이 깨짐)
+int     conn_pool_set_classes(conn_pool *pool, const class_conf *conf, int n);
+PGconn *get_conn_class(conn_pool *pool, int cls);
+void    conn_pool_class_stats(conn_pool *pool, int cls, class_stats *out);
+
+// 하우스키퍼 1회: 만료된 점유는 PQcancel (두 번째 만료 시 BROKEN),
+// 반납된 BROKEN 커넥션은 재연결 후 풀에 복귀. 복구한 슬롯 수 반환
+int     conn_pool_check(conn_pool *pool);
+int     conn_pool_housekeeper_start(conn_pool *pool, long interval_ms);
+void    conn_pool_housekeeper_stop(conn_pool *pool);
+
+// 종료된 스레드가 남긴 soft delete 항목을 주기적으로 hash_delete, retire 된 테이블 회수
+int     conn_pool_reclaimer_start(conn_pool *pool, long interval_ms);
+void    conn_pool_reclaimer_stop(conn_pool *pool);
+
 #endif // CONN_POOL_H
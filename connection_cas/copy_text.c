@@ -0,0 +1,155 @@
+#include "copy_text.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// 특수 문자 한 글자를 escape 해서 씀 (반환 = 쓴 바이트 수). NUL 은 호출 전에 걸러짐
+static inline size_t escape_special(char *p, char c)
+{
+    p[0] = '\\';
+    switch (c)
+    {
+    case '\n': p[1] = 'n'; break;
+    case '\r': p[1] = 'r'; break;
+    case '\t': p[1] = 't'; break;
+    default:   p[1] = c;   break;   // '\\'
+    }
+    return 2;
+}
+
+size_t copy_escape_scalar(char *dst, const char *src, size_t len)
+{
+    char *p = dst;
+    size_t i;
+
+    for (i = 0; i < len && src[i] != '\0'; i++)
+    {
+        switch (src[i])
+        {
+        case '\\': *p++ = '\\'; *p++ = '\\'; break;
+        case '\n': *p++ = '\\'; *p++ = 'n'; break;
+        case '\r': *p++ = '\\'; *p++ = 'r'; break;
+        case '\t': *p++ = '\\'; *p++ = 't'; break;
+        default:   *p++ = src[i]; break;
+        }
+    }
+    return p - dst;
+}
+
+#if defined(__x86_64__)
+
+// 블록을 통째로 저장한 뒤 특수 문자 앞까지만 인정. p - dst <= 2 * i 이고 i + 16 <= len 이므로
+// 저장 끝(p + 16)은 dst + 2 * len 을 넘지 않음.
+// AVX2 구현의 꼬리 처리에도 인라인됨 → 그쪽에서는 VEX 인코딩이라 SSE/AVX 전환 비용이 없음
+static inline __attribute__((always_inline))
+size_t escape_sse2_body(char *dst, const char *src, size_t len)
+{
+    const __m128i bs  = _mm_set1_epi8('\\');
+    const __m128i nl  = _mm_set1_epi8('\n');
+    const __m128i cr  = _mm_set1_epi8('\r');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i nul = _mm_setzero_si128();
+    char *p = dst;
+    size_t i = 0;
+
+    while (i + 16 <= len)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, bs), _mm_cmpeq_epi8(v, nl)),
+                                 _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, tab)));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(m, _mm_cmpeq_epi8(v, nul)));
+
+        _mm_storeu_si128((__m128i *)p, v);
+        if (mask == 0)
+        {
+            p += 16;
+            i += 16;
+            continue;
+        }
+        unsigned k = (unsigned)__builtin_ctz(mask);
+        p += k;
+        i += k;
+        if (src[i] == '\0')
+            return p - dst;
+        p += escape_special(p, src[i]);
+        i++;
+    }
+    return (p - dst) + copy_escape_scalar(p, src + i, len - i);
+}
+
+size_t copy_escape_sse2(char *dst, const char *src, size_t len)
+{
+    return escape_sse2_body(dst, src, len);
+}
+
+__attribute__((target("avx2")))
+size_t copy_escape_avx2(char *dst, const char *src, size_t len)
+{
+    const __m256i bs  = _mm256_set1_epi8('\\');
+    const __m256i nl  = _mm256_set1_epi8('\n');
+    const __m256i cr  = _mm256_set1_epi8('\r');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i nul = _mm256_setzero_si256();
+    char *p = dst;
+    size_t i = 0;
+
+    while (i + 32 <= len)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, bs), _mm256_cmpeq_epi8(v, nl)),
+                                    _mm256_or_si256(_mm256_cmpeq_epi8(v, cr), _mm256_cmpeq_epi8(v, tab)));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_or_si256(m, _mm256_cmpeq_epi8(v, nul)));
+
+        _mm256_storeu_si256((__m256i *)p, v);
+        if (mask == 0)
+        {
+            p += 32;
+            i += 32;
+            continue;
+        }
+        unsigned k = (unsigned)__builtin_ctz(mask);
+        p += k;
+        i += k;
+        if (src[i] == '\0')
+            return p - dst;
+        p += escape_special(p, src[i]);
+        i++;
+    }
+    // 남은 32 바이트 미만은 16 바이트 블록 + scalar
+    return (p - dst) + escape_sse2_body(p, src + i, len - i);
+}
+
+#endif
+
+static copy_escape_fn g_impl = copy_escape_scalar;
+static const char    *g_impl_name = "scalar";
+
+// main 전에 한 번: 이후 읽기만 하므로 스레드 간 동기화가 필요 없음
+__attribute__((constructor))
+static void copy_escape_select(void)
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        g_impl = copy_escape_avx2;
+        g_impl_name = "avx2";
+    }
+    else
+    {
+        g_impl = copy_escape_sse2;     // x86-64 는 SSE2 가 기본
+        g_impl_name = "sse2";
+    }
+#endif
+}
+
+size_t copy_escape(char *dst, const char *src, size_t len)
+{
+    return g_impl(dst, src, len);
+}
+
+const char *copy_escape_impl(void)
+{
+    return g_impl_name;
+}
@@ -0,0 +1,24 @@
+#ifndef COPY_TEXT_H
+#define COPY_TEXT_H
+
+#include <stddef.h>
+
+// PostgreSQL COPY text 형식 escape: \ → \\, \n → \n, \r → \r, \t → \t (두 글자로)
+// 입력은 len 바이트 또는 첫 NUL 까지 (text 파라미터와 같은 의미). dst 는 2 * len 바이트 필요.
+// 벡터 구현은 16/32 바이트씩 특수 문자 5 개(\ \n \r \t NUL)와 비교해 없으면 그대로 저장하고,
+// 있으면 그 앞까지만 인정한 뒤 한 글자를 처리. 평범한 텍스트는 바이트당 분기가 없음.
+// 저장은 항상 2 * len 안쪽에서 끝남 (남은 입력이 32 바이트 이상일 때만 통째로 저장)
+
+typedef size_t (*copy_escape_fn)(char *dst, const char *src, size_t len);
+
+size_t copy_escape_scalar(char *dst, const char *src, size_t len);
+#if defined(__x86_64__)
+size_t copy_escape_sse2(char *dst, const char *src, size_t len);
+size_t copy_escape_avx2(char *dst, const char *src, size_t len);   // AVX2 가 있는 CPU 에서만
+#endif
+
+// CPU 에 맞는 구현 (프로그램 시작 때 골라 둠). 이름은 "avx2" / "sse2" / "scalar"
+size_t      copy_escape(char *dst, const char *src, size_t len);
+const char *copy_escape_impl(void);
+
+#endif // COPY_TEXT_H
@@ -0,0 +1,207 @@
+#include "ebr.h"
+#include "slab.h"
+#include "thread_safe_queue.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <sched.h>
+
+// 읽기 쪽 "epoch 공표(store) → 공유 포인터 읽기(load)" 와 회수 쪽 "포인터 교체(store) → epoch 검사(load)"
+// 는 store→load 순서라 acquire/release 로는 막을 수 없음 → 이 네 곳만 seq_cst
+// (fence 대신 연산 자체를 seq_cst 로: x86 에서 store 는 xchg, load 는 일반 mov)
+
+// 스레드별 읽기 기록. 캐시 라인을 나눠 다른 스레드의 enter/exit 와 공유하지 않음
+typedef struct ebr_record
+{
+    atomic_ulong           epoch;   // (epoch << 1) | 1 = 읽기 중, 0 = 밖
+    atomic_int             in_use;  // 스레드가 점유 중 (종료 시 반납 → 재사용)
+    int                    depth;   // 중첩 enter 횟수 (소유 스레드만 접근)
+    struct ebr_record     *next;    // 목록에 공개된 뒤에는 바뀌지 않음
+} __attribute__((aligned(64))) ebr_record;
+
+typedef struct ebr_node
+{
+    void            *ptr;
+    ebr_free_fn      free_fn;
+    struct ebr_node *next;
+} ebr_node;
+
+static atomic_ulong           g_epoch = 1;
+static _Atomic(ebr_record *)  g_records = NULL;
+
+// limbo[e % 3]: epoch e 에 retire 된 항목. retire/collect 는 드물어서 뮤텍스로 충분
+static pthread_mutex_t g_limbo_lock = PTHREAD_MUTEX_INITIALIZER;
+static ebr_node       *g_limbo[3];
+static atomic_long     g_pending = 0;
+
+static pthread_once_t  g_once = PTHREAD_ONCE_INIT;
+static pthread_key_t   g_key;
+static slab_cache      g_node_cache;   // ebr_node 할당 (retire 마다 malloc 하지 않음)
+static __thread ebr_record *t_record = NULL;
+
+// 스레드 종료 시 기록 반납
+static void release_record(void *arg)
+{
+    ebr_record *rec = (ebr_record *)arg;
+    atomic_store_explicit(&rec->epoch, 0, memory_order_release);
+    atomic_store_explicit(&rec->in_use, FALSE, memory_order_release);
+}
+
+static void make_key(void)
+{
+    pthread_key_create(&g_key, release_record);
+    if (slab_init(&g_node_cache, sizeof(ebr_node)) != SUCCESS)
+        abort();
+}
+
+static ebr_record *get_record(void)
+{
+    ebr_record *rec = t_record;
+    if (rec)
+        return rec;
+
+    pthread_once(&g_once, make_key);
+
+    // 종료한 스레드가 남긴 기록 재사용
+    for (rec = atomic_load_explicit(&g_records, memory_order_acquire); rec; rec = rec->next)
+    {
+        int expected = FALSE;
+        if (!atomic_load_explicit(&rec->in_use, memory_order_relaxed)
+            && atomic_compare_exchange_strong_explicit(&rec->in_use, &expected, TRUE,
+                                                       memory_order_acquire, memory_order_relaxed))
+            break;
+    }
+
+    if (!rec)
+    {
+        if (posix_memalign((void **)&rec, 64, sizeof(ebr_record)) != 0)
+            abort();
+        atomic_init(&rec->epoch, 0);
+        atomic_init(&rec->in_use, TRUE);
+        // 초기화한 기록을 release CAS 로 목록에 공개
+        rec->next = atomic_load_explicit(&g_records, memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit(&g_records, &rec->next, rec,
+                                                      memory_order_release, memory_order_relaxed));
+    }
+
+    rec->depth = 0;
+    pthread_setspecific(g_key, rec);
+    t_record = rec;
+    return rec;
+}
+
+void ebr_enter(void)
+{
+    ebr_record *rec = get_record();
+    if (rec->depth++ > 0)
+        return;
+
+    // 공표한 epoch 가 이후 공유 포인터 읽기보다 먼저 보여야 함 (store → load 순서 → seq_cst)
+    atomic_store_explicit(&rec->epoch,
+                          (atomic_load_explicit(&g_epoch, memory_order_relaxed) << 1) | 1,
+                          memory_order_seq_cst);
+}
+
+void ebr_exit(void)
+{
+    ebr_record *rec = t_record;
+    if (--rec->depth > 0)
+        return;
+
+    // 읽기 구간의 load 들이 끝난 뒤 퇴장 공표
+    atomic_store_explicit(&rec->epoch, 0, memory_order_release);
+}
+
+// limbo 락 하에서: 모든 읽기 중인 스레드가 현재 epoch 에 있으면 한 칸 진행
+static int try_advance(void)
+{
+    unsigned long epoch = atomic_load_explicit(&g_epoch, memory_order_relaxed);
+    ebr_record *rec;
+
+    for (rec = atomic_load_explicit(&g_records, memory_order_acquire); rec; rec = rec->next)
+    {
+        // 읽기 쪽 seq_cst 공표와 짝: 포인터를 끊은 뒤의 검사이므로 seq_cst
+        unsigned long e = atomic_load_explicit(&rec->epoch, memory_order_seq_cst);
+        if ((e & 1) && (e >> 1) != epoch)
+            return FALSE;
+    }
+    // 진행은 limbo 락 하에서만 → 단순 store
+    atomic_store_explicit(&g_epoch, epoch + 1, memory_order_release);
+    return TRUE;
+}
+
+static int free_list(ebr_node *node)
+{
+    int n = 0;
+    while (node)
+    {
+        ebr_node *next = node->next;
+        node->free_fn(node->ptr);
+        slab_free(&g_node_cache, node);
+        node = next;
+        n++;
+    }
+    return n;
+}
+
+int ebr_collect(void)
+{
+    ebr_node *safe = NULL;
+    int n = 0;
+
+    pthread_mutex_lock(&g_limbo_lock);
+    if (try_advance())
+    {
+        // 새 epoch E 기준 E-2 에 retire 된 항목(= limbo[(E+1) % 3])은 아무도 볼 수 없음
+        unsigned long idx = (atomic_load_explicit(&g_epoch, memory_order_relaxed) + 1) % 3;
+        safe = g_limbo[idx];
+        g_limbo[idx] = NULL;
+    }
+    pthread_mutex_unlock(&g_limbo_lock);
+
+    n = free_list(safe);
+    if (n)
+        atomic_fetch_sub_explicit(&g_pending, n, memory_order_relaxed);
+    return n;
+}
+
+void ebr_retire(void *ptr, ebr_free_fn free_fn)
+{
+    ebr_node *node = NULL;
+    unsigned long idx;
+
+    pthread_once(&g_once, make_key);
+    node = slab_alloc(&g_node_cache);
+    if (!node)
+    {
+        // 보류할 메모리조차 없으면 안전해질 때까지 기다렸다가 바로 해제
+        ebr_synchronize();
+        free_fn(ptr);
+        return;
+    }
+    node->ptr = ptr;
+    node->free_fn = free_fn;
+
+    pthread_mutex_lock(&g_limbo_lock);
+    idx = atomic_load_explicit(&g_epoch, memory_order_relaxed) % 3;
+    node->next = g_limbo[idx];
+    g_limbo[idx] = node;
+    pthread_mutex_unlock(&g_limbo_lock);
+    atomic_fetch_add_explicit(&g_pending, 1, memory_order_relaxed);
+
+    ebr_collect();
+}
+
+void ebr_synchronize(void)
+{
+    while (ebr_pending() > 0)
+    {
+        if (ebr_collect() == 0)
+            sched_yield();
+    }
+}
+
+long ebr_pending(void)
+{
+    return atomic_load_explicit(&g_pending, memory_order_relaxed);
+}
@@ -0,0 +1,17 @@
+#ifndef EBR_H
+#define EBR_H
+
+// epoch 기반 메모리 회수 (프로세스 전역 도메인 1개)
+// 읽기: ebr_enter ~ ebr_exit 사이에서만 공유 포인터를 따라감
+// 쓰기: 포인터를 끊은 뒤 ebr_retire → 모든 읽기가 그 epoch 를 지나면 free_fn 호출
+
+typedef void (*ebr_free_fn)(void *ptr);
+
+void ebr_enter(void);                               // 중첩 가능
+void ebr_exit(void);
+void ebr_retire(void *ptr, ebr_free_fn free_fn);
+int  ebr_collect(void);         // epoch 진행을 시도하고 안전해진 항목 해제. 해제 수 반환
+void ebr_synchronize(void);     // 지금까지 retire 된 항목이 모두 해제될 때까지 진행 (읽기 구간 밖에서만)
+long ebr_pending(void);         // 해제 대기 중인 항목 수
+
+#endif // EBR_H
@@ -0,0 +1,120 @@
+#include "lat_hist.h"
+#include "thread_safe_queue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// 칸의 아래쪽 끝과 폭 (lat_index 의 역)
+static uint64_t bucket_low(unsigned idx, uint64_t *width)
+{
+    unsigned shift;
+
+    if (idx < LAT_SUB)
+    {
+        *width = 1;
+        return idx;
+    }
+    shift = (idx >> LAT_SUB_BITS) - 1;
+    *width = 1ull << shift;
+    return (uint64_t)(LAT_SUB + (idx & (LAT_SUB - 1))) << shift;
+}
+
+int lat_set_init(lat_set *s, int nstages, const char *const *names)
+{
+    if (nstages <= 0 || nstages > LAT_MAX_STAGES)
+        return FAIL;
+    memset(s, 0, sizeof(*s));
+    s->nstages = nstages;
+    for (int i = 0; i < nstages; i++)
+        s->names[i] = names[i];
+    pthread_mutex_init(&s->lock, NULL);
+    return SUCCESS;
+}
+
+void lat_set_destroy(lat_set *s)
+{
+    lat_thread *t = s->threads;
+
+    while (t != NULL)
+    {
+        lat_thread *next = t->next;
+        free(t);
+        t = next;
+    }
+    s->threads = NULL;
+    pthread_mutex_destroy(&s->lock);
+}
+
+lat_thread *lat_register(lat_set *s)
+{
+    lat_thread *t = calloc(1, sizeof(lat_thread));
+
+    if (t == NULL)
+        return NULL;
+    pthread_mutex_lock(&s->lock);
+    t->next = s->threads;
+    s->threads = t;
+    pthread_mutex_unlock(&s->lock);
+    return t;
+}
+
+void lat_merge(lat_set *s, int stage, lat_hist *out)
+{
+    memset(out, 0, sizeof(*out));
+    pthread_mutex_lock(&s->lock);
+    for (lat_thread *t = s->threads; t != NULL; t = t->next)
+    {
+        const lat_hist *h = &t->hist[stage];
+        // 기록 중인 칸은 바로 앞 값이나 뒤 값 중 하나로 보임 (찢어지지 않음)
+        for (int i = 0; i < LAT_BUCKETS; i++)
+            LAT_BUMP(out->count[i], atomic_load_explicit(&h->count[i], memory_order_relaxed));
+        LAT_BUMP(out->total, atomic_load_explicit(&h->total, memory_order_relaxed));
+        LAT_BUMP(out->sum, atomic_load_explicit(&h->sum, memory_order_relaxed));
+        uint64_t max = atomic_load_explicit(&h->max, memory_order_relaxed);
+        if (max > atomic_load_explicit(&out->max, memory_order_relaxed))
+            atomic_store_explicit(&out->max, max, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+uint64_t lat_percentile(const lat_hist *h, double q)
+{
+    uint64_t total = 0, seen = 0, want, width;
+    uint64_t max = atomic_load_explicit(&h->max, memory_order_relaxed);
+
+    // total 필드 대신 칸을 직접 더함 (집계 중 기록이 끼어도 칸 합과 맞도록)
+    for (int i = 0; i < LAT_BUCKETS; i++)
+        total += atomic_load_explicit(&h->count[i], memory_order_relaxed);
+    if (total == 0)
+        return 0;
+    want = (uint64_t)(q * (double)total + 0.999999);
+    if (want == 0)
+        want = 1;
+    for (int i = 0; i < LAT_BUCKETS; i++)
+    {
+        seen += atomic_load_explicit(&h->count[i], memory_order_relaxed);
+        if (seen >= want)
+        {
+            uint64_t high = bucket_low((unsigned)i, &width) + width - 1;
+            return high < max ? high : max;
+        }
+    }
+    return max;
+}
+
+void lat_summarize(lat_set *s, int stage, lat_summary *out)
+{
+    lat_hist *h = malloc(sizeof(lat_hist));
+
+    memset(out, 0, sizeof(*out));
+    if (h == NULL)
+        return;
+    lat_merge(s, stage, h);
+    out->count = atomic_load_explicit(&h->total, memory_order_relaxed);
+    out->mean = out->count ? atomic_load_explicit(&h->sum, memory_order_relaxed) / out->count : 0;
+    out->p50 = lat_percentile(h, 0.50);
+    out->p99 = lat_percentile(h, 0.99);
+    out->p999 = lat_percentile(h, 0.999);
+    out->max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    free(h);
+}
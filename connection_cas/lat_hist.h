@@ -0,0 +1,100 @@
+#ifndef LAT_HIST_H
+#define LAT_HIST_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+
+// 단계별 지연 히스토그램 (HDR 식 log-linear)
+//   2 의 거듭제곱 구간마다 LAT_SUB 칸 → 상대 오차 1/LAT_SUB 이하 (32 칸: 3.1%), 1ns ~ 2^40ns
+//   스레드마다 자기 lat_thread 에만 기록 (쓰는 스레드 하나 → fetch_add 없이 relaxed load+store)
+//   집계는 lat_summarize 가 등록된 스레드를 모두 더해서 (기록하는 쪽을 멈추지 않음)
+
+#define LAT_SUB_BITS    5
+#define LAT_SUB         (1 << LAT_SUB_BITS)
+#define LAT_MAX_BITS    40
+#define LAT_BUCKETS     ((LAT_MAX_BITS - LAT_SUB_BITS + 1) << LAT_SUB_BITS)
+#define LAT_MAX_STAGES  8
+
+typedef struct
+{
+    _Atomic uint64_t count[LAT_BUCKETS];
+    _Atomic uint64_t total;
+    _Atomic uint64_t sum;       // ns (평균용)
+    _Atomic uint64_t max;
+} lat_hist;
+
+typedef struct lat_thread
+{
+    lat_hist           hist[LAT_MAX_STAGES];
+    struct lat_thread *next;
+} lat_thread;
+
+typedef struct
+{
+    int              nstages;
+    const char      *names[LAT_MAX_STAGES];
+    pthread_mutex_t  lock;      // threads 목록 (등록/집계 때만)
+    lat_thread      *threads;
+} lat_set;
+
+typedef struct
+{
+    uint64_t count;
+    uint64_t mean;              // ns
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+} lat_summary;
+
+int         lat_set_init(lat_set *s, int nstages, const char *const *names);
+void        lat_set_destroy(lat_set *s);
+lat_thread *lat_register(lat_set *s);      // 스레드가 한 번 받아 두고 계속 씀
+void        lat_merge(lat_set *s, int stage, lat_hist *out);
+uint64_t    lat_percentile(const lat_hist *h, double q);    // q = 0.5, 0.99 ... 칸의 위쪽 끝 (max 로 자름)
+void        lat_summarize(lat_set *s, int stage, lat_summary *out);
+
+static inline uint64_t lat_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);     // vDSO (syscall 없음)
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline unsigned lat_index(uint64_t ns)
+{
+    unsigned msb;
+
+    if (ns < LAT_SUB)
+        return (unsigned)ns;
+    if (ns >> LAT_MAX_BITS)
+        ns = (1ull << LAT_MAX_BITS) - 1;
+    msb = 63 - (unsigned)__builtin_clzll(ns);
+    return ((msb - LAT_SUB_BITS + 1) << LAT_SUB_BITS) + (unsigned)((ns >> (msb - LAT_SUB_BITS)) & (LAT_SUB - 1));
+}
+
+#define LAT_BUMP(a, v) \
+    atomic_store_explicit(&(a), atomic_load_explicit(&(a), memory_order_relaxed) + (v), memory_order_relaxed)
+
+static inline void lat_record(lat_thread *t, int stage, uint64_t ns)
+{
+    lat_hist *h = &t->hist[stage];
+
+    LAT_BUMP(h->count[lat_index(ns)], 1);
+    LAT_BUMP(h->total, 1);
+    LAT_BUMP(h->sum, ns);
+    if (ns > atomic_load_explicit(&h->max, memory_order_relaxed))
+        atomic_store_explicit(&h->max, ns, memory_order_relaxed);
+}
+
+// start 부터 지금까지. 지금 시각을 돌려줘 다음 단계의 시작으로 씀
+static inline uint64_t lat_since(lat_thread *t, int stage, uint64_t start)
+{
+    uint64_t now = lat_now();
+    lat_record(t, stage, now - start);
+    return now;
+}
+
+#endif // LAT_HIST_H
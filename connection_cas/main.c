@@ -1,5 +1,18 @@
 #include "thread_safe_queue.h"
 #include "conn_pool.h"
+#include "typed_query.h"
+#include "pool_registry.h"
+#include "ebr.h"
+#include "slab.h"
+#include "cas_lock.h"
+#include "mpmc_queue.h"
+#include "rx_ring.h"
+#include "copy_text.h"
+#include "uring.h"
+#include "async_log.h"
+#include "spill.h"
+#include "lat_hist.h"
+#include "timer_wheel.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -7,6 +20,15 @@
 #include <unistd.h>
 #include <string.h>
 #include <time.h>
+#include <stddef.h>
+#include <endian.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <poll.h>
 
 // ─── 시간 측정 헬퍼 ──────────────────────────────────────────
 
@@ -57,12 +79,14 @@ void test_single_thread()
 
     // key=2 soft delete 후 GC
     hash_delete_soft(&map, 2UL);
-    hash_delete(&map);  // sleep(1) + clean_trash 포함
+    hash_delete(&map);
 
     // GC 후 key=1은 살아있고, key=2는 사라짐
     assert(hash_get(&map, 1UL) == 1);
     assert(hash_get(&map, 2UL) == FAIL);
 
+    hash_destroy(&map);
+
     printf("[PASS] test_single_thread\n");
 }
 
@@ -135,52 +159,1394 @@ void test_multi_thread()
 
     // 모든 스레드 종료 후 GC
     hash_delete(&map);
+    hash_destroy(&map);
+
+    if (total_errors == 0)
+        printf("[PASS] test_multi_thread (%d threads x %d iter)\n",
+               MT_THREADS, MT_ITER);
+    else
+        printf("[FAIL] test_multi_thread: %d errors\n", total_errors);
+}
+
+// ─── 해시 충돌 테스트 ─────────────────────────────────────────
+// 초기 테이블에서 홈 슬롯이 같은 키 3개를 골라 선형 탐사 경로를 검증
+
+static unsigned long colliding_key(unsigned long base, unsigned long after)
+{
+    unsigned long mask = HASH_INIT_SIZE - 1;
+    unsigned long k = after + 1;
+    while ((hash(k) & mask) != (hash(base) & mask))
+        k++;
+    return k;
+}
+
+void test_hash_collision()
+{
+    hash_map map;
+    hash_init(&map);
+
+    unsigned long k1 = 0UL;
+    unsigned long k2 = colliding_key(k1, k1);
+    unsigned long k3 = colliding_key(k1, k2);
+
+    hash_insert(&map, k1, 10);
+    hash_insert(&map, k2, 20);
+    hash_insert(&map, k3, 30);
+
+    assert(hash_get(&map, k1) == 10);
+    assert(hash_get(&map, k2) == 20);
+    assert(hash_get(&map, k3) == 30);
+
+    hash_delete_soft(&map, k2);
+    assert(hash_get(&map, k1) == 10);
+    assert(hash_get(&map, k2) == FAIL);
+    assert(hash_get(&map, k3) == 30);
+
+    // GC 후 k2 자리는 TOMB → k3 까지 탐사가 이어져야 함
+    hash_delete(&map);
+
+    assert(hash_get(&map, k1) == 10);
+    assert(hash_get(&map, k2) == FAIL);
+    assert(hash_get(&map, k3) == 30);
+
+    // TOMB 뒤에 같은 키 재insert
+    hash_insert(&map, k2, 21);
+    assert(hash_get(&map, k2) == 21);
+    assert(hash_count(&map, TRUE) == 3);
+
+    hash_destroy(&map);
+    printf("[PASS] test_hash_collision\n");
+}
+
+// ─── 증분 리사이즈 테스트 ─────────────────────────────────────
+
+#define RESIZE_KEYS  20000
+
+// pthread_t 처럼 큰 간격으로 정렬된 키
+static unsigned long tid_like_key(int i)
+{
+    return 0x7f0000000000UL + (unsigned long)i * 0x801000UL;
+}
+
+void test_hash_resize()
+{
+    hash_map map;
+    int i;
+    hash_init(&map);
+
+    for (i = 0; i < RESIZE_KEYS; i++)
+    {
+        assert(hash_insert(&map, tid_like_key(i), i) == SUCCESS);
+        // 이동 도중에도 앞서 넣은 키가 보여야 함
+        assert(hash_get(&map, tid_like_key(i / 2)) == i / 2);
+    }
+    for (i = 0; i < RESIZE_KEYS; i++)
+        assert(hash_get(&map, tid_like_key(i)) == i);
+    assert(hash_count(&map, FALSE) == RESIZE_KEYS);
+
+    // 절반 삭제 → GC → 나머지는 그대로
+    for (i = 0; i < RESIZE_KEYS; i += 2)
+        hash_delete_soft(&map, tid_like_key(i));
+    assert(hash_deleted(&map) == RESIZE_KEYS / 2);
+    hash_delete(&map);
+    assert(hash_deleted(&map) == 0);
+    for (i = 0; i < RESIZE_KEYS; i++)
+        assert(hash_get(&map, tid_like_key(i)) == (i % 2 ? i : FAIL));
+    assert(hash_count(&map, TRUE) == RESIZE_KEYS / 2);
+
+    // 전부 지우면 TOMB 재구축으로 테이블이 초기 크기까지 줄어듦
+    for (i = 1; i < RESIZE_KEYS; i += 2)
+        hash_delete_soft(&map, tid_like_key(i));
+    hash_delete(&map);
+    assert(hash_count(&map, TRUE) == 0);
+    assert(map.table->mask + 1 == HASH_INIT_SIZE);
+
+    hash_destroy(&map);
+    printf("[PASS] test_hash_resize\n");
+}
+
+// ─── epoch 기반 회수 테스트 ───────────────────────────────────
+
+static atomic_int ebr_freed = 0;
+
+static void count_free(void *ptr)
+{
+    free(ptr);
+    atomic_fetch_add_explicit(&ebr_freed, 1, memory_order_relaxed);
+}
+
+static atomic_int reader_in = 0;
+static atomic_int reader_go = 0;
+
+void *pinned_reader(void *arg)
+{
+    (void)arg;
+    ebr_enter();
+    reader_in = 1;
+    while (!reader_go)
+        usleep(1000);
+    ebr_exit();
+    return NULL;
+}
+
+void test_ebr()
+{
+    pthread_t reader;
+    int i;
+
+    ebr_synchronize();
+    ebr_freed = 0;
+
+    // 읽기 구간 밖에서 retire → 몇 번의 collect 로 해제
+    ebr_retire(malloc(16), count_free);
+    for (i = 0; i < 4 && ebr_freed == 0; i++)
+        ebr_collect();
+    assert(ebr_freed == 1);
+
+    // 읽기 중인 스레드가 있으면 아무리 collect 해도 해제되지 않음
+    reader_in = reader_go = 0;
+    pthread_create(&reader, NULL, pinned_reader, NULL);
+    while (!reader_in)
+        usleep(1000);
+    ebr_retire(malloc(16), count_free);
+    for (i = 0; i < 10; i++)
+        ebr_collect();
+    assert(ebr_freed == 1);
+    assert(ebr_pending() == 1);
+
+    // 읽기가 빠지면 해제
+    reader_go = 1;
+    pthread_join(reader, NULL);
+    ebr_synchronize();
+    assert(ebr_freed == 2);
+
+    printf("[PASS] test_ebr\n");
+}
+
+// ─── 리사이즈 중 동시 읽기 테스트 (옛 테이블 해제 안전성) ───────
+
+#define RR_READERS  4
+#define RR_KEYS     50000
+
+typedef struct {
+    hash_map     *map;
+    atomic_int   *stop;
+    int           errors;
+    long          reads;
+} rr_arg_t;
+
+void *resize_reader(void *arg)
+{
+    rr_arg_t *a = (rr_arg_t *)arg;
+    unsigned long i = 0;
+    while (!*a->stop)
+    {
+        // 키 0..63 은 처음부터 값 = 키 로 고정
+        unsigned long k = i++ % 64;
+        if (hash_get(a->map, k) != (int)k)
+            a->errors++;
+        a->reads++;
+    }
+    return NULL;
+}
+
+void test_hash_resize_concurrent()
+{
+    hash_map map;
+    pthread_t threads[RR_READERS];
+    rr_arg_t args[RR_READERS];
+    atomic_int stop = 0;
+    int i;
+
+    hash_init(&map);
+    for (i = 0; i < 64; i++)
+        hash_insert(&map, (unsigned long)i, i);
+
+    for (i = 0; i < RR_READERS; i++)
+    {
+        args[i].map = &map;
+        args[i].stop = &stop;
+        args[i].errors = 0;
+        args[i].reads = 0;
+        pthread_create(&threads[i], NULL, resize_reader, &args[i]);
+    }
+
+    // 읽기가 도는 동안 성장 → 삭제 → TOMB 재구축을 반복해 옛 테이블을 계속 retire
+    for (i = 64; i < RR_KEYS; i++)
+    {
+        hash_insert(&map, (unsigned long)i, i);
+        if (i % 5000 == 0)
+        {
+            int j;
+            for (j = 64; j < i; j++)
+                hash_delete_soft(&map, (unsigned long)j);
+            hash_delete(&map);
+        }
+    }
+    stop = 1;
+
+    int errors = 0;
+    for (i = 0; i < RR_READERS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        errors += args[i].errors;
+    }
+    assert(errors == 0);
+
+    hash_destroy(&map);
+    ebr_synchronize();
+    assert(ebr_pending() == 0);
+    printf("[PASS] test_hash_resize_concurrent (%d readers)\n", RR_READERS);
+}
+
+// ─── 값 갱신 중 동시 읽기 테스트 (seqlock 스냅샷) ──────────────
+
+#define SU_KEYS   64
+#define SU_ROUNDS 20000
+
+void *update_reader(void *arg)
+{
+    rr_arg_t *a = (rr_arg_t *)arg;
+    unsigned long i = 0;
+    while (!*a->stop)
+    {
+        // 값은 항상 gen * SU_KEYS + key → 다른 키의 값이나 찢어진 값을 보면 오류
+        unsigned long k = i++ % SU_KEYS;
+        int v = hash_get(a->map, k);
+        if (v != FAIL && (unsigned long)(v % SU_KEYS) != k)
+            a->errors++;
+        a->reads++;
+    }
+    return NULL;
+}
+
+void test_hash_update_concurrent()
+{
+    hash_map map;
+    pthread_t threads[RR_READERS];
+    rr_arg_t args[RR_READERS];
+    atomic_int stop = 0;
+    int i, gen;
+
+    hash_init(&map);
+    for (i = 0; i < SU_KEYS; i++)
+        hash_insert(&map, (unsigned long)i, i);
+
+    for (i = 0; i < RR_READERS; i++)
+    {
+        args[i].map = &map;
+        args[i].stop = &stop;
+        args[i].errors = 0;
+        args[i].reads = 0;
+        pthread_create(&threads[i], NULL, update_reader, &args[i]);
+    }
+
+    // 값 갱신, soft delete → 부활을 섞어 같은 슬롯을 계속 다시 씀
+    for (gen = 1; gen < SU_ROUNDS; gen++)
+    {
+        unsigned long k = (unsigned long)(gen % SU_KEYS);
+        if (gen % 7 == 0)
+            hash_delete_soft(&map, k);
+        hash_insert(&map, k, gen * SU_KEYS + (int)k);
+    }
+    stop = 1;
+
+    int errors = 0;
+    for (i = 0; i < RR_READERS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        errors += args[i].errors;
+    }
+    assert(errors == 0);
+    for (i = 0; i < SU_KEYS; i++)
+        assert(hash_get(&map, (unsigned long)i) % SU_KEYS == i);
+
+    hash_destroy(&map);
+    printf("[PASS] test_hash_update_concurrent (%d readers)\n", RR_READERS);
+}
+
+// ─── 락 라이브러리 테스트 ────────────────────────────────────
+
+#define LOCK_THREADS  8
+#define LOCK_ITER     5000
+
+typedef struct {
+    cas_lock *lock;
+    long     *counter;     // 락 안에서만 증가 (원자 연산 아님)
+    hash_map *map;
+    int       id;
+} lock_arg_t;
+
+void *lock_worker(void *arg)
+{
+    lock_arg_t *a = (lock_arg_t *)arg;
+    int i;
+    for (i = 0; i < LOCK_ITER; i++)
+    {
+        cas_lock_acquire(a->lock);
+        (*a->counter)++;
+        cas_lock_release(a->lock);
+    }
+    // 같은 종류의 락을 쓰는 hash_map 에 동시 insert
+    for (i = 0; i < 200; i++)
+        hash_insert(a->map, (unsigned long)(a->id * 1000 + i), i);
+    return NULL;
+}
+
+void test_cas_lock()
+{
+    int kind, i;
+
+    for (kind = 0; kind < LOCK_KIND_COUNT; kind++)
+    {
+        cas_lock lock, other;
+        hash_map map;
+        long counter = 0;
+        pthread_t threads[LOCK_THREADS];
+        lock_arg_t args[LOCK_THREADS];
+
+        cas_lock_init(&lock, kind);
+        cas_lock_init(&other, kind);
+        hash_init_lock(&map, kind);
+
+        // try: 풀려 있으면 잡고, 잡혀 있으면 실패. 서로 다른 락은 겹쳐 잡을 수 있음
+        assert(cas_lock_try(&lock) == TRUE);
+        assert(cas_lock_try(&lock) == FALSE);
+        cas_lock_acquire(&other);
+        cas_lock_release(&other);
+        cas_lock_release(&lock);
+
+        for (i = 0; i < LOCK_THREADS; i++)
+        {
+            args[i].lock = &lock;
+            args[i].counter = &counter;
+            args[i].map = &map;
+            args[i].id = i;
+            pthread_create(&threads[i], NULL, lock_worker, &args[i]);
+        }
+        for (i = 0; i < LOCK_THREADS; i++)
+            pthread_join(threads[i], NULL);
+
+        assert(counter == (long)LOCK_THREADS * LOCK_ITER);
+        assert(hash_count(&map, FALSE) == LOCK_THREADS * 200);
+        assert(hash_get(&map, 7 * 1000 + 199) == 199);
+        hash_destroy(&map);
+    }
+    printf("[PASS] test_cas_lock (ttas/ticket/mcs/adaptive)\n");
+}
+
+// ─── slab 할당기 테스트 ──────────────────────────────────────
+
+#define SLAB_OBJS     1000
+#define SLAB_THREADS  8
+#define SLAB_ROUNDS   200
+
+typedef struct {
+    slab_cache *cache;
+    void      **handoff;     // 이전 스레드가 할당한 객체 → 이 스레드가 해제
+    void      **mine;
+    int         errors;
+} slab_arg_t;
+
+void *slab_worker(void *arg)
+{
+    slab_arg_t *a = (slab_arg_t *)arg;
+    int i, r;
+
+    for (i = 0; i < SLAB_OBJS; i++)
+        slab_free(a->cache, a->handoff[i]);
+
+    for (r = 0; r < SLAB_ROUNDS; r++)
+    {
+        // 객체마다 고유 표식을 써 두고, 해제 전에 다른 스레드가 덮어쓰지 않았는지 확인
+        for (i = 0; i < SLAB_OBJS; i++)
+        {
+            a->mine[i] = slab_alloc(a->cache);
+            *(void **)a->mine[i] = &a->mine[i];
+        }
+        for (i = 0; i < SLAB_OBJS; i++)
+        {
+            if (*(void **)a->mine[i] != &a->mine[i])
+                a->errors++;
+            if (r < SLAB_ROUNDS - 1)
+                slab_free(a->cache, a->mine[i]);
+        }
+    }
+    return NULL;
+}
+
+void test_slab()
+{
+    slab_cache cache;
+    pthread_t threads[SLAB_THREADS];
+    slab_arg_t args[SLAB_THREADS];
+    void *objs[SLAB_THREADS][SLAB_OBJS];
+    void *live[SLAB_THREADS][SLAB_OBJS];
+    int i, j;
+
+    assert(slab_init(&cache, 24) == SUCCESS);
+    assert(cache.obj_size == 32);
+
+    // 단일 스레드: 방금 해제한 객체를 바로 다시 줌 (LIFO)
+    void *a = slab_alloc(&cache);
+    assert(a != NULL && ((unsigned long)a & 15) == 0);
+    slab_free(&cache, a);
+    assert(slab_alloc(&cache) == a);
+    slab_free(&cache, a);
+
+    // 메인 스레드가 할당 → 각 워커가 해제(스레드 간 반납) 후 자기 몫을 반복 할당/해제
+    for (i = 0; i < SLAB_THREADS; i++)
+        for (j = 0; j < SLAB_OBJS; j++)
+            objs[i][j] = slab_alloc(&cache);
+    long chunks = cache.nchunk;
+
+    for (i = 0; i < SLAB_THREADS; i++)
+    {
+        args[i].cache = &cache;
+        args[i].handoff = objs[i];
+        args[i].mine = live[i];
+        args[i].errors = 0;
+        pthread_create(&threads[i], NULL, slab_worker, &args[i]);
+    }
+    int errors = 0;
+    for (i = 0; i < SLAB_THREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        errors += args[i].errors;
+    }
+    assert(errors == 0);
+
+    // 종료한 워커의 magazine 은 depot 으로 돌아와 재사용 → chunk 가 거의 늘지 않음
+    assert(cache.nchunk <= chunks + SLAB_THREADS * 2);
+    assert(cache.tls != NULL && cache.tls->next == NULL);   // 메인 스레드 것만 남음
+
+    // 마지막 라운드 객체는 아직 살아 있음: 서로 겹치지 않아야 함
+    for (i = 0; i < SLAB_THREADS; i++)
+        for (j = 0; j < SLAB_OBJS; j++)
+            assert(*(void **)live[i][j] == &live[i][j]);
+
+    slab_destroy(&cache);
+    printf("[PASS] test_slab (%d threads, %ld chunks)\n", SLAB_THREADS, chunks);
+}
+
+// ─── MPMC 큐 테스트 ─────────────────────────────────────────
+
+#define MQ_PRODUCERS  4
+#define MQ_CONSUMERS  4
+#define MQ_ITEMS      20000     // 생산자당
+#define MQ_CAPACITY   64        // 작게 잡아 가득 참/빔을 자주 겪게
+
+typedef struct {
+    mpmc_queue   *q;
+    int           id;
+    long          count;
+    int           errors;
+    long          last[MQ_PRODUCERS];  // 생산자별 마지막으로 본 순번
+    atomic_uchar *seen;                // 공유 (항목마다 한 칸, 한 번만 나와야 함)
+} mq_arg_t;
+
+// 항목 = 생산자 * MQ_ITEMS + 순번 + 1 (NULL 을 피하려 +1)
+void *mq_producer(void *arg)
+{
+    mq_arg_t *a = (mq_arg_t *)arg;
+    long i;
+    for (i = 0; i < MQ_ITEMS; i++)
+    {
+        void *item = (void *)(long)(a->id * MQ_ITEMS + i + 1);
+        while (mpmc_push(a->q, item) == FAIL)
+            sched_yield();
+    }
+    return NULL;
+}
+
+void *mq_consumer(void *arg)
+{
+    mq_arg_t *a = (mq_arg_t *)arg;
+    void *item = NULL;
+    int i;
+
+    for (i = 0; i < MQ_PRODUCERS; i++)
+        a->last[i] = -1;
+    while ((item = mpmc_pop_wait(a->q)) != NULL)
+    {
+        long v = (long)item - 1;
+        int producer = (int)(v / MQ_ITEMS);
+        long n = v % MQ_ITEMS;
+        // 한 소비자가 본 같은 생산자의 항목은 넣은 순서대로여야 함
+        if (n <= a->last[producer])
+            a->errors++;
+        a->last[producer] = n;
+        if (atomic_fetch_add_explicit(&a->seen[v], 1, memory_order_relaxed) != 0)
+            a->errors++;
+        a->count++;
+    }
+    return NULL;
+}
+
+void test_mpmc_queue()
+{
+    mpmc_queue q;
+    pthread_t prod[MQ_PRODUCERS], cons[MQ_CONSUMERS];
+    mq_arg_t pargs[MQ_PRODUCERS], cargs[MQ_CONSUMERS];
+    atomic_uchar *seen = calloc(MQ_PRODUCERS * MQ_ITEMS, sizeof(atomic_uchar));
+    void *out = NULL;
+    long total = 0;
+    int errors = 0;
+    long i;
+
+    // 단일 스레드: 2의 거듭제곱으로 올림, FIFO, 가득 참/빔
+    assert(mpmc_init(&q, 5) == SUCCESS);
+    assert(q.mask == 7);
+    assert(mpmc_try_pop(&q, &out) == FAIL);
+    assert(mpmc_size(&q) == 0);
+    for (i = 1; i <= 8; i++)
+        assert(mpmc_push(&q, (void *)i) == SUCCESS);
+    assert(mpmc_push(&q, (void *)9L) == FAIL);
+    assert(mpmc_size(&q) == 8);
+    for (i = 1; i <= 8; i++)
+    {
+        assert(mpmc_try_pop(&q, &out) == SUCCESS);
+        assert(out == (void *)i);
+    }
+    assert(mpmc_try_pop(&q, &out) == FAIL);
+    assert(mpmc_size(&q) == 0);
+
+    // 시간 제한 pop: 비어 있으면 제한만큼 잠든 뒤 NULL, 있으면 바로
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    assert(mpmc_pop_timed(&q, 2000) == NULL);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    assert((t1.tv_sec - t0.tv_sec) * 1000000L + (t1.tv_nsec - t0.tv_nsec) / 1000 >= 2000);
+    assert(mpmc_push(&q, (void *)1L) == SUCCESS);
+    assert(mpmc_pop_timed(&q, 2000) == (void *)1L);
+    mpmc_destroy(&q);
+
+    // 생산자/소비자 동시: 빠짐·중복 없이, 생산자별 순서 유지. 소비자는 빈 큐에서 eventfd 로 잠듦
+    assert(mpmc_init(&q, MQ_CAPACITY) == SUCCESS);
+    for (i = 0; i < MQ_CONSUMERS; i++)
+    {
+        memset(&cargs[i], 0, sizeof(cargs[i]));
+        cargs[i].q = &q;
+        cargs[i].seen = seen;
+        pthread_create(&cons[i], NULL, mq_consumer, &cargs[i]);
+    }
+    for (i = 0; i < MQ_PRODUCERS; i++)
+    {
+        memset(&pargs[i], 0, sizeof(pargs[i]));
+        pargs[i].q = &q;
+        pargs[i].id = (int)i;
+        pthread_create(&prod[i], NULL, mq_producer, &pargs[i]);
+    }
+    for (i = 0; i < MQ_PRODUCERS; i++)
+        pthread_join(prod[i], NULL);
+    mpmc_close(&q);
+    for (i = 0; i < MQ_CONSUMERS; i++)
+    {
+        pthread_join(cons[i], NULL);
+        total += cargs[i].count;
+        errors += cargs[i].errors;
+    }
+    assert(errors == 0);
+    assert(total == (long)MQ_PRODUCERS * MQ_ITEMS);
+    for (i = 0; i < MQ_PRODUCERS * MQ_ITEMS; i++)
+        assert(seen[i] == 1);
+    assert(mpmc_pop_wait(&q) == NULL);    // 닫히고 비었으면 바로 NULL
+
+    mpmc_destroy(&q);
+    free(seen);
+    printf("[PASS] test_mpmc_queue (%d producers, %d consumers)\n", MQ_PRODUCERS, MQ_CONSUMERS);
+}
+
+// ─── 수신 링 / 프레이밍 테스트 ──────────────────────────────
+
+// 길이 접두 프레임 하나를 out 에 씀 (반환 = 전체 길이)
+static size_t rx_put_frame(char *out, const char *body, size_t len)
+{
+    out[0] = (char)(len >> 24);
+    out[1] = (char)(len >> 16);
+    out[2] = (char)(len >> 8);
+    out[3] = (char)len;
+    memcpy(out + RX_FRAME_HDR, body, len);
+    return RX_FRAME_HDR + len;
+}
+
+void test_rx_ring()
+{
+    rx_pool pool;
+    rx_ring ring;
+    rx_frame f;
+    int sv[2];
+    char wire[RX_RING_MIN * 4];
+    char body[RX_RING_MIN];
+    char out[RX_RING_MIN];
+    size_t n = 0;
+    int i;
+
+    assert(rx_pool_init(&pool) == SUCCESS);
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    fcntl(sv[0], F_SETFL, O_NONBLOCK);
+    rx_ring_init(&ring);
+    for (i = 0; i < (int)sizeof(body); i++)
+        body[i] = (char)('a' + i % 26);
+
+    // 빈 소켓: EAGAIN, 버퍼는 빌렸다가 trim 으로 반납
+    assert(rx_ring_recv(&pool, &ring, sv[0]) < 0 && errno == EAGAIN);
+    rx_ring_trim(&pool, &ring);
+    assert(ring.buf == NULL);
+
+    // 한 번에 도착한 여러 프레임 (붙은 메시지) + 헤더 중간에서 끊긴 프레임 (나뉜 메시지)
+    n += rx_put_frame(wire + n, "hello", 5);
+    n += rx_put_frame(wire + n, "", 0);
+    n += rx_put_frame(wire + n, "world!", 6);
+    rx_put_frame(wire + n, "split", 5);
+    assert(write(sv[1], wire, n + 2) == (ssize_t)(n + 2));
+    assert(rx_ring_recv(&pool, &ring, sv[0]) == (ssize_t)(n + 2));
+    assert(rx_ring_next(&ring, 64, &f) == 1 && f.len == 5);
+    assert(memcmp(f.seg[0].iov_base, "hello", 5) == 0);
+    assert(f.seg[0].iov_base >= (void *)ring.buf);    // 링 안을 그대로 가리킴 (복사 없음)
+    assert(rx_ring_next(&ring, 64, &f) == 1 && f.len == 0);
+    assert(rx_ring_next(&ring, 64, &f) == 1 && f.len == 6);
+    assert(rx_frame_copy(&f, out) == 6 && memcmp(out, "world!", 6) == 0);
+    assert(rx_ring_next(&ring, 64, &f) == 0);
+    rx_ring_trim(&pool, &ring);
+    assert(ring.buf != NULL);    // 미완성 프레임이 남아 있으면 버퍼 유지
+
+    // 나머지 헤더 + 본문을 한 바이트씩: 마지막 바이트에서야 완성
+    for (i = 2; i < RX_FRAME_HDR + 5; i++)
+    {
+        assert(rx_ring_next(&ring, 64, &f) == 0);
+        assert(write(sv[1], wire + n + i, 1) == 1);
+        assert(rx_ring_recv(&pool, &ring, sv[0]) == 1);
+    }
+    assert(rx_ring_next(&ring, 64, &f) == 1 && f.len == 5);
+    assert(rx_frame_copy(&f, out) == 5 && memcmp(out, "split", 5) == 0);
+    rx_ring_trim(&pool, &ring);
+    assert(ring.buf == NULL);
+
+    // 끝에서 감기는 프레임: 앞 프레임으로 위치를 끝 근처로 옮긴 뒤 다음 프레임은 readv 두 조각으로
+    n = rx_put_frame(wire, body, RX_RING_MIN - 100);
+    assert(write(sv[1], wire, n) == (ssize_t)n);
+    assert(rx_ring_recv(&pool, &ring, sv[0]) == (ssize_t)n);
+    assert(rx_ring_next(&ring, RX_RING_MIN, &f) == 1 && f.len == RX_RING_MIN - 100);
+    assert(f.seg[1].iov_len == 0 && memcmp(f.seg[0].iov_base, body, f.len) == 0);
+    n = rx_put_frame(wire, body, 500);
+    assert(write(sv[1], wire, n) == (ssize_t)n);
+    assert(rx_ring_recv(&pool, &ring, sv[0]) == (ssize_t)n);
+    assert(rx_ring_next(&ring, RX_RING_MIN, &f) == 1 && f.len == 500);
+    assert(f.seg[0].iov_len > 0 && f.seg[1].iov_len > 0);
+    assert(rx_frame_copy(&f, out) == 500 && memcmp(out, body, 500) == 0);
+    rx_ring_trim(&pool, &ring);
+    assert(ring.buf == NULL);
+
+    // 빈 공간을 다 채운 읽기 → 다음 읽기 전에 키워서 한 syscall 에 더 많이 받음
+    for (n = 0; n + RX_FRAME_HDR + 1000 <= sizeof(wire); )
+        n += rx_put_frame(wire + n, body, 1000);
+    assert(write(sv[1], wire, n) == (ssize_t)n);
+    assert(rx_ring_recv(&pool, &ring, sv[0]) == RX_RING_MIN);
+    assert(ring.grow);
+    size_t total = RX_RING_MIN;
+    int frames = 0, reads = 1;
+    for (;;)
+    {
+        while (rx_ring_next(&ring, RX_RING_MIN, &f) == 1)
+        {
+            assert(rx_frame_copy(&f, out) == 1000 && memcmp(out, body, 1000) == 0);
+            frames++;
+        }
+        if (total == n)
+            break;
+        ssize_t got = rx_ring_recv(&pool, &ring, sv[0]);
+        assert(got > 0);
+        total += got;
+        reads++;
+    }
+    assert(ring.cap >= RX_RING_MIN * 2);
+    assert(frames == (int)(n / (RX_FRAME_HDR + 1000)));
+    assert(reads < (int)((n + RX_RING_MIN - 1) / RX_RING_MIN));    // 4K 고정이면 올림(n / 4K) 번
+    rx_ring_trim(&pool, &ring);
+    assert(ring.buf == NULL && ring.cls == 0);     // 비워 반납하면 가장 작은 크기로 돌아감
+
+    // 제한을 넘는 길이 → 프로토콜 오류
+    rx_put_frame(wire, body, 100);
+    assert(write(sv[1], wire, RX_FRAME_HDR) == RX_FRAME_HDR);
+    assert(rx_ring_recv(&pool, &ring, sv[0]) == RX_FRAME_HDR);
+    assert(ring.cap == RX_RING_MIN);
+    assert(rx_ring_next(&ring, 99, &f) == -1);
+    rx_ring_release(&pool, &ring);
+
+    // 이미 받은 바이트를 붙이기 (io_uring 경로): 나뉜 프레임 이어 붙이기 + 필요하면 키움
+    rx_ring_init(&ring);
+    n = rx_put_frame(wire, body, 3000);
+    n += rx_put_frame(wire + n, body, 3000);
+    assert(rx_ring_append(&pool, &ring, wire, 10) == SUCCESS);
+    assert(rx_ring_next(&ring, RX_RING_MIN, &f) == 0);
+    assert(rx_ring_append(&pool, &ring, wire + 10, n - 10) == SUCCESS);
+    assert(ring.cap == RX_RING_MIN * 2);
+    for (i = 0; i < 2; i++)
+    {
+        assert(rx_ring_next(&ring, RX_RING_MIN, &f) == 1 && f.len == 3000);
+        assert(rx_frame_copy(&f, out) == 3000 && memcmp(out, body, 3000) == 0);
+    }
+    assert(rx_ring_next(&ring, RX_RING_MIN, &f) == 0);
+    rx_ring_release(&pool, &ring);
+
+    // 상대가 닫으면 0
+    close(sv[1]);
+    assert(rx_ring_recv(&pool, &ring, sv[0]) == 0);
+    rx_ring_release(&pool, &ring);
+    close(sv[0]);
+    rx_pool_destroy(&pool);
+    printf("[PASS] test_rx_ring\n");
+}
+
+// ─── COPY text escape 테스트 ────────────────────────────────
+
+#define CE_MAX_LEN  200     // 블록 경계(16/32) 앞뒤를 모두 지나도록
+
+// 벡터 구현이 모든 길이·특수 문자 위치에서 scalar 와 같은 결과를 내는지 비교
+void test_copy_escape()
+{
+    static const char special[] = { '\\', '\n', '\r', '\t' };
+    char src[CE_MAX_LEN + 1];
+    char want[CE_MAX_LEN * 2 + 64], got[CE_MAX_LEN * 2 + 64];
+    copy_escape_fn impls[3];
+    const char *names[3];
+    int nimpl = 0;
+    size_t len, want_len;
+    int i, round, k;
+
+    impls[nimpl] = copy_escape; names[nimpl++] = copy_escape_impl();
+#if defined(__x86_64__)
+    impls[nimpl] = copy_escape_sse2; names[nimpl++] = "sse2";
+    if (__builtin_cpu_supports("avx2"))
+    {
+        impls[nimpl] = copy_escape_avx2; names[nimpl++] = "avx2";
+    }
+#endif
+
+    // 고정 예
+    assert(copy_escape_scalar(got, "a\\b\tc\nd\re", 9) == 13);
+    assert(memcmp(got, "a\\\\b\\tc\\nd\\re", 13) == 0);
+    assert(copy_escape_scalar(got, "ab\0cd", 5) == 2);
+
+    srand(44);
+    for (round = 0; round < 50; round++)
+    {
+        for (len = 0; len <= CE_MAX_LEN; len++)
+        {
+            for (i = 0; i < (int)len; i++)
+            {
+                int r = rand() % 100;
+                // 라운드마다 특수 문자 밀도를 바꿈 (0% ~ 50%)
+                if (r < round)
+                    src[i] = special[rand() % 4];
+                else
+                    src[i] = (char)(' ' + rand() % 95);
+            }
+            // 가끔 NUL 을 넣어 거기서 멈추는지
+            if (len > 0 && round % 5 == 4)
+                src[rand() % len] = '\0';
+            src[len] = 'X';     // len 너머는 읽지 않아야 함
+
+            want_len = copy_escape_scalar(want, src, len);
+            for (k = 0; k < nimpl; k++)
+            {
+                memset(got, '#', sizeof(got));
+                size_t n = impls[k](got, src, len);
+                if (n != want_len || memcmp(got, want, n) != 0)
+                {
+                    fprintf(stderr, "copy_escape %s mismatch: len=%zu round=%d\n", names[k], len, round);
+                    assert(0);
+                }
+                // 저장은 2 * len 안쪽에서 끝남
+                for (i = (int)(len * 2); i < (int)sizeof(got); i++)
+                    assert(got[i] == '#');
+            }
+        }
+    }
+    printf("[PASS] test_copy_escape (dispatch: %s)\n", copy_escape_impl());
+}
+
+// ─── io_uring 래퍼 테스트 ───────────────────────────────────
+
+#define UT_ACCEPT   1
+#define UT_RECV     2
+#define UT_CLOSE    3
+
+// CQE 하나를 기다려 꺼냄
+static struct io_uring_cqe ut_wait(uring *u)
+{
+    struct io_uring_cqe *cqe = NULL, out;
+    while ((cqe = uring_peek(u)) == NULL)
+        assert(uring_submit_wait(u, 1, 1000) >= 0);
+    out = *cqe;
+    uring_advance(u, 1);
+    return out;
+}
+
+// loopback 에서 multishot accept(direct) → multishot recv(provided buffer) → close 한 바퀴
+void test_uring()
+{
+    uring u;
+    uring_bufs bufs;
+    struct io_uring_cqe cqe;
+    struct sockaddr_in addr;
+    socklen_t alen = sizeof(addr);
+    int rc = uring_init(&u, 64, 0);
+
+    if (rc < 0)
+    {
+        printf("[SKIP] test_uring: io_uring_setup %s\n", strerror(-rc));
+        return;
+    }
+    if (uring_register_files_sparse(&u, 16) < 0 || uring_bufs_init(&u, &bufs, 7, 4, 64) < 0)
+    {
+        printf("[SKIP] test_uring: 커널이 sparse file / buffer ring 을 지원하지 않음\n");
+        uring_exit(&u);
+        return;
+    }
+
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    assert(bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    assert(listen(lfd, 16) == 0);
+    assert(getsockname(lfd, (struct sockaddr *)&addr, &alen) == 0);
+
+    uring_prep_accept_multishot_direct(uring_get_sqe(&u), lfd, UT_ACCEPT);
+    assert(uring_submit_wait(&u, 0, -1) == 1);
+    assert(uring_peek(&u) == NULL);
+
+    int cfd = socket(AF_INET, SOCK_STREAM, 0);
+    assert(connect(cfd, (struct sockaddr *)&addr, sizeof(addr)) == 0);
+    cqe = ut_wait(&u);
+    assert(cqe.user_data == UT_ACCEPT && cqe.res >= 0 && cqe.res < 16);
+    assert(cqe.flags & IORING_CQE_F_MORE);     // accept 는 계속 살아 있음
+    int slot = cqe.res;
+
+    uring_prep_recv_multishot_fixed(uring_get_sqe(&u), slot, 7, UT_RECV);
+    assert(uring_submit_wait(&u, 0, -1) == 1);
+
+    // 보낼 때마다 CQE 하나 + 커널이 고른 버퍼
+    const char *msgs[3] = { "hello", "io_uring", "multishot" };
+    for (int i = 0; i < 3; i++)
+    {
+        assert(write(cfd, msgs[i], strlen(msgs[i])) == (ssize_t)strlen(msgs[i]));
+        cqe = ut_wait(&u);
+        assert(cqe.user_data == UT_RECV && cqe.res == (int)strlen(msgs[i]));
+        assert((cqe.flags & IORING_CQE_F_BUFFER) && (cqe.flags & IORING_CQE_F_MORE));
+        unsigned bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+        assert(bid < 4);
+        assert(memcmp(uring_buf_addr(&bufs, bid), msgs[i], cqe.res) == 0);
+        uring_buf_recycle(&bufs, bid);
+    }
+
+    // 상대가 닫으면 res 0, 더 이상 CQE 없음 (F_MORE 없음)
+    close(cfd);
+    cqe = ut_wait(&u);
+    assert(cqe.user_data == UT_RECV && cqe.res == 0 && !(cqe.flags & IORING_CQE_F_MORE));
+    uring_prep_close_fixed(uring_get_sqe(&u), slot, UT_CLOSE);
+    cqe = ut_wait(&u);
+    assert(cqe.user_data == UT_CLOSE && cqe.res == 0);
+    unsigned long enters = u.nenter;
+
+    close(lfd);
+    uring_bufs_destroy(&u, &bufs);
+    uring_exit(&u);
+    printf("[PASS] test_uring (%lu io_uring_enter)\n", enters);
+}
+
+// ─── async_log 테스트 ────────────────────────────────────────
+
+#define AL_THREADS  4
+#define AL_PER      5000
+
+static void *al_worker(void *arg)
+{
+    int id = (int)(long)arg;
+    for (int i = 0; i < AL_PER; i++)
+        alog_info("worker %d seq %d", id, i);
+    return NULL;
+}
+
+void test_async_log()
+{
+    char path[] = "/tmp/alog_testXXXXXX";
+    char buf[64], line[512];
+    pthread_t threads[AL_THREADS];
+    int fd = mkstemp(path);
+    int i;
+
+    assert(fd >= 0);
+    assert(alog_init(fd, fd) == SUCCESS);
+    alog_set_level(ALOG_INFO);
+
+    // 포맷: 플래그/폭/정밀도/*, 길이 수식어, 타입 불일치/인자 부족은 <?>
+    alog_info("int=%d neg=%i u=%u hex=%#x str=%s pct=%%", 42, -7, 3000000000u, 255, "abc");
+    alog_warn("pad=[%-5s|%05d|%*d] dbl=%.3f ptr=%p", "ab", 42, 4, 7, 2.5, (void *)0x1234);
+    alog_error("ll=%lld zu=%zu ch=%c bad=%s miss=%d", -1234567890123LL, (size_t)123456789012ULL, 'Z', 5);
+    alog_debug("hidden %d", 1);     // 수준 미달 → 인자도 평가 안 함
+
+    // 문자열 인자는 기록 시점에 복사됨
+    strcpy(buf, "before");
+    alog_info("copied=%s", buf);
+    strcpy(buf, "after!");
+
+    for (i = 0; i < 100; i++)
+        alog_limited(ALOG_INFO, 5, "limited %d", i);
+
+    for (i = 0; i < AL_THREADS; i++)
+        pthread_create(&threads[i], NULL, al_worker, (void *)(long)i);
+    for (i = 0; i < AL_THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    alog_shutdown();
+    alog_info("sync after shutdown %d", 9);     // 동기 경로
+    long dropped = alog_dropped();
+
+    FILE *fp = fopen(path, "r");
+    int seen[AL_THREADS] = { 0 };
+    int found = 0, limited = 0, sync_line = 0;
+    assert(fp != NULL);
+    while (fgets(line, sizeof(line), fp))
+    {
+        int id, seq;
+        char *msg = strchr(line, ' ');      // "HH:MM:SS.uuuuuu LEVEL 메시지"
+        assert(msg != NULL && strlen(line) > 22 && line[2] == ':' && line[8] == '.');
+        msg = strchr(msg + 1, ' ');
+        while (*msg == ' ')
+            msg++;
+        if (sscanf(msg, "worker %d seq %d", &id, &seq) == 2)
+        {
+            assert(id >= 0 && id < AL_THREADS && seq > -1 && seq < AL_PER);
+            seen[id]++;
+        }
+        else if (strcmp(msg, "int=42 neg=-7 u=3000000000 hex=0xff str=abc pct=%\n") == 0)
+            found |= 1;
+        else if (strcmp(msg, "pad=[ab   |00042|   7] dbl=2.500 ptr=0x1234\n") == 0)
+            found |= 2 * (strstr(line, "WARN ") != NULL);
+        else if (strcmp(msg, "ll=-1234567890123 zu=123456789012 ch=Z bad=<?> miss=<?>\n") == 0)
+            found |= 4 * (strstr(line, "ERROR ") != NULL);
+        else if (strcmp(msg, "copied=before\n") == 0)
+            found |= 8;
+        else if (strncmp(msg, "limited ", 8) == 0)
+            limited++;
+        else if (strcmp(msg, "sync after shutdown 9\n") == 0)
+            sync_line++;
+        else if (strstr(msg, "hidden") != NULL)
+            assert(0);
+    }
+    fclose(fp);
+    unlink(path);
+
+    // 링이 가득 차서 버린 것만 빼고 모두 도착 (초 경계를 넘으면 limited 는 최대 10)
+    long total = 0;
+    for (i = 0; i < AL_THREADS; i++)
+        total += seen[i];
+    assert(found == 15);
+    assert(limited >= 5 && limited <= 10);
+    assert(sync_line == 1);
+    assert(total + dropped == AL_THREADS * AL_PER);
+
+    // 기록 중에 shutdown: 꺼지기 직전 링에 쓰던 기록도 잃지 않음 (링 / 동기 경로 / 버림 중 하나)
+    char path2[] = "/tmp/alog_testXXXXXX";
+    int fd2 = mkstemp(path2);
+    long race_lines = 0;
+    assert(fd2 >= 0);
+    assert(alog_init(fd2, fd2) == SUCCESS);
+    for (i = 0; i < AL_THREADS; i++)
+        pthread_create(&threads[i], NULL, al_worker, (void *)(long)i);
+    usleep(1000);
+    alog_shutdown();
+    for (i = 0; i < AL_THREADS; i++)
+        pthread_join(threads[i], NULL);
+    long race_dropped = alog_dropped() - dropped;
+    fp = fopen(path2, "r");
+    assert(fp != NULL);
+    while (fgets(line, sizeof(line), fp))
+        race_lines += strstr(line, " worker ") != NULL;
+    fclose(fp);
+    close(fd2);
+    unlink(path2);
+    assert(race_lines + race_dropped == AL_THREADS * AL_PER);
+
+    printf("[PASS] test_async_log (%ld lines, %ld dropped)\n", total, dropped);
+}
+
+// ─── spill 저널 테스트 ───────────────────────────────────────
+
+#define SP_THREADS  4
+#define SP_PER      500
+
+typedef struct
+{
+    spill_journal *j;
+    int            id;
+} sp_arg;
+
+static void *sp_writer(void *arg)
+{
+    sp_arg *a = (sp_arg *)arg;
+    char rec[64];
+
+    for (int i = 0; i < SP_PER; i++)
+    {
+        // 길이를 섞어서 8 바이트 정렬과 세그먼트 경계를 고루 밟음
+        int len = snprintf(rec, sizeof(rec), "%d:%d:", a->id, i);
+        memset(rec + len, 'a' + i % 26, i % 23);
+        assert(spill_append(a->j, rec, len + i % 23) == SUCCESS);
+    }
+    return NULL;
+}
+
+// 기록 n 개를 읽으며 스레드별 순서와 내용을 확인
+static void sp_read_check(spill_journal *j, int *next, int n)
+{
+    char buf[128];
+
+    for (int k = 0; k < n; k++)
+    {
+        int id, seq, hlen;
+        ssize_t len = spill_read(j, buf, sizeof(buf));
+        assert(len > 0);
+        buf[len] = '\0';
+        assert(sscanf(buf, "%d:%d:%n", &id, &seq, &hlen) == 2);
+        assert(id >= 0 && id < SP_THREADS && seq == next[id]);
+        assert(len == hlen + seq % 23);
+        for (int c = hlen; c < len; c++)
+            assert(buf[c] == 'a' + seq % 26);
+        next[id]++;
+    }
+}
+
+static int sp_seg_count(const char *dir, char *newest, size_t cap)
+{
+    DIR *d = opendir(dir);
+    struct dirent *e = NULL;
+    int n = 0;
+
+    while ((e = readdir(d)) != NULL)
+    {
+        if (strstr(e->d_name, ".spill") == NULL)
+            continue;
+        if (newest && (n == 0 || strcmp(e->d_name, newest) > 0))
+            snprintf(newest, cap, "%s", e->d_name);
+        n++;
+    }
+    closedir(d);
+    return n;
+}
+
+void test_spill()
+{
+    char dir[] = "/tmp/spill_testXXXXXX";
+    char buf[4096], path[300], name[256];
+    spill_journal j;
+    pthread_t threads[SP_THREADS];
+    sp_arg args[SP_THREADS];
+    int next[SP_THREADS] = { 0 }, saved[SP_THREADS];
+    int total = SP_THREADS * SP_PER;
+    int i, fd;
+
+    assert(mkdtemp(dir) != NULL);
+    assert(spill_open(&j, dir, 4096) == SUCCESS);
+    assert(!spill_pending(&j) && spill_read(&j, buf, sizeof(buf)) == 0);
+    memset(buf, 0, sizeof(buf));
+    assert(spill_append(&j, buf, sizeof(buf)) == FAIL);    // 머리까지 세그먼트를 넘음
+    assert(spill_append(&j, buf, 0) == FAIL);
+
+    for (i = 0; i < SP_THREADS; i++)
+    {
+        args[i].j = &j;
+        args[i].id = i;
+        pthread_create(&threads[i], NULL, sp_writer, &args[i]);
+    }
+    for (i = 0; i < SP_THREADS; i++)
+        pthread_join(threads[i], NULL);
+    assert(atomic_load(&j.appended) == total);
+    int segs = sp_seg_count(dir, NULL, 0);
+    assert(segs > 5);
+
+    // 절반 읽고 commit → 다 읽은 세그먼트는 지워짐
+    assert(spill_pending(&j));
+    sp_read_check(&j, next, total / 2);
+    assert(spill_commit(&j) == SUCCESS);
+    assert(sp_seg_count(dir, NULL, 0) < segs);
+    assert(atomic_load(&j.replayed) == total / 2);
+
+    // commit 없이 읽은 것은 rewind 로 다시 읽음 (DB 쓰기 실패)
+    memcpy(saved, next, sizeof(next));
+    sp_read_check(&j, next, 100);
+    spill_rewind(&j);
+    memcpy(next, saved, sizeof(next));
+    sp_read_check(&j, next, 100);
+    spill_close(&j);
+
+    // 다시 열면 마지막 checkpoint 부터 (commit 안 한 100 개도 다시 나옴)
+    memcpy(next, saved, sizeof(next));
+    assert(spill_open(&j, dir, 4096) == SUCCESS);
+    sp_read_check(&j, next, total - total / 2);
+    assert(spill_read(&j, buf, sizeof(buf)) == 0 && !spill_pending(&j));
+    for (i = 0; i < SP_THREADS; i++)
+        assert(next[i] == SP_PER);
+    assert(spill_commit(&j) == SUCCESS);
+
+    // 죽기 전 반쯤 쓰인 기록: 다시 열면 그 세그먼트는 거기서 끝, 새 기록은 새 세그먼트로
+    assert(spill_append(&j, "x1", 2) == SUCCESS);
+    assert(spill_append(&j, "x2", 2) == SUCCESS);
+    assert(spill_append(&j, "x3", 2) == SUCCESS);
+    assert(spill_sync(&j) == SUCCESS);
+    spill_close(&j);
+    sp_seg_count(dir, name, sizeof(name));
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    fd = open(path, O_WRONLY);
+    assert(fd >= 0 && pwrite(fd, "?", 1, 16 + SPILL_REC_HDR) == 1);   // x2 본문
+    close(fd);
+
+    assert(spill_open(&j, dir, 4096) == SUCCESS);
+    assert(spill_read(&j, buf, sizeof(buf)) == 2 && memcmp(buf, "x1", 2) == 0);
+    assert(spill_read(&j, buf, sizeof(buf)) == 0);
+    assert(spill_append(&j, "y", 1) == SUCCESS);
+    assert(spill_read(&j, buf, sizeof(buf)) == 1 && buf[0] == 'y');
+    assert(spill_append(&j, "zz", 2) == SUCCESS);
+    assert(spill_read(&j, buf, 1) == -1);       // 버퍼 부족 → 건너뜀
+    assert(spill_read(&j, buf, sizeof(buf)) == 0);
+    assert(spill_commit(&j) == SUCCESS);
+    assert(sp_seg_count(dir, NULL, 0) == 1);    // 쓰는 중인 세그먼트만 남음
+    spill_close(&j);
+
+    DIR *d = opendir(dir);
+    struct dirent *e = NULL;
+    while ((e = readdir(d)) != NULL)
+    {
+        if (e->d_name[0] == '.')
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, e->d_name);
+        unlink(path);
+    }
+    closedir(d);
+    rmdir(dir);
+    printf("[PASS] test_spill (%d threads x %d records, %d segments)\n", SP_THREADS, SP_PER, segs);
+}
+
+// ─── lat_hist 테스트 ─────────────────────────────────────────
+
+#define LH_THREADS  4
+#define LH_N        100000
+
+typedef struct
+{
+    lat_set *set;
+    int      id;
+} lh_arg;
 
-    if (total_errors == 0)
-        printf("[PASS] test_multi_thread (%d threads x %d iter)\n",
-               MT_THREADS, MT_ITER);
-    else
-        printf("[FAIL] test_multi_thread: %d errors\n", total_errors);
+static void *lh_worker(void *arg)
+{
+    lh_arg *a = (lh_arg *)arg;
+    lat_thread *t = lat_register(a->set);
+
+    // stage 0: 1..LH_N us 고르게, stage 1: 스레드 번호만큼 (스레드별 값이 합쳐지는지)
+    for (int i = 1; i <= LH_N; i++)
+        lat_record(t, 0, (uint64_t)i * 1000);
+    lat_record(t, 1, (uint64_t)(a->id + 1) * 1000000);
+    return NULL;
 }
 
-// ─── 해시 충돌 테스트 ─────────────────────────────────────────
-// MAX_HASH_SIZE=256 이므로 key=0, 256, 512 는 같은 버킷에 들어감
+static int lh_close(uint64_t got, double want)
+{
+    return got >= want && got <= want * (1.0 + 1.0 / LAT_SUB) + 1;
+}
 
-void test_hash_collision()
+void test_lat_hist()
 {
-    hash_map map;
-    hash_init(&map);
+    const char *names[2] = { "even", "thread" };
+    lat_set set;
+    lat_summary sum;
+    pthread_t threads[LH_THREADS];
+    lh_arg args[LH_THREADS];
+    unsigned prev = 0;
+    uint64_t v;
+    int i;
 
-    unsigned long k1 = 0UL;
-    unsigned long k2 = (unsigned long)MAX_HASH_SIZE;
-    unsigned long k3 = (unsigned long)MAX_HASH_SIZE * 2;
+    // 칸 번호는 값을 따라 빈틈없이 증가, 범위 밖은 마지막 칸
+    for (v = 0; v < (1u << 20); v++)
+    {
+        unsigned idx = lat_index(v);
+        assert(idx == prev || idx == prev + 1);
+        prev = idx;
+    }
+    assert(lat_index(~0ull) == LAT_BUCKETS - 1);
 
-    hash_insert(&map, k1, 10);
-    hash_insert(&map, k2, 20);
-    hash_insert(&map, k3, 30);
+    assert(lat_set_init(&set, 2, names) == SUCCESS);
+    lat_summarize(&set, 0, &sum);
+    assert(sum.count == 0 && sum.p99 == 0);
 
-    assert(hash_get(&map, k1) == 10);
-    assert(hash_get(&map, k2) == 20);
-    assert(hash_get(&map, k3) == 30);
+    for (i = 0; i < LH_THREADS; i++)
+    {
+        args[i].set = &set;
+        args[i].id = i;
+        pthread_create(&threads[i], NULL, lh_worker, &args[i]);
+    }
+    for (i = 0; i < LH_THREADS; i++)
+        pthread_join(threads[i], NULL);
 
-    hash_delete_soft(&map, k2);
-    assert(hash_get(&map, k1) == 10);
-    assert(hash_get(&map, k2) == FAIL);
-    assert(hash_get(&map, k3) == 30);
+    // 백분위는 칸의 위쪽 끝 → 참값 이상, 상대 오차 1/LAT_SUB 이내
+    lat_summarize(&set, 0, &sum);
+    assert(sum.count == (uint64_t)LH_THREADS * LH_N);
+    assert(sum.mean == (uint64_t)(LH_N + 1) * 1000 / 2);
+    assert(lh_close(sum.p50, LH_N * 0.50 * 1000));
+    assert(lh_close(sum.p99, LH_N * 0.99 * 1000));
+    assert(lh_close(sum.p999, LH_N * 0.999 * 1000));
+    assert(sum.max == (uint64_t)LH_N * 1000);
+
+    lat_summarize(&set, 1, &sum);
+    assert(sum.count == LH_THREADS && sum.max == LH_THREADS * 1000000ull);
+    assert(lh_close(sum.p50, 2 * 1000000.0));
+
+    // 기록 비용 (clock 읽기 포함)
+    lat_thread *t = lat_register(&set);
+    struct timespec s0, s1;
+    clock_gettime(CLOCK_MONOTONIC, &s0);
+    uint64_t start = lat_now();
+    for (i = 0; i < 1000000; i++)
+        start = lat_since(t, 1, start);
+    clock_gettime(CLOCK_MONOTONIC, &s1);
+    double ns = elapsed_ms(&s0, &s1) * 1e6 / 1000000;
+
+    lat_set_destroy(&set);
+    printf("[PASS] test_lat_hist (%d buckets, %.1f ns/record)\n", LAT_BUCKETS, ns);
+}
 
-    hash_delete(&map);
+// ─── timer_wheel 테스트 ──────────────────────────────────────
 
-    assert(hash_get(&map, k1) == 10);
-    assert(hash_get(&map, k2) == FAIL);
-    assert(hash_get(&map, k3) == 30);
+#define TWT_N   2000
 
-    printf("[PASS] test_hash_collision\n");
+typedef struct
+{
+    tw_timer t;         // 첫 필드 (콜백에서 바로 캐스팅)
+    uint64_t want;      // 만료돼야 하는 tick
+    uint64_t got;
+    int      fired;
+    int      rearm;     // 남은 재등록 횟수 (주기 타이머)
+} twt_item;
+
+static void twt_cb(tw_timer *t, void *ctx)
+{
+    twt_item *it = (twt_item *)t;
+    timer_wheel *w = (timer_wheel *)ctx;
+
+    it->got = w->now;
+    it->fired++;
+    if (it->rearm > 0)
+    {
+        it->rearm--;
+        tw_arm(w, t, 10);
+        it->want = t->expire;
+    }
 }
 
-// ─── conn_pool 헬퍼 ──────────────────────────────────────────
+void test_timer_wheel()
+{
+    static twt_item items[TWT_N];
+    static timer_wheel w;
+    unsigned seed = 12345, max_ms = 0;
+    struct timespec s0, s1;
+    int i, fired_total = 0;
+
+    assert(tw_init(&w, 1, &w) == SUCCESS);
+    for (i = 0; i < TWT_N; i++)
+    {
+        // 모든 단을 밟도록: 0 단(<64), 1 단(<4096), 2 단(<262144), 3 단
+        static const unsigned span[4] = { 64, 4096, 262144, 1000000 };
+        seed = seed * 1103515245u + 12345u;
+        unsigned ms = (seed >> 8) % span[i % 4];
+        tw_timer_init(&items[i].t, twt_cb);
+        tw_arm(&w, &items[i].t, ms);
+        items[i].want = items[i].t.expire;
+        items[i].fired = 0;
+        items[i].rearm = 0;
+        if (ms > max_ms)
+            max_ms = ms;
+    }
+    assert(w.count == TWT_N);
+    items[1].rearm = 3;
+
+    // 5 번째마다 cancel, 7 번째마다 다른 시간으로 다시 arm (O(1) 이동)
+    for (i = 0; i < TWT_N; i += 5)
+        tw_cancel(&w, &items[i].t);
+    tw_cancel(&w, &items[0].t);     // 두 번 cancel 해도 됨
+    for (i = 3; i < TWT_N; i += 7)
+    {
+        tw_arm(&w, &items[i].t, (unsigned)(i * 37) % 70000);
+        items[i].want = items[i].t.expire;
+    }
 
-static hash_map g_map;
-static wait_que g_que;
+    // 만료 tick 을 넘겨 크게 건너뛰어도 각 타이머는 자기 tick 에 정확히 한 번
+    for (uint64_t ms = 0; ms <= max_ms + 200; ms += 37)
+        fired_total += tw_advance(&w, w.origin_ms + ms);
+    assert(w.count == 0);
+    for (i = 0; i < TWT_N; i++)
+    {
+        if (i % 5 == 0 && !(i % 7 == 3))
+            assert(items[i].fired == 0);
+        else
+        {
+            assert(items[i].fired == (i == 1 ? 4 : 1));
+            assert(items[i].got == items[i].want);
+        }
+    }
+
+    // 휠이 담을 수 있는 범위를 넘으면 최대로 자름
+    tw_arm(&w, &items[0].t, 0xFFFFFFFFu);
+    assert(items[0].t.expire - w.now == (1ull << (TW_BITS * TW_LEVELS)) - 1);
+    tw_cancel(&w, &items[0].t);
+    assert(w.count == 0);
+    tw_destroy(&w);
+
+    // timerfd: 걸린 동안만 tick, 다 만료되면 멈춤
+    struct pollfd pfd;
+    assert(tw_init(&w, 5, &w) == SUCCESS);
+    tw_timer_init(&items[0].t, twt_cb);
+    items[0].fired = 0;
+    items[0].rearm = 0;
+    clock_gettime(CLOCK_MONOTONIC, &s0);
+    tw_arm(&w, &items[0].t, 20);
+    pfd.fd = tw_fd(&w);
+    pfd.events = POLLIN;
+    while (items[0].fired == 0)
+    {
+        assert(poll(&pfd, 1, 1000) == 1);
+        tw_expire(&w);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &s1);
+    double waited = elapsed_ms(&s0, &s1);
+    assert(waited >= 20 && !w.ticking);
+    assert(poll(&pfd, 1, 30) == 0);
+    tw_destroy(&w);
+
+    // 도는 중 tw_expire 가 늦어 w->now 가 뒤처져 있어도 실제 시각 기준으로 걸림
+    assert(tw_init(&w, 10, &w) == SUCCESS);
+    tw_timer_init(&items[0].t, twt_cb);
+    tw_timer_init(&items[1].t, twt_cb);
+    items[0].fired = items[1].fired = 0;
+    items[0].rearm = items[1].rearm = 0;
+    tw_arm(&w, &items[1].t, 10000);
+    usleep(80 * 1000);
+    clock_gettime(CLOCK_MONOTONIC, &s0);
+    uint64_t armed_ms = (uint64_t)s0.tv_sec * 1000 + (uint64_t)s0.tv_nsec / 1000000;
+    tw_arm(&w, &items[0].t, 20);
+    assert(items[0].t.expire - w.now > 20 / 10 + 1);
+    tw_advance(&w, armed_ms + 10);
+    assert(items[0].fired == 0);
+    tw_advance(&w, armed_ms + 40);
+    assert(items[0].fired == 1 && items[1].fired == 0);
+    tw_destroy(&w);
+
+    printf("[PASS] test_timer_wheel (%d fired, timerfd %.1f ms for 20 ms)\n", fired_total, waited);
+}
+
+// ─── conn_pool 헬퍼 ──────────────────────────────────────────
 
 static conn_pool* make_mock_pool(PGconn_mock *mocks, int n)
 {
@@ -188,18 +1554,13 @@ static conn_pool* make_mock_pool(PGconn_mock *mocks, int n)
     int i;
     for(i = 0; i < n; i++)
         pool->conn_list[i] = (PGconn *)&mocks[i];
-    pool->map = &g_map;
-    pool->que = &g_que;
-    hash_init(pool->map);
-    queue_init(pool->que);
-    pthread_key_create(&pool->tls_key, NULL);
+    conn_pool_init(pool);   // 풀마다 독립된 hash_map / wait_que
     return pool;
 }
 
 static void free_mock_pool(conn_pool *pool)
 {
-    pthread_key_delete(pool->tls_key);
-    free(pool);
+    conn_pool_destroy(pool);
 }
 
 // ─── conn_pool 단일 스레드 테스트 ────────────────────────────
@@ -238,6 +1599,291 @@ void test_conn_single()
     printf("[PASS] test_conn_single\n");
 }
 
+// ─── conn_pool 점유 타임아웃 / 워치독 테스트 ─────────────────
+
+void test_conn_timeout()
+{
+    PGconn_mock mocks[CONN_SIZE];
+    conn_pool *pool = make_mock_pool(mocks, CONN_SIZE);
+    int i;
+
+    // deadline 전에는 워치독이 건드리지 않음
+    PGconn *c = get_conn_timeout(pool, 1000);
+    assert(conn_pool_check(pool) == 0);
+    assert(pool->broken_count == 0);
+    release_conn(pool, c);
+
+    // 반납하면 deadline 이 남지 않음
+    for (i = 0; i < CONN_SIZE; i++)
+        assert(atomic_load(&pool->deadline[i]) == 0);
+
+    // 만료 → mock 은 취소 핸들이 없으므로 BROKEN
+    c = get_conn_timeout(pool, 10);
+    usleep(20 * 1000);
+    conn_pool_check(pool);
+    assert(pool->broken_count == 1);
+
+    // BROKEN 반납 → 슬롯은 풀에 돌아오지 않음 (CONN_SIZE-1 개만 획득 가능)
+    release_conn(pool, c);
+    PGconn *conns[CONN_SIZE];
+    for (i = 0; i < CONN_SIZE - 1; i++)
+    {
+        conns[i] = get_conn(pool);
+        assert(conns[i] != c);
+    }
+    for (i = 0; i < CONN_SIZE - 1; i++)
+        release_conn(pool, conns[i]);
+
+    // 하우스키퍼가 복구 → 다시 CONN_SIZE 개 전부 획득 가능
+    assert(conn_pool_check(pool) == 1);
+    for (i = 0; i < CONN_SIZE; i++)
+        conns[i] = get_conn(pool);
+    for (i = 0; i < CONN_SIZE; i++)
+        release_conn(pool, conns[i]);
+
+    // 취소 핸들이 있으면 첫 만료는 PQcancel + 같은 길이 유예, 그래도 안 돌려주면 BROKEN
+    static char fake_cancel;
+    c = get_conn_timeout(pool, 10);
+    int idx = (int)((PGconn_mock *)c - mocks);
+    pool->cancel[idx] = (PGcancel *)&fake_cancel;     // mock 풀은 libpq 를 부르지 않음
+    usleep(20 * 1000);
+    conn_pool_check(pool);
+    assert(pool->cancel_count == 1 && pool->broken_count == 1);
+    assert(pool->flag[idx] == IN_USING && pool->deadline[idx] != 0);
+    conn_pool_check(pool);                              // 유예 중에는 그대로
+    assert(pool->cancel_count == 1 && pool->broken_count == 1);
+    usleep(20 * 1000);
+    conn_pool_check(pool);
+    assert(pool->cancel_count == 1 && pool->broken_count == 2);
+    assert(pool->flag[idx] == BROKEN);
+    release_conn(pool, c);
+    assert(conn_pool_check(pool) == 1);
+
+    // 반납 후 다시 잡은 점유는 처음부터 (취소 먼저)
+    c = get_conn_timeout(pool, 10);
+    assert((int)((PGconn_mock *)c - mocks) == idx);
+    usleep(20 * 1000);
+    conn_pool_check(pool);
+    assert(pool->cancel_count == 2 && pool->broken_count == 2);
+    release_conn(pool, c);
+    pool->cancel[idx] = NULL;
+
+    // 백그라운드 하우스키퍼: 멈춘 점유자가 있어도 대기자는 결국 커넥션을 받음
+    pool->hold_timeout_ms = 20;
+    conn_pool_housekeeper_start(pool, 5);
+    for (i = 0; i < CONN_SIZE; i++)
+        conns[i] = get_conn(pool);
+    usleep(50 * 1000);
+    for (i = 0; i < CONN_SIZE; i++)
+        release_conn(pool, conns[i]);   // 전부 BROKEN → CLOSE
+    c = get_conn(pool);                 // 하우스키퍼가 복구할 때까지 대기
+    assert(c != NULL);
+    release_conn(pool, c);
+    conn_pool_housekeeper_stop(pool);
+
+    free_mock_pool(pool);
+    printf("[PASS] test_conn_timeout\n");
+}
+
+// ─── 스레드 종료 시 affinity 항목 정리 테스트 ─────────────────
+
+#define EXIT_THREADS  64
+
+void *short_lived_worker(void *arg)
+{
+    conn_pool *pool = (conn_pool *)arg;
+    PGconn *c = get_conn(pool);
+    release_conn(pool, c);
+    return NULL;
+}
+
+void test_conn_thread_exit()
+{
+    PGconn_mock mocks[CONN_SIZE];
+    conn_pool *pool = make_mock_pool(mocks, CONN_SIZE);
+    pthread_t threads[EXIT_THREADS];
+    int i, waited;
+
+    conn_pool_reclaimer_start(pool, 10);
+
+    for (i = 0; i < EXIT_THREADS; i++)
+        pthread_create(&threads[i], NULL, short_lived_worker, pool);
+    for (i = 0; i < EXIT_THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    // 종료된 스레드의 항목은 즉시 soft delete
+    assert(hash_count(pool->map, FALSE) == 0);
+
+    // reclaimer 가 백그라운드에서 노드까지 회수
+    for (waited = 0; waited < 3000 && hash_count(pool->map, TRUE) > 0; waited += 50)
+        usleep(50 * 1000);
+    assert(hash_count(pool->map, TRUE) == 0);
+    assert(hash_deleted(pool->map) == 0);
+
+    // 살아있는 스레드의 항목은 그대로 유지
+    PGconn *c = get_conn(pool);
+    release_conn(pool, c);
+    assert(hash_count(pool->map, FALSE) == 1);
+
+    free_mock_pool(pool);
+    printf("[PASS] test_conn_thread_exit\n");
+}
+
+// ─── 멀티 풀 레지스트리 테스트 ───────────────────────────────
+
+static atomic_int mock_created = 0;
+
+static conn_pool *create_registry_mock(const char *conninfo)
+{
+    (void)conninfo;
+    PGconn_mock *mocks = calloc(CONN_SIZE, sizeof(PGconn_mock));
+    atomic_fetch_add_explicit(&mock_created, 1, memory_order_relaxed);
+    return make_mock_pool(mocks, CONN_SIZE);
+}
+
+static void destroy_registry_mock(conn_pool *pool)
+{
+    PGconn_mock *mocks = (PGconn_mock *)pool->conn_list[0];
+    conn_pool_destroy(pool);
+    free(mocks);
+}
+
+void test_registry()
+{
+    pool_registry reg;
+    registry_init(&reg, 2, create_registry_mock, destroy_registry_mock);
+    mock_created = 0;
+
+    // 옵션 순서/공백이 달라도 같은 database/user 면 같은 풀
+    conn_pool *a1 = registry_get(&reg, "host=h dbname=a user=u");
+    conn_pool *a2 = registry_get(&reg, "user=u   dbname=a host=h");
+    assert(a1 && a1 == a2);
+    assert(mock_created == 1);
+
+    // 다른 database → 맵/큐까지 분리된 별도 풀
+    conn_pool *b = registry_get(&reg, "host=h dbname=b user=u");
+    assert(b && b != a1);
+    assert(b->map != a1->map && b->que != a1->que);
+
+    // 한 풀의 대기자/캐시가 다른 풀에 보이지 않음
+    PGconn *c = get_conn(a1);
+    assert(hash_get(a1->map, (unsigned long)pthread_self()) != FAIL);
+    assert(hash_get(b->map, (unsigned long)pthread_self()) == FAIL);
+    release_conn(a1, c);
+
+    // 용량(2) 초과 + 전부 참조 중 → NULL
+    assert(registry_get(&reg, "host=h dbname=c user=u") == NULL);
+
+    // b 반납 → 참조 없는 LRU 인 b 가 축출되고 c 가 들어옴
+    registry_put(&reg, a1);
+    registry_put(&reg, a2);
+    usleep(2 * 1000);
+    registry_put(&reg, b);
+    usleep(2 * 1000);
+    registry_get(&reg, "host=h dbname=a user=u");   // a 를 최근 사용으로
+    registry_put(&reg, a1);
+    conn_pool *cc = registry_get(&reg, "host=h dbname=c user=u");
+    assert(cc != NULL);
+    assert(registry_get(&reg, "host=h dbname=a user=u") == a1);   // a 는 살아있음
+    registry_put(&reg, a1);
+    registry_put(&reg, cc);
+
+    // idle 축출
+    usleep(20 * 1000);
+    assert(registry_evict_idle(&reg, 10) == 2);
+
+    registry_destroy(&reg);
+    printf("[PASS] test_registry\n");
+}
+
+// ─── 획득 클래스(테넌트 쿼터) 테스트 ──────────────────────────
+
+#define CLS_INTERACTIVE  0
+#define CLS_BATCH        1
+#define CLS_BATCH_THREADS  8
+#define CLS_ITER         300
+
+typedef struct {
+    conn_pool *pool;
+    int        cls;
+    int        errors;
+} cls_worker_arg_t;
+
+void *cls_worker(void *arg)
+{
+    cls_worker_arg_t *a = (cls_worker_arg_t *)arg;
+    int i;
+    for (i = 0; i < CLS_ITER; i++)
+    {
+        PGconn *c = get_conn_class(a->pool, a->cls);
+        if (!c)
+        {
+            a->errors++;
+            continue;
+        }
+        usleep(100);
+        release_conn(a->pool, c);
+    }
+    return NULL;
+}
+
+void test_conn_class()
+{
+    PGconn_mock mocks[CONN_SIZE];
+    conn_pool *pool = make_mock_pool(mocks, CONN_SIZE);
+    class_conf conf[2] = { { 3, 1 }, { 0, 3 } };   // interactive: 보장 3, batch: 공유 가중치 3
+    PGconn *conns[CONN_SIZE];
+    class_stats st;
+    int i;
+
+    assert(conn_pool_set_classes(pool, conf, 2) == SUCCESS);
+    assert(pool->shared_size == CONN_SIZE - 3);
+
+    // 아무도 기다리지 않으면 batch 는 공유 슬롯 전부를 빌려 씀
+    for (i = 0; i < CONN_SIZE - 3; i++)
+        conns[i] = get_conn_class(pool, CLS_BATCH);
+    // batch 가 공유분을 다 잡아도 interactive 보장 3개는 대기 없이 획득
+    for (; i < CONN_SIZE; i++)
+        conns[i] = get_conn_class(pool, CLS_INTERACTIVE);
+    conn_pool_class_stats(pool, CLS_INTERACTIVE, &st);
+    assert(st.acquired == 3 && st.waits == 0);
+    for (i = 0; i < CONN_SIZE; i++)
+        release_conn(pool, conns[i]);
+    assert(pool->shared_used == 0);
+
+    // batch 폭주 중에도 interactive 는 보장 슬롯 안에서 한 번도 기다리지 않음
+    pthread_t        threads[CLS_BATCH_THREADS + 2];
+    cls_worker_arg_t args[CLS_BATCH_THREADS + 2];
+    for (i = 0; i < CLS_BATCH_THREADS + 2; i++)
+    {
+        args[i].pool   = pool;
+        args[i].cls    = i < 2 ? CLS_INTERACTIVE : CLS_BATCH;
+        args[i].errors = 0;
+        pthread_create(&threads[i], NULL, cls_worker, &args[i]);
+    }
+    for (i = 0; i < CLS_BATCH_THREADS + 2; i++)
+    {
+        pthread_join(threads[i], NULL);
+        assert(args[i].errors == 0);
+    }
+
+    conn_pool_class_stats(pool, CLS_INTERACTIVE, &st);
+    assert(st.waits == 0);
+    conn_pool_class_stats(pool, CLS_BATCH, &st);
+    printf("  batch: acquired=%ld waits=%ld avg_wait=%.1f us max_wait=%.1f us\n",
+           st.acquired, st.waits,
+           st.waits ? st.wait_ns_total / 1000.0 / st.waits : 0.0, st.wait_ns_max / 1000.0);
+
+    // 보장 슬롯 합이 풀 크기를 넘는 설정은 거부
+    conn_pool *bad = make_mock_pool(mocks, CONN_SIZE);
+    class_conf too_many[2] = { { CONN_SIZE, 1 }, { 1, 1 } };
+    assert(conn_pool_set_classes(bad, too_many, 2) == FAIL);
+    free_mock_pool(bad);
+
+    free_mock_pool(pool);
+    printf("[PASS] test_conn_class\n");
+}
+
 // ─── conn_pool 멀티스레드 테스트 ─────────────────────────────
 
 #define CP_THREADS  16
@@ -360,8 +2006,227 @@ void bench_get_conn(const char *label, get_conn_fn get_fn)
            label, total_ops, ms, mops);
 }
 
+// 락 종류별 처리량: 짧은 임계 구역을 BENCH_THREADS 개가 시간 제한 동안 경쟁
+#define LOCK_BENCH_MS  200
+#define LOCK_NAIVE     -1      // 기존 get_lock: backoff/pause 없는 full barrier CAS 스핀 + store 해제
+
+static atomic_int   lock_stop;
+static atomic_int   naive_flag;
+static cas_lock     bench_lock;
+static long         bench_counter;
+
+void *lock_bench_worker(void *arg)
+{
+    int kind = *(int *)arg;
+    while (!atomic_load_explicit(&lock_stop, memory_order_relaxed))
+    {
+        if (kind == LOCK_NAIVE)
+        {
+            int expected = FALSE;
+            while (!atomic_compare_exchange_strong(&naive_flag, &expected, TRUE))
+                expected = FALSE;
+            bench_counter++;
+            atomic_store_explicit(&naive_flag, FALSE, memory_order_release);
+        }
+        else
+        {
+            cas_lock_acquire(&bench_lock);
+            bench_counter++;
+            cas_lock_release(&bench_lock);
+        }
+    }
+    return NULL;
+}
+
+void bench_lock_kind(int kind)
+{
+    pthread_t threads[BENCH_THREADS];
+    struct timespec s, e;
+    struct timespec wait = { 0, LOCK_BENCH_MS * 1000000L };
+    int i;
+
+    cas_lock_init(&bench_lock, kind);
+    bench_counter = 0;
+    lock_stop = FALSE;
+    clock_gettime(CLOCK_MONOTONIC, &s);
+    for (i = 0; i < BENCH_THREADS; i++)
+        pthread_create(&threads[i], NULL, lock_bench_worker, &kind);
+    nanosleep(&wait, NULL);
+    lock_stop = TRUE;
+    for (i = 0; i < BENCH_THREADS; i++)
+        pthread_join(threads[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &e);
+
+    double ms = elapsed_ms(&s, &e);
+    printf("[BENCH] lock %-8s  %ld ops  %.2f ms  %.2f Mops/s\n",
+           kind == LOCK_NAIVE ? "naive" : cas_lock_name(kind),
+           bench_counter, ms, bench_counter / ms / 1000.0);
+}
+
+// 노드 16개를 할당했다가 해제하는 패턴 (큐 노드/버퍼 수명과 비슷)
+#define ALLOC_BATCH  16
+#define ALLOC_SIZE   sizeof(struct { void *next; int data; })
+
+static slab_cache bench_cache;
+
+void *alloc_worker(void *arg)
+{
+    int use_slab = *(int *)arg;
+    void *obj[ALLOC_BATCH];
+    int i, j;
+    for (i = 0; i < BENCH_ITER / ALLOC_BATCH; i++)
+    {
+        for (j = 0; j < ALLOC_BATCH; j++)
+            obj[j] = use_slab ? slab_alloc(&bench_cache) : malloc(ALLOC_SIZE);
+        for (j = 0; j < ALLOC_BATCH; j++)
+        {
+            if (use_slab)
+                slab_free(&bench_cache, obj[j]);
+            else
+                free(obj[j]);
+        }
+    }
+    return NULL;
+}
+
+void bench_alloc(const char *label, int use_slab)
+{
+    pthread_t threads[BENCH_THREADS];
+    struct timespec s, e;
+    int i;
+
+    slab_init(&bench_cache, ALLOC_SIZE);
+    clock_gettime(CLOCK_MONOTONIC, &s);
+    for (i = 0; i < BENCH_THREADS; i++)
+        pthread_create(&threads[i], NULL, alloc_worker, &use_slab);
+    for (i = 0; i < BENCH_THREADS; i++)
+        pthread_join(threads[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &e);
+    slab_destroy(&bench_cache);
+
+    long total_ops = (long)BENCH_THREADS * (BENCH_ITER / ALLOC_BATCH) * ALLOC_BATCH;
+    double ms      = elapsed_ms(&s, &e);
+    printf("[BENCH] %-10s  %ld ops  %.2f ms  %.2f Mops/s\n",
+           label, total_ops, ms, total_ops / ms / 1000.0);
+}
+
 // ─── PG 공통 타입 ────────────────────────────────────────────
 
+typedef struct {
+    int32_t   i4;
+    int64_t   i8;
+    double    f8;
+    int64_t   ts;
+    col_bytes raw;
+    col_bytes txt;
+    int       txt_null;
+} typed_row_t;
+
+static const col_bind typed_row_binds[] = {
+    { COL_INT4,      offsetof(typed_row_t, i4),  -1 },
+    { COL_INT8,      offsetof(typed_row_t, i8),  -1 },
+    { COL_FLOAT8,    offsetof(typed_row_t, f8),  -1 },
+    { COL_TIMESTAMP, offsetof(typed_row_t, ts),  -1 },
+    { COL_BYTEA,     offsetof(typed_row_t, raw), -1 },
+    { COL_TEXT,      offsetof(typed_row_t, txt), offsetof(typed_row_t, txt_null) },
+};
+
+typedef struct { int64_t v; } int8_row_t;
+static const col_bind int8_binds[] = { { COL_INT8, offsetof(int8_row_t, v), -1 } };
+
+typedef struct { int32_t v; } int4_row_t;
+static const col_bind int4_binds[] = { { COL_INT4, offsetof(int4_row_t, v), -1 } };
+
+static const col_bind ts_binds[] = { { COL_TIMESTAMP, offsetof(int8_row_t, v), -1 } };
+
+// ─── 바이너리 디코더 단위 테스트 (DB 없이 PGresult 직접 구성) ──
+
+void test_typed_decode()
+{
+    PGresAttDesc attrs[6];
+    Oid oids[6] = { INT4OID, INT8OID, FLOAT8OID, TIMESTAMPOID, BYTEAOID, TEXTOID };
+    int i;
+
+    memset(attrs, 0, sizeof(attrs));
+    for (i = 0; i < 6; i++)
+    {
+        attrs[i].name   = "c";
+        attrs[i].format = 1;
+        attrs[i].typid  = oids[i];
+    }
+
+    PGresult *res = PQmakeEmptyPGresult(NULL, PGRES_TUPLES_OK);
+    assert(PQsetResultAttrs(res, 6, attrs));
+
+    // 서버가 보내는 네트워크 바이트 순서 그대로 구성
+    uint32_t i4 = htobe32((uint32_t)-42);
+    uint64_t i8 = htobe64((uint64_t)1 << 40);
+    double   f  = 2.5;
+    uint64_t f8;
+    memcpy(&f8, &f, 8);
+    f8 = htobe64(f8);
+    uint64_t ts = htobe64(0);            // 2000-01-01 00:00:00
+    char raw[3] = { 0x00, 0x7f, (char)0xff };
+
+    assert(PQsetvalue(res, 0, 0, (char *)&i4, 4));
+    assert(PQsetvalue(res, 0, 1, (char *)&i8, 8));
+    assert(PQsetvalue(res, 0, 2, (char *)&f8, 8));
+    assert(PQsetvalue(res, 0, 3, (char *)&ts, 8));
+    assert(PQsetvalue(res, 0, 4, raw, 3));
+    assert(PQsetvalue(res, 0, 5, "hello", 5));
+    assert(PQsetvalue(res, 1, 0, (char *)&i4, 4));
+    assert(PQsetvalue(res, 1, 1, (char *)&i8, 8));
+    assert(PQsetvalue(res, 1, 2, (char *)&f8, 8));
+    assert(PQsetvalue(res, 1, 3, (char *)&ts, 8));
+    assert(PQsetvalue(res, 1, 4, raw, 3));
+    assert(PQsetvalue(res, 1, 5, NULL, -1));   // NULL
+
+    typed_row_t rows[4];
+    assert(typed_decode(res, typed_row_binds, 6, rows, sizeof(rows[0]), 4) == 2);
+    assert(rows[0].i4 == -42);
+    assert(rows[0].i8 == (int64_t)1 << 40);
+    assert(rows[0].f8 == 2.5);
+    assert(rows[0].ts == 946684800LL * 1000000LL);
+    assert(rows[0].raw.len == 3 && memcmp(rows[0].raw.data, raw, 3) == 0);
+    assert(rows[0].txt_null == 0 && rows[0].txt.len == 5 && strcmp(rows[0].txt.data, "hello") == 0);
+    assert(rows[1].txt_null == 1);
+
+    // max_rows 로 잘라내기
+    assert(typed_decode(res, typed_row_binds, 6, rows, sizeof(rows[0]), 1) == 1);
+
+    // 타입 불일치(int4 컬럼을 int8 로 요청)는 FAIL
+    assert(typed_decode(res, int8_binds, 1, rows, sizeof(int8_row_t), 4) == FAIL);
+
+    // NULL 불허 바인딩에 NULL 이 오면 FAIL
+    col_bind strict[6];
+    memcpy(strict, typed_row_binds, sizeof(strict));
+    strict[5].null_offset = -1;
+    assert(typed_decode(res, strict, 6, rows, sizeof(rows[0]), 4) == FAIL);
+
+    // 결과를 넘겨받지 않으면서 text/bytea 를 바인딩하면 실행 전에 FAIL (conn 을 건드리지 않음)
+    assert(typed_query(NULL, "SELECT 1", 0, NULL, typed_row_binds, 6, rows, sizeof(rows[0]), 4, NULL) == FAIL);
+    // 실패하면 넘겨받을 결과도 NULL (NULL conn 은 PQexecParams 가 NULL 을 돌려줌)
+    PGresult *out = res;
+    assert(typed_query(NULL, "SELECT 1", 0, NULL, typed_row_binds, 6, rows, sizeof(rows[0]), 4, &out) == FAIL);
+    assert(out == NULL);
+
+    PQclear(res);
+
+    // timestamp 'infinity' / '-infinity' 는 INT64_MAX / INT64_MIN 그대로
+    PGresult *inf = PQmakeEmptyPGresult(NULL, PGRES_TUPLES_OK);
+    int8_row_t ts_rows[2];
+    uint64_t pinf = htobe64((uint64_t)INT64_MAX);
+    uint64_t ninf = htobe64((uint64_t)INT64_MIN);
+    assert(PQsetResultAttrs(inf, 1, &attrs[3]));
+    assert(PQsetvalue(inf, 0, 0, (char *)&pinf, 8));
+    assert(PQsetvalue(inf, 1, 0, (char *)&ninf, 8));
+    assert(typed_decode(inf, ts_binds, 1, ts_rows, sizeof(ts_rows[0]), 2) == 2);
+    assert(ts_rows[0].v == INT64_MAX);
+    assert(ts_rows[1].v == INT64_MIN);
+    PQclear(inf);
+    printf("[PASS] test_typed_decode\n");
+}
+
 // ─── PG 실접속 풀 헬퍼 ───────────────────────────────────────
 
 #define DB_HOST "host.docker.internal"
@@ -371,45 +2236,15 @@ void bench_get_conn(const char *label, get_conn_fn get_fn)
 #define DB_PASS "pgpass"
 #define PG_CONNINFO "host=" DB_HOST " port=" DB_PORT " dbname=" DB_NAME " user=" DB_USER " password=" DB_PASS
 
-static hash_map g_pg_map;
-static wait_que g_pg_que;
-
 static conn_pool *make_pg_pool(const char *conninfo, int n)
 {
-    int i;
-    conn_pool *pool = calloc(1, sizeof(conn_pool));
-    if (!pool)
-        return NULL;
-
-    strncpy(pool->connect_info, conninfo, sizeof(pool->connect_info) - 1);
-    pool->map = &g_pg_map;
-    pool->que = &g_pg_que;
-    hash_init(pool->map);
-    queue_init(pool->que);
-    pthread_key_create(&pool->tls_key, NULL);
-
-    for (i = 0; i < n; i++)
-    {
-        pool->conn_list[i] = PQconnectdb(conninfo);
-        if (PQstatus(pool->conn_list[i]) != CONNECTION_OK)
-        {
-            fprintf(stderr, "[ERR] PQconnectdb[%d]: %s\n",
-                    i, PQerrorMessage(pool->conn_list[i]));
-            PQfinish(pool->conn_list[i]);
-            pool->conn_list[i] = NULL;
-        }
-    }
-    return pool;
+    (void)n;    // 풀 크기는 CONN_SIZE 고정
+    return conn_pool_create(conninfo);
 }
 
 static void free_pg_pool(conn_pool *pool)
 {
-    int i;
-    for (i = 0; i < CONN_SIZE; i++)
-        if (pool->conn_list[i])
-            PQfinish(pool->conn_list[i]);
-    pthread_key_delete(pool->tls_key);
-    free(pool);
+    conn_pool_destroy(pool);
 }
 
 // ─── PG 단일스레드: 다양한 쿼리 타입 검증 ───────────────────
@@ -428,11 +2263,13 @@ void test_pg_single(const char *label, get_conn_fn get_fn)
 
         PGresult *res;
 
-        // 1) 산술 연산 검증
-        res = PQexec(conn, "SELECT 6 * 7");
-        assert(PQresultStatus(res) == PGRES_TUPLES_OK);
-        assert(strcmp(PQgetvalue(res, 0, 0), "42") == 0);
-        PQclear(res);
+        int4_row_t r4;
+        int8_row_t r8;
+
+        // 1) 산술 연산 검증 (바이너리 결과로 직접 디코딩)
+        assert(typed_query(conn, "SELECT 6 * 7", 0, NULL, int4_binds, 1,
+                           &r4, sizeof(r4), 1, NULL) == 1);
+        assert(r4.v == 42);
 
         // 2) 임시 테이블 생성 → 100행 INSERT → COUNT 검증
         res = PQexec(conn, "CREATE TEMP TABLE _bench(id SERIAL, val INT)");
@@ -453,27 +2290,40 @@ void test_pg_single(const char *label, get_conn_fn get_fn)
             PQclear(res);
         }
 
-        res = PQexec(conn, "SELECT COUNT(*) FROM _bench");
-        assert(PQresultStatus(res) == PGRES_TUPLES_OK);
-        assert(strcmp(PQgetvalue(res, 0, 0), "100") == 0);
-        PQclear(res);
+        assert(typed_query(conn, "SELECT COUNT(*) FROM _bench", 0, NULL, int8_binds, 1,
+                           &r8, sizeof(r8), 1, NULL) == 1);
+        assert(r8.v == 100);
 
         // 3) SUM 검증 (0+1+...+99 = 4950)
-        res = PQexec(conn, "SELECT SUM(val) FROM _bench");
-        assert(PQresultStatus(res) == PGRES_TUPLES_OK);
-        assert(strcmp(PQgetvalue(res, 0, 0), "4950") == 0);
-        PQclear(res);
+        assert(typed_query(conn, "SELECT SUM(val) FROM _bench", 0, NULL, int8_binds, 1,
+                           &r8, sizeof(r8), 1, NULL) == 1);
+        assert(r8.v == 4950);
 
         // 4) DELETE → 빈 테이블 확인
         res = PQexec(conn, "DELETE FROM _bench");
         assert(PQresultStatus(res) == PGRES_COMMAND_OK);
         PQclear(res);
 
-        res = PQexec(conn, "SELECT COUNT(*) FROM _bench");
-        assert(strcmp(PQgetvalue(res, 0, 0), "0") == 0);
-        PQclear(res);
+        assert(typed_query(conn, "SELECT COUNT(*) FROM _bench", 0, NULL, int8_binds, 1,
+                           &r8, sizeof(r8), 1, NULL) == 1);
+        assert(r8.v == 0);
+
+        // 5) 전 타입 바이너리 디코딩
+        {
+            typed_row_t row;
+            PGresult *tres = NULL;
+            assert(typed_query(conn,
+                "SELECT 7::int4, 8000000000::int8, 0.5::float8, "
+                "'2000-01-01 00:00:01'::timestamp, '\\x00ff'::bytea, 'abc'::text",
+                0, NULL, typed_row_binds, 6, &row, sizeof(row), 1, &tres) == 1);
+            assert(row.i4 == 7 && row.i8 == 8000000000LL && row.f8 == 0.5);
+            assert(row.ts == (946684800LL + 1) * 1000000LL);
+            assert(row.raw.len == 2 && (unsigned char)row.raw.data[1] == 0xff);
+            assert(strcmp(row.txt.data, "abc") == 0);
+            PQclear(tres);
+        }
 
-        // 5) fast path 확인: 같은 스레드 재요청 시 같은 커넥션 반환
+        // 6) fast path 확인: 같은 스레드 재요청 시 같은 커넥션 반환
         release_conn(pool, conn);
         PGconn *c1 = get_fn(pool);
         release_conn(pool, c1);
@@ -511,32 +2361,27 @@ void *pg_worker(void *arg)
         PGconn *conn = a->get_fn(a->pool);
         if (!conn) { a->errors++; continue; }
 
-        // 쿼리마다 결과값 검증
-        char sql[64];
-        snprintf(sql, sizeof(sql), "SELECT %d * 2", i);
-        PGresult *res = PQexec(conn, sql);
+        // 쿼리마다 결과값 검증 (파라미터는 텍스트, 결과는 바이너리)
+        char param[16];
+        const char *params[1] = { param };
+        int4_row_t row;
+        snprintf(param, sizeof(param), "%d", i);
 
-        if (PQresultStatus(res) != PGRES_TUPLES_OK)
+        if (typed_query(conn, "SELECT $1::int4 * 2", 1, params, int4_binds, 1,
+                        &row, sizeof(row), 1, NULL) != 1)
         {
             fprintf(stderr, "[ERR] thread %d iter %d: %s\n",
                     a->thread_index, i, PQerrorMessage(conn));
             a->errors++;
         }
-        else
+        else if (row.v != i * 2)
         {
-            int expected = i * 2;
-            char exp_str[32];
-            snprintf(exp_str, sizeof(exp_str), "%d", expected);
-            if (strcmp(PQgetvalue(res, 0, 0), exp_str) != 0)
-            {
-                fprintf(stderr, "[ERR] thread %d: expected %s got %s\n",
-                        a->thread_index, exp_str, PQgetvalue(res, 0, 0));
-                a->errors++;
-            }
-            else
-                a->queries++;
+            fprintf(stderr, "[ERR] thread %d: expected %d got %d\n",
+                    a->thread_index, i * 2, row.v);
+            a->errors++;
         }
-        PQclear(res);
+        else
+            a->queries++;
         release_conn(a->pool, conn);
     }
     return NULL;
@@ -665,13 +2510,37 @@ int main()
 {
     test_single_thread();
     test_hash_collision();
+    test_hash_resize();
+    test_ebr();
+    test_hash_resize_concurrent();
+    test_hash_update_concurrent();
+    test_slab();
+    test_mpmc_queue();
+    test_rx_ring();
+    test_copy_escape();
+    test_uring();
+    test_async_log();
+    test_spill();
+    test_lat_hist();
+    test_timer_wheel();
+    test_cas_lock();
     test_multi_thread();
+    test_typed_decode();
     test_conn_single();
+    test_conn_timeout();
+    test_conn_thread_exit();
+    test_registry();
+    test_conn_class();
     test_conn_multi();
 
     printf("\n=== 마이크로벤치 (%d threads x %d iter) ===\n", BENCH_THREADS, BENCH_ITER);
     bench_get_conn("hash_map", get_conn);
     bench_get_conn("TLS",      get_conn_2);
+    bench_alloc("malloc", FALSE);
+    bench_alloc("slab",   TRUE);
+    bench_lock_kind(LOCK_NAIVE);
+    for (int kind = 0; kind < LOCK_KIND_COUNT; kind++)
+        bench_lock_kind(kind);
 
     printf("\n=== PG 실접속 테스트 [hash_map] (%s) ===\n", PG_CONNINFO);
     test_pg_single("hash_map", get_conn);
@@ -0,0 +1,195 @@
+#define _GNU_SOURCE     // ppoll
+#include "mpmc_queue.h"
+#include "thread_safe_queue.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+#define MPMC_CLOSE_WAKE (1UL << 30)  // close 때 eventfd 에 더하는 값 (모든 대기자가 빠져나갈 만큼)
+
+int mpmc_init(mpmc_queue *q, size_t capacity)
+{
+    size_t size = 2;
+    size_t i;
+
+    while (size < capacity)
+        size <<= 1;
+    if (posix_memalign((void **)&q->cells, 64, sizeof(mpmc_cell) * size) != 0)
+        return FAIL;
+    for (i = 0; i < size; i++)
+    {
+        atomic_init(&q->cells[i].seq, i);
+        q->cells[i].data = NULL;
+    }
+    q->mask = size - 1;
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->sleepers, 0);
+    atomic_init(&q->closed, FALSE);
+    q->efd = eventfd(0, EFD_SEMAPHORE | EFD_NONBLOCK | EFD_CLOEXEC);
+    if (q->efd < 0)
+    {
+        free(q->cells);
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+void mpmc_destroy(mpmc_queue *q)
+{
+    close(q->efd);
+    free(q->cells);
+    q->cells = NULL;
+}
+
+int mpmc_push(mpmc_queue *q, void *data)
+{
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    mpmc_cell *cell = NULL;
+
+    for (;;)
+    {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0)
+        {
+            // 위치만 차지 (칸 내용은 seq 로 공개하므로 relaxed)
+            if (atomic_compare_exchange_weak_explicit(&q->head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (dif < 0)
+            return FAIL;        // 한 바퀴 전 칸을 아직 아무도 꺼내지 않음 → 가득 참
+        else
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    }
+    cell->data = data;
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+
+    // 잠들려는 pop_wait 와의 순서: 둘 다 sleepers 에 RMW 를 하므로 한쪽이 반드시 다른 쪽을 봄.
+    // 내가 먼저면 상대의 재확인이 위 칸을 보고, 상대가 먼저면 내가 0 이 아닌 값을 보고 깨움
+    if (atomic_fetch_add_explicit(&q->sleepers, 0, memory_order_acq_rel) > 0)
+    {
+        uint64_t one = 1;
+        ssize_t w = write(q->efd, &one, sizeof(one));
+        (void)w;
+    }
+    return SUCCESS;
+}
+
+int mpmc_try_pop(mpmc_queue *q, void **data)
+{
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    mpmc_cell *cell = NULL;
+
+    for (;;)
+    {
+        cell = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (dif == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (dif < 0)
+            return FAIL;        // 아직 채워지지 않음 → 비었음
+        else
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    }
+    *data = cell->data;
+    // 다음 바퀴의 push 에게 칸을 넘김
+    atomic_store_explicit(&cell->seq, pos + q->mask + 1, memory_order_release);
+    return SUCCESS;
+}
+
+static long now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+// eventfd 에 신호가 올 때까지 (timeout_us < 0 이면 무제한) 잠듦.
+// 여러 대기자가 같은 신호에 깨어날 수 있어 read 는 non-blocking (먼저 가져간 쪽이 소비)
+static void wait_event(mpmc_queue *q, long timeout_us)
+{
+    struct pollfd pfd = { .fd = q->efd, .events = POLLIN, .revents = 0 };
+    struct timespec ts = { timeout_us / 1000000, (timeout_us % 1000000) * 1000 };
+    uint64_t v;
+
+    if (ppoll(&pfd, 1, timeout_us < 0 ? NULL : &ts, NULL) > 0)
+    {
+        ssize_t r = read(q->efd, &v, sizeof(v));
+        (void)r;
+    }
+}
+
+void *mpmc_pop_timed(mpmc_queue *q, long timeout_us)
+{
+    long deadline = timeout_us < 0 ? 0 : now_us() + timeout_us;
+    void *data = NULL;
+    int i;
+
+    for (;;)
+    {
+        long left = -1;
+
+        for (i = 0; i < MPMC_SPIN; i++)
+        {
+            if (mpmc_try_pop(q, &data) == SUCCESS)
+                return data;
+            cpu_relax();
+        }
+
+        // 잠들겠다고 알린 뒤 한 번 더 확인 (그 사이 push 는 sleepers 를 보고 깨움)
+        atomic_fetch_add_explicit(&q->sleepers, 1, memory_order_acq_rel);
+        if (mpmc_try_pop(q, &data) == SUCCESS)
+        {
+            atomic_fetch_sub_explicit(&q->sleepers, 1, memory_order_relaxed);
+            return data;
+        }
+        if (timeout_us >= 0)
+            left = deadline - now_us();
+        if (atomic_load_explicit(&q->closed, memory_order_acquire) || (timeout_us >= 0 && left <= 0))
+        {
+            atomic_fetch_sub_explicit(&q->sleepers, 1, memory_order_relaxed);
+            return NULL;
+        }
+
+        wait_event(q, left);
+        atomic_fetch_sub_explicit(&q->sleepers, 1, memory_order_relaxed);
+    }
+}
+
+void *mpmc_pop_wait(mpmc_queue *q)
+{
+    return mpmc_pop_timed(q, -1);
+}
+
+void mpmc_close(mpmc_queue *q)
+{
+    uint64_t wake = MPMC_CLOSE_WAKE;
+    ssize_t w;
+
+    atomic_store_explicit(&q->closed, TRUE, memory_order_release);
+    // 이후 eventfd 대기는 모두 바로 돌아옴 → 대기자는 closed 를 보고 빠져나감
+    w = write(q->efd, &wake, sizeof(wake));
+    (void)w;
+}
+
+size_t mpmc_size(mpmc_queue *q)
+{
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    // tail 을 먼저 읽었으므로 그 사이 pop 이 있어도 head >= tail. 위치만 차지하고 아직
+    // 칸을 채우지 않은 push 도 포함됨 (곧 들어올 것이므로 watermark 용도로는 괜찮음)
+    return head >= tail ? head - tail : 0;
+}
@@ -0,0 +1,41 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+// 고정 크기 lock-free MPMC 링 (Vyukov). 칸마다 seq 를 두어
+//   seq == pos     : 비어 있음, pos 번째 push 가 씀
+//   seq == pos + 1 : 차 있음, pos 번째 pop 이 읽음
+// push/pop 은 위치 CAS 1 회 + 칸 seq release store 1 회. 포인터만 담으므로 메시지는 복사하지 않음.
+// 비었을 때 mpmc_pop_wait 는 eventfd 에서 잠들고, push 는 잠든 스레드가 있을 때만 write
+
+#define MPMC_SPIN 64    // 잠들기 전 다시 꺼내 보는 횟수
+
+typedef struct
+{
+    atomic_size_t seq;
+    void         *data;
+} mpmc_cell;
+
+typedef struct
+{
+    mpmc_cell    *cells;
+    size_t        mask;                                 // 칸 수 - 1 (2의 거듭제곱)
+    atomic_size_t head __attribute__((aligned(64)));    // 다음 push 위치
+    atomic_size_t tail __attribute__((aligned(64)));    // 다음 pop 위치
+    atomic_int    sleepers __attribute__((aligned(64)));// eventfd 에서 자는(자려는) 스레드 수
+    atomic_int    closed;
+    int           efd;                                  // EFD_SEMAPHORE: write 1 회 = 1 명 깨움 (non-blocking)
+} mpmc_queue;
+
+int   mpmc_init(mpmc_queue *q, size_t capacity);   // capacity 는 2의 거듭제곱으로 올림
+void  mpmc_destroy(mpmc_queue *q);                 // 남은 포인터는 호출자가 정리
+int   mpmc_push(mpmc_queue *q, void *data);        // 가득 차면 FAIL
+int   mpmc_try_pop(mpmc_queue *q, void **data);    // 비었으면 FAIL
+void *mpmc_pop_wait(mpmc_queue *q);                // 빌 때는 잠듦. close 후 다 비면 NULL
+void *mpmc_pop_timed(mpmc_queue *q, long timeout_us); // pop_wait + 시간 초과면 NULL (음수 = 무제한)
+void  mpmc_close(mpmc_queue *q);                   // 대기 중인 pop_wait 를 모두 깨움
+size_t mpmc_size(mpmc_queue *q);                   // 들어 있는 개수 (근사값: 동시 push/pop 중이면 어긋날 수 있음)
+
+#endif // MPMC_QUEUE_H
@@ -0,0 +1,193 @@
+#include "pool_registry.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+void registry_key(const char *conninfo, char *key, size_t size)
+{
+    const char *host = "", *port = "", *dbname = "", *user = "";
+    PQconninfoOption *opts = PQconninfoParse(conninfo, NULL);
+    PQconninfoOption *opt;
+
+    if(!opts)
+    {
+        snprintf(key, size, "%s", conninfo);
+        return;
+    }
+
+    // 같은 database/user 라면 옵션 순서·공백이 달라도 같은 풀
+    for(opt = opts; opt->keyword; opt++)
+    {
+        if(!opt->val)
+            continue;
+        if(strcmp(opt->keyword, "host") == 0)        host = opt->val;
+        else if(strcmp(opt->keyword, "port") == 0)   port = opt->val;
+        else if(strcmp(opt->keyword, "dbname") == 0) dbname = opt->val;
+        else if(strcmp(opt->keyword, "user") == 0)   user = opt->val;
+    }
+    snprintf(key, size, "%s:%s/%s/%s", host, port, dbname, user);
+    PQconninfoFree(opts);
+}
+
+void registry_init(pool_registry *reg, int capacity,
+                   pool_create_fn create, pool_destroy_fn destroy)
+{
+    memset(reg->entry, 0, sizeof(reg->entry));
+    reg->capacity = (capacity > 0 && capacity <= REGISTRY_SIZE) ? capacity : REGISTRY_SIZE;
+    reg->create   = create ? create : conn_pool_create;
+    reg->destroy  = destroy ? destroy : conn_pool_destroy;
+    pthread_rwlock_init(&reg->lock, NULL);
+}
+
+void registry_destroy(pool_registry *reg)
+{
+    int i;
+    for(i = 0; i < REGISTRY_SIZE; i++)
+    {
+        if(reg->entry[i].pool)
+            reg->destroy(reg->entry[i].pool);
+        reg->entry[i].pool = NULL;
+    }
+    pthread_rwlock_destroy(&reg->lock);
+}
+
+// read lock 하에서 호출: 찾으면 참조 증가
+static conn_pool *lookup(pool_registry *reg, const char *key)
+{
+    int i;
+    for(i = 0; i < REGISTRY_SIZE; i++)
+    {
+        registry_entry *e = &reg->entry[i];
+        if(!e->pool || strcmp(e->key, key) != 0)
+            continue;
+
+        // read lock 을 잡은 여러 스레드가 동시에 갱신 → 카운터만 원자적으로 (순서 보장 불필요)
+        atomic_fetch_add_explicit(&e->refs, 1, memory_order_relaxed);
+        atomic_store_explicit(&e->last_used, now_ms(), memory_order_relaxed);
+        return e->pool;
+    }
+    return NULL;
+}
+
+// write lock 하에서 호출: 빈 칸 또는 참조 없는 LRU 칸. 축출 대상은 *victim 으로
+static registry_entry *free_slot(pool_registry *reg, conn_pool **victim)
+{
+    int i, used = 0;
+    registry_entry *empty = NULL;
+    registry_entry *lru = NULL;
+
+    *victim = NULL;
+    for(i = 0; i < REGISTRY_SIZE; i++)
+    {
+        registry_entry *e = &reg->entry[i];
+        if(!e->pool)
+        {
+            if(!empty)
+                empty = e;
+            continue;
+        }
+        used++;
+        if(atomic_load_explicit(&e->refs, memory_order_relaxed) == 0
+           && (!lru || atomic_load_explicit(&e->last_used, memory_order_relaxed)
+                       < atomic_load_explicit(&lru->last_used, memory_order_relaxed)))
+            lru = e;
+    }
+
+    if(empty && used < reg->capacity)
+        return empty;
+    if(!lru)
+        return NULL;
+
+    *victim = lru->pool;
+    lru->pool = NULL;
+    return lru;
+}
+
+conn_pool *registry_get(pool_registry *reg, const char *conninfo)
+{
+    char key[REGISTRY_KEY];
+    conn_pool *pool;
+    conn_pool *victim = NULL;
+    registry_entry *slot;
+
+    registry_key(conninfo, key, sizeof(key));
+
+    // fast path: 이미 있는 풀
+    pthread_rwlock_rdlock(&reg->lock);
+    pool = lookup(reg, key);
+    pthread_rwlock_unlock(&reg->lock);
+    if(pool)
+        return pool;
+
+    // 커넥션 생성은 느리므로 락 밖에서
+    conn_pool *created = reg->create(conninfo);
+    if(!created)
+        return NULL;
+
+    pthread_rwlock_wrlock(&reg->lock);
+    pool = lookup(reg, key);           // 그 사이 다른 스레드가 등록했으면 그쪽 사용
+    if(!pool && (slot = free_slot(reg, &victim)) != NULL)
+    {
+        snprintf(slot->key, sizeof(slot->key), "%s", key);
+        atomic_store_explicit(&slot->refs, 1, memory_order_relaxed);
+        atomic_store_explicit(&slot->last_used, now_ms(), memory_order_relaxed);
+        slot->pool      = created;
+        pool = created;
+        created = NULL;
+    }
+    pthread_rwlock_unlock(&reg->lock);
+
+    if(created)
+        reg->destroy(created);
+    if(victim)
+        reg->destroy(victim);
+    return pool;
+}
+
+void registry_put(pool_registry *reg, conn_pool *pool)
+{
+    int i;
+    pthread_rwlock_rdlock(&reg->lock);
+    for(i = 0; i < REGISTRY_SIZE; i++)
+    {
+        registry_entry *e = &reg->entry[i];
+        if(e->pool != pool)
+            continue;
+        atomic_store_explicit(&e->last_used, now_ms(), memory_order_relaxed);
+        atomic_fetch_sub_explicit(&e->refs, 1, memory_order_relaxed);
+        break;
+    }
+    pthread_rwlock_unlock(&reg->lock);
+}
+
+int registry_evict_idle(pool_registry *reg, long idle_ms)
+{
+    int i, n = 0;
+    conn_pool *victims[REGISTRY_SIZE];
+    long now = now_ms();
+
+    pthread_rwlock_wrlock(&reg->lock);
+    for(i = 0; i < REGISTRY_SIZE; i++)
+    {
+        registry_entry *e = &reg->entry[i];
+        if(!e->pool || atomic_load_explicit(&e->refs, memory_order_relaxed) != 0
+           || now - atomic_load_explicit(&e->last_used, memory_order_relaxed) < idle_ms)
+            continue;
+        victims[n++] = e->pool;
+        e->pool = NULL;
+    }
+    pthread_rwlock_unlock(&reg->lock);
+
+    // 풀 해제(PQfinish)는 락 밖에서
+    for(i = 0; i < n; i++)
+        reg->destroy(victims[i]);
+    return n;
+}
@@ -0,0 +1,47 @@
+#ifndef POOL_REGISTRY_H
+#define POOL_REGISTRY_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "conn_pool.h"
+
+#define REGISTRY_SIZE   16
+#define REGISTRY_KEY   256
+
+typedef conn_pool *(*pool_create_fn)(const char *conninfo);
+typedef void       (*pool_destroy_fn)(conn_pool *pool);
+
+typedef struct
+{
+    conn_pool  *pool;
+    char        key[REGISTRY_KEY];  // host:port/dbname/user (정규화된 conninfo)
+    atomic_long refs;               // registry_get - registry_put (read lock 하에서도 바뀜)
+    atomic_long last_used;          // LRU 기준 (CLOCK_MONOTONIC ms)
+} registry_entry;
+
+typedef struct
+{
+    registry_entry   entry[REGISTRY_SIZE];
+    int              capacity;      // 동시에 유지할 서브풀 수 (<= REGISTRY_SIZE)
+    pthread_rwlock_t lock;          // 조회는 read, 추가/축출만 write
+    pool_create_fn   create;
+    pool_destroy_fn  destroy;
+} pool_registry;
+
+// create/destroy 가 NULL 이면 conn_pool_create / conn_pool_destroy
+void       registry_init(pool_registry *reg, int capacity,
+                         pool_create_fn create, pool_destroy_fn destroy);
+void       registry_destroy(pool_registry *reg);
+
+// conninfo 에 해당하는 풀 반환 (없으면 생성, 가득 차면 참조 없는 LRU 풀 축출)
+// 모두 사용 중이면 NULL. 사용이 끝나면 registry_put
+conn_pool *registry_get(pool_registry *reg, const char *conninfo);
+void       registry_put(pool_registry *reg, conn_pool *pool);
+
+// 참조 없이 idle_ms 이상 쓰이지 않은 풀 축출. 축출한 풀 수 반환
+int        registry_evict_idle(pool_registry *reg, long idle_ms);
+
+// conninfo → "host:port/dbname/user". 파싱 실패 시 원문 그대로
+void       registry_key(const char *conninfo, char *key, size_t size);
+
+#endif // POOL_REGISTRY_H
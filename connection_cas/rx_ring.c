@@ -0,0 +1,186 @@
+#include "rx_ring.h"
+#include "thread_safe_queue.h"
+
+#include <errno.h>
+#include <string.h>
+
+int rx_pool_init(rx_pool *pool)
+{
+    int k;
+
+    for (k = 0; k < RX_RING_CLASSES; k++)
+    {
+        if (slab_init(&pool->cls[k], (size_t)RX_RING_MIN << k) != SUCCESS)
+        {
+            while (--k >= 0)
+                slab_destroy(&pool->cls[k]);
+            return FAIL;
+        }
+    }
+    return SUCCESS;
+}
+
+void rx_pool_destroy(rx_pool *pool)
+{
+    int k;
+
+    for (k = 0; k < RX_RING_CLASSES; k++)
+        slab_destroy(&pool->cls[k]);
+}
+
+void rx_ring_init(rx_ring *r)
+{
+    memset(r, 0, sizeof(*r));
+}
+
+// 링 내용을 [from, from + n) 부터 dst 로 (감긴 부분은 두 번에 나눠)
+static void ring_copy(const rx_ring *r, size_t from, size_t n, char *dst)
+{
+    size_t off = from & (r->cap - 1);
+    size_t first = r->cap - off < n ? r->cap - off : n;
+
+    memcpy(dst, r->buf + off, first);
+    memcpy(dst + first, r->buf, n - first);
+}
+
+// 한 단계 큰 버퍼로 옮김. 남은 데이터는 새 버퍼 앞쪽으로 펴서 복사
+static int ring_grow(rx_pool *pool, rx_ring *r)
+{
+    size_t used = r->tail - r->head;
+    char *nbuf = NULL;
+
+    if (r->cls + 1 >= RX_RING_CLASSES)
+        return FAIL;
+    nbuf = slab_alloc(&pool->cls[r->cls + 1]);
+    if (nbuf == NULL)
+        return FAIL;
+    ring_copy(r, r->head, used, nbuf);
+    slab_free(&pool->cls[r->cls], r->buf);
+    r->cls++;
+    r->buf = nbuf;
+    r->cap = RX_RING_MIN << r->cls;
+    r->head = 0;
+    r->tail = used;
+    return SUCCESS;
+}
+
+ssize_t rx_ring_recv(rx_pool *pool, rx_ring *r, int fd)
+{
+    struct iovec iov[2];
+    size_t space, off, first;
+    ssize_t n;
+
+    if (r->buf == NULL)
+    {
+        r->buf = slab_alloc(&pool->cls[r->cls]);
+        if (r->buf == NULL)
+        {
+            errno = ENOBUFS;
+            return -1;
+        }
+        r->cap = RX_RING_MIN << r->cls;
+        r->head = r->tail = 0;
+    }
+    if (r->grow || r->tail - r->head == r->cap)
+        ring_grow(pool, r);     // 최대 크기면 그대로 (남은 공간만큼 읽음)
+    r->grow = FALSE;
+
+    space = r->cap - (r->tail - r->head);
+    if (space == 0)
+    {
+        // 최대 크기 버퍼가 미완성 프레임으로 가득 참 (max_len 이 버퍼보다 큰 설정)
+        errno = ENOBUFS;
+        return -1;
+    }
+    off = r->tail & (r->cap - 1);
+    first = r->cap - off < space ? r->cap - off : space;
+    iov[0].iov_base = r->buf + off;
+    iov[0].iov_len = first;
+    iov[1].iov_base = r->buf;
+    iov[1].iov_len = space - first;
+
+    n = readv(fd, iov, iov[1].iov_len ? 2 : 1);
+    if (n > 0)
+    {
+        r->tail += n;
+        if ((size_t)n == space)
+            r->grow = TRUE;     // 소켓에 더 남았을 가능성이 큼
+    }
+    return n;
+}
+
+int rx_ring_append(rx_pool *pool, rx_ring *r, const char *data, size_t len)
+{
+    size_t off, first;
+
+    if (r->buf == NULL)
+    {
+        r->buf = slab_alloc(&pool->cls[r->cls]);
+        if (r->buf == NULL)
+            return FAIL;
+        r->cap = RX_RING_MIN << r->cls;
+        r->head = r->tail = 0;
+    }
+    while (r->cap - (r->tail - r->head) < len)
+    {
+        if (ring_grow(pool, r) != SUCCESS)
+            return FAIL;
+    }
+    off = r->tail & (r->cap - 1);
+    first = r->cap - off < len ? r->cap - off : len;
+    memcpy(r->buf + off, data, first);
+    memcpy(r->buf, data + first, len - first);
+    r->tail += len;
+    return SUCCESS;
+}
+
+int rx_ring_next(rx_ring *r, size_t max_len, rx_frame *f)
+{
+    size_t avail = r->tail - r->head;
+    unsigned char hdr[RX_FRAME_HDR];
+    size_t len, off, first;
+
+    if (avail < RX_FRAME_HDR)
+        return 0;
+    ring_copy(r, r->head, RX_FRAME_HDR, (char *)hdr);
+    len = (size_t)hdr[0] << 24 | (size_t)hdr[1] << 16 | (size_t)hdr[2] << 8 | hdr[3];
+    if (len > max_len)
+        return -1;
+    if (avail < RX_FRAME_HDR + len)
+        return 0;
+
+    off = (r->head + RX_FRAME_HDR) & (r->cap - 1);
+    first = r->cap - off < len ? r->cap - off : len;
+    f->seg[0].iov_base = r->buf + off;
+    f->seg[0].iov_len = first;
+    f->seg[1].iov_base = r->buf;
+    f->seg[1].iov_len = len - first;
+    f->len = len;
+    r->head += RX_FRAME_HDR + len;
+    return 1;
+}
+
+void rx_ring_trim(rx_pool *pool, rx_ring *r)
+{
+    if (r->buf != NULL && r->head == r->tail)
+    {
+        rx_ring_release(pool, r);
+        r->cls = 0;     // 다음에는 가장 작은 크기부터 (한때 몰렸던 연결이 쉬면서 64K 를 계속 빌리지 않도록)
+        r->grow = FALSE;
+    }
+}
+
+void rx_ring_release(rx_pool *pool, rx_ring *r)
+{
+    if (r->buf != NULL)
+        slab_free(&pool->cls[r->cls], r->buf);
+    r->buf = NULL;
+    r->head = r->tail = 0;
+}
+
+size_t rx_frame_copy(const rx_frame *f, char *dst)
+{
+    memcpy(dst, f->seg[0].iov_base, f->seg[0].iov_len);
+    memcpy(dst + f->seg[0].iov_len, f->seg[1].iov_base, f->seg[1].iov_len);
+    return f->len;
+}
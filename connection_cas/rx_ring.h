@@ -0,0 +1,53 @@
+#ifndef RX_RING_H
+#define RX_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "slab.h"
+
+// 연결별 수신 링 + 길이 접두 프레이밍
+// 링 버퍼는 크기별 slab 에서 빌리고, 비면 바로 돌려줌 → 쉬는 연결은 버퍼를 들고 있지 않음.
+// readv 한 번으로 링의 빈 공간(끝에서 감기면 두 조각)을 다 채우고, 꽉 채운 읽기가 나오면
+// 다음 읽기 전에 한 단계 큰 버퍼로 옮김.
+// 프레임 = 4 바이트 big-endian 길이 + 본문. rx_ring_next 는 본문을 복사하지 않고 링 안의
+// 위치(감기면 두 조각)만 돌려줌. 그 위치는 다음 rx_ring_recv/rx_ring_trim 전까지만 유효
+
+#define RX_RING_MIN      4096   // 가장 작은 버퍼 (2의 거듭제곱)
+#define RX_RING_CLASSES  5      // 4K, 8K, 16K, 32K, 64K
+#define RX_FRAME_HDR     4
+
+typedef struct
+{
+    slab_cache cls[RX_RING_CLASSES];    // cls[k] 는 RX_RING_MIN << k 바이트
+} rx_pool;
+
+typedef struct
+{
+    char    *buf;       // NULL = 비어서 pool 에 돌려줌
+    uint32_t cap;       // 2의 거듭제곱
+    uint8_t  cls;       // 다음에 빌릴 크기 (트래픽에 맞춰 커지고, 비워 반납하면 가장 작은 크기로)
+    uint8_t  grow;      // 직전 읽기가 빈 공간을 다 채움 → 다음 읽기 전에 키움
+    size_t   head;      // 다음 읽을 위치 (단조 증가, & (cap - 1) 로 접근)
+    size_t   tail;      // 다음 쓸 위치
+} rx_ring;
+
+typedef struct
+{
+    struct iovec seg[2];    // 본문. 감기지 않았으면 seg[1].iov_len == 0
+    size_t       len;
+} rx_frame;
+
+int     rx_pool_init(rx_pool *pool);
+void    rx_pool_destroy(rx_pool *pool);
+
+void    rx_ring_init(rx_ring *r);
+ssize_t rx_ring_recv(rx_pool *pool, rx_ring *r, int fd);        // recv 와 같은 반환값 (버퍼 없음: -1, ENOBUFS)
+int     rx_ring_append(rx_pool *pool, rx_ring *r, const char *data, size_t len);  // 이미 받은 바이트 (io_uring 버퍼). 64K 초과면 FAIL
+int     rx_ring_next(rx_ring *r, size_t max_len, rx_frame *f);  // 1 = 프레임, 0 = 더 받아야 함, -1 = max_len 초과
+void    rx_ring_trim(rx_pool *pool, rx_ring *r);                // 비었으면 버퍼 반납 + 크기를 처음으로
+void    rx_ring_release(rx_pool *pool, rx_ring *r);             // 연결 종료 시
+size_t  rx_frame_copy(const rx_frame *f, char *dst);            // 본문을 dst 로 (반환 = len)
+
+#endif // RX_RING_H
@@ -0,0 +1,237 @@
+#include "slab.h"
+#include "thread_safe_queue.h"
+
+#include <stdlib.h>
+
+#define SLAB_ALIGN 16
+
+// ─── depot (cache->lock 하에서) ─────────────────────────────────
+
+static void depot_put(slab_cache *cache, slab_mag *mag)
+{
+    if (mag->count > 0)
+    {
+        mag->next = cache->full;
+        cache->full = mag;
+    }
+    else
+    {
+        mag->next = cache->empty;
+        cache->empty = mag;
+    }
+}
+
+static slab_mag *take(slab_mag **list)
+{
+    slab_mag *mag = *list;
+    if (mag)
+        *list = mag->next;
+    return mag;
+}
+
+// magazine 하나 분량의 객체를 malloc 1회로 받아 mag 에 채움
+static int refill(slab_cache *cache, slab_mag *mag)
+{
+    size_t head = (sizeof(slab_chunk) + SLAB_ALIGN - 1) & ~(size_t)(SLAB_ALIGN - 1);
+    slab_chunk *chunk = NULL;
+    int i;
+
+    if (posix_memalign((void **)&chunk, SLAB_ALIGN, head + cache->obj_size * SLAB_MAG_SIZE) != 0)
+        return FAIL;
+    chunk->next = cache->chunks;
+    cache->chunks = chunk;
+    cache->nchunk++;
+
+    for (i = 0; i < SLAB_MAG_SIZE; i++)
+        mag->obj[i] = (char *)chunk + head + cache->obj_size * i;
+    mag->count = SLAB_MAG_SIZE;
+    return SUCCESS;
+}
+
+static slab_mag *mag_new(void)
+{
+    slab_mag *mag = malloc(sizeof(slab_mag));
+    if (mag)
+    {
+        mag->next = NULL;
+        mag->count = 0;
+    }
+    return mag;
+}
+
+// ─── 스레드별 magazine ─────────────────────────────────────────
+
+// 스레드 종료 시 pthread key destructor: 들고 있던 magazine 을 depot 에 반납
+static void tls_release(void *arg)
+{
+    slab_tls *tls = (slab_tls *)arg;
+    slab_cache *cache = tls->cache;
+    slab_tls **pp = NULL;
+
+    pthread_mutex_lock(&cache->lock);
+    depot_put(cache, tls->loaded);
+    depot_put(cache, tls->prev);
+    for (pp = &cache->tls; *pp; pp = &(*pp)->next)
+    {
+        if (*pp == tls)
+        {
+            *pp = tls->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&cache->lock);
+    free(tls);
+}
+
+static slab_tls *get_tls(slab_cache *cache)
+{
+    slab_tls *tls = pthread_getspecific(cache->key);
+    if (tls)
+        return tls;
+
+    tls = malloc(sizeof(slab_tls));
+    if (!tls)
+        return NULL;
+    tls->cache = cache;
+    tls->loaded = mag_new();
+    tls->prev = mag_new();
+    if (!tls->loaded || !tls->prev)
+    {
+        free(tls->loaded);
+        free(tls->prev);
+        free(tls);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    tls->next = cache->tls;
+    cache->tls = tls;
+    pthread_mutex_unlock(&cache->lock);
+    pthread_setspecific(cache->key, tls);
+    return tls;
+}
+
+// ─── 공개 API ─────────────────────────────────────────────────
+
+int slab_init(slab_cache *cache, size_t obj_size)
+{
+    if (obj_size == 0)
+        obj_size = 1;
+    cache->obj_size = (obj_size + SLAB_ALIGN - 1) & ~(size_t)(SLAB_ALIGN - 1);
+    cache->full = NULL;
+    cache->empty = NULL;
+    cache->chunks = NULL;
+    cache->tls = NULL;
+    cache->nchunk = 0;
+    if (pthread_mutex_init(&cache->lock, NULL) != 0)
+        return FAIL;
+    if (pthread_key_create(&cache->key, tls_release) != 0)
+    {
+        pthread_mutex_destroy(&cache->lock);
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+void *slab_alloc(slab_cache *cache)
+{
+    slab_tls *tls = get_tls(cache);
+    slab_mag *tmp = NULL;
+    if (!tls)
+        return NULL;
+
+    // 빠른 경로: 락 없음
+    if (tls->loaded->count > 0)
+        return tls->loaded->obj[--tls->loaded->count];
+    if (tls->prev->count > 0)
+    {
+        tmp = tls->loaded;
+        tls->loaded = tls->prev;
+        tls->prev = tmp;
+        return tls->loaded->obj[--tls->loaded->count];
+    }
+
+    // 둘 다 빔: 빈 prev 를 depot 에 주고 가득 찬 magazine 을 받음
+    pthread_mutex_lock(&cache->lock);
+    tmp = take(&cache->full);
+    if (tmp)
+    {
+        depot_put(cache, tls->prev);
+        tls->prev = tls->loaded;
+        tls->loaded = tmp;
+    }
+    else if (refill(cache, tls->loaded) != SUCCESS)
+    {
+        pthread_mutex_unlock(&cache->lock);
+        return NULL;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    return tls->loaded->obj[--tls->loaded->count];
+}
+
+void slab_free(slab_cache *cache, void *obj)
+{
+    slab_tls *tls = get_tls(cache);
+    slab_mag *tmp = NULL;
+    if (!obj)
+        return;
+    if (!tls)
+        abort();    // 반납할 곳이 없으면 객체를 잃음
+
+    if (tls->loaded->count < SLAB_MAG_SIZE)
+    {
+        tls->loaded->obj[tls->loaded->count++] = obj;
+        return;
+    }
+    if (tls->prev->count == 0)
+    {
+        tmp = tls->loaded;
+        tls->loaded = tls->prev;
+        tls->prev = tmp;
+        tls->loaded->obj[tls->loaded->count++] = obj;
+        return;
+    }
+
+    // 둘 다 가득: 가득 찬 prev 를 depot 에 주고 빈 magazine 을 받음
+    pthread_mutex_lock(&cache->lock);
+    tmp = take(&cache->empty);
+    depot_put(cache, tls->prev);
+    pthread_mutex_unlock(&cache->lock);
+    if (!tmp)
+        tmp = mag_new();
+    if (!tmp)
+        abort();
+
+    tls->prev = tls->loaded;
+    tls->loaded = tmp;
+    tls->loaded->obj[tls->loaded->count++] = obj;
+}
+
+void slab_destroy(slab_cache *cache)
+{
+    slab_mag *mag = NULL;
+    slab_chunk *chunk = NULL;
+    slab_tls *tls = NULL;
+
+    // key 를 먼저 지워 이후 스레드 종료 때 destructor 가 돌지 않게 함
+    pthread_key_delete(cache->key);
+
+    while ((tls = cache->tls))
+    {
+        cache->tls = tls->next;
+        free(tls->loaded);
+        free(tls->prev);
+        free(tls);
+    }
+    while ((mag = take(&cache->full)))
+        free(mag);
+    while ((mag = take(&cache->empty)))
+        free(mag);
+    while ((chunk = cache->chunks))
+    {
+        cache->chunks = chunk->next;
+        free(chunk);
+    }
+    pthread_mutex_destroy(&cache->lock);
+}
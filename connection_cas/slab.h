@@ -0,0 +1,52 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+// 고정 크기 객체 할당기 (magazine 방식)
+// 스레드마다 magazine 2개(loaded, prev)를 들고 락 없이 할당/해제,
+// 둘 다 비거나 차면 전역 depot 과 magazine 단위로 교환 (락 1회에 SLAB_MAG_SIZE 개),
+// depot 도 비면 객체 SLAB_MAG_SIZE 개짜리 chunk 를 한 번에 malloc 해서 채움.
+// 객체 메모리는 slab_destroy 전까지 malloc 으로 돌려주지 않음
+
+#define SLAB_MAG_SIZE 32
+
+typedef struct slab_mag
+{
+    struct slab_mag *next;              // depot 목록 연결
+    int              count;
+    void            *obj[SLAB_MAG_SIZE];
+} slab_mag;
+
+typedef struct slab_tls
+{
+    struct slab_cache *cache;
+    slab_mag          *loaded;
+    slab_mag          *prev;
+    struct slab_tls   *next;            // cache 의 전체 tls 목록 (destroy 용)
+} slab_tls;
+
+typedef struct slab_chunk
+{
+    struct slab_chunk *next;
+} slab_chunk;
+
+typedef struct slab_cache
+{
+    size_t          obj_size;           // 16 바이트 정렬로 올림
+    pthread_key_t   key;                // 스레드별 slab_tls (종료 시 magazine 반납)
+    pthread_mutex_t lock;               // 아래 depot 필드 보호
+    slab_mag       *full;               // 객체가 하나 이상 든 magazine
+    slab_mag       *empty;              // 빈 magazine
+    slab_chunk     *chunks;             // 지금까지 받은 객체 블록
+    slab_tls       *tls;
+    long            nchunk;
+} slab_cache;
+
+int   slab_init(slab_cache *cache, size_t obj_size);
+void *slab_alloc(slab_cache *cache);                  // 메모리 부족 시 NULL
+void  slab_free(slab_cache *cache, void *obj);        // 다른 스레드가 할당한 객체도 가능
+void  slab_destroy(slab_cache *cache);                // 모든 객체 해제 (사용 중인 스레드가 없을 때만)
+
+#endif // SLAB_H
@@ -0,0 +1,377 @@
+#include "spill.h"
+#include "thread_safe_queue.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define REC_ALIGN(x)  (((x) + 7) & ~(uint64_t)7)
+#define CHECKPOINT    "checkpoint"
+
+// FNV-1a (길이도 섞어서 0 으로 채워진 칸이 맞는 기록처럼 보이지 않게)
+static uint32_t rec_sum(const char *p, uint32_t len)
+{
+    uint32_t h = 2166136261u ^ len;
+
+    for (uint32_t i = 0; i < len; i++)
+        h = (h ^ (unsigned char)p[i]) * 16777619u;
+    return h ? h : 1;
+}
+
+static void seg_path(const spill_journal *j, uint64_t seq, char *out, size_t cap)
+{
+    snprintf(out, cap, "%s/%016" PRIx64 ".spill", j->dir, seq);
+}
+
+// ─── checkpoint: "seq off\n" 를 tmp 에 쓰고 rename (원자적 교체) ──────────
+
+static int checkpoint_load(spill_journal *j, spill_pos *pos)
+{
+    char path[300];
+    FILE *fp = NULL;
+    int rc = FAIL;
+
+    snprintf(path, sizeof(path), "%s/" CHECKPOINT, j->dir);
+    fp = fopen(path, "r");
+    if (fp == NULL)
+        return FAIL;
+    if (fscanf(fp, "%" SCNu64 " %" SCNu64, &pos->seq, &pos->off) == 2)
+        rc = SUCCESS;
+    fclose(fp);
+    return rc;
+}
+
+static int checkpoint_store(spill_journal *j, const spill_pos *pos)
+{
+    char path[300], tmp[310], line[64];
+    int fd, len, rc = FAIL;
+
+    snprintf(path, sizeof(path), "%s/" CHECKPOINT, j->dir);
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return FAIL;
+    len = snprintf(line, sizeof(line), "%" PRIu64 " %" PRIu64 "\n", pos->seq, pos->off);
+    if (write(fd, line, len) == len && fdatasync(fd) == 0)
+        rc = SUCCESS;
+    close(fd);
+    if (rc == SUCCESS && rename(tmp, path) != 0)
+        rc = FAIL;
+    return rc;
+}
+
+// ─── 세그먼트 ──────────────────────────────────────────────────
+
+// 디렉터리의 세그먼트 번호 범위. 없으면 FAIL
+static int seg_scan(spill_journal *j, uint64_t *lo, uint64_t *hi)
+{
+    DIR *d = opendir(j->dir);
+    struct dirent *e = NULL;
+    int found = FALSE;
+
+    if (d == NULL)
+        return FAIL;
+    while ((e = readdir(d)) != NULL)
+    {
+        uint64_t seq;
+        char tail[8];
+        if (sscanf(e->d_name, "%16" SCNx64 "%7s", &seq, tail) != 2 || strcmp(tail, ".spill") != 0)
+            continue;
+        if (!found || seq < *lo)
+            *lo = seq;
+        if (!found || seq > *hi)
+            *hi = seq;
+        found = TRUE;
+    }
+    closedir(d);
+    return found ? SUCCESS : FAIL;
+}
+
+// 새 세그먼트를 만들어 쓰기 위치로 (lock 안). 이전 세그먼트는 retired 로 넘겨 sync 를 기다림
+static int seg_rotate(spill_journal *j)
+{
+    char path[300];
+    uint64_t seq = j->wfd >= 0 ? j->wpos.seq + 1 : j->wpos.seq;
+    int fd;
+    char *map = NULL;
+
+    seg_path(j, seq, path, sizeof(path));
+    fd = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return FAIL;
+    if (ftruncate(fd, (off_t)j->seg_size) != 0 ||
+        (map = mmap(NULL, j->seg_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+    {
+        close(fd);
+        unlink(path);
+        return FAIL;
+    }
+
+    if (j->wfd >= 0)
+    {
+        munmap(j->wmap, j->seg_size);
+        if (j->retired_fd >= 0)
+        {
+            // sync 사이에 두 번 넘어감 (드묾): 먼저 것은 여기서 마무리
+            fdatasync(j->retired_fd);
+            close(j->retired_fd);
+        }
+        j->retired_fd = j->wfd;
+    }
+    j->wfd = fd;
+    j->wmap = map;
+    j->wpos.seq = seq;
+    j->wpos.off = 0;
+    return SUCCESS;
+}
+
+static void rseg_unmap(spill_journal *j)
+{
+    if (j->rmap != NULL)
+        munmap(j->rmap, j->seg_size);
+    if (j->rfd >= 0)
+        close(j->rfd);
+    j->rmap = NULL;
+    j->rfd = -1;
+}
+
+// 읽을 세그먼트를 mmap. 파일이 없으면 FAIL
+static int rseg_map(spill_journal *j, uint64_t seq)
+{
+    char path[300];
+
+    if (j->rmap != NULL && j->rmap_seq == seq)
+        return SUCCESS;
+    rseg_unmap(j);
+    seg_path(j, seq, path, sizeof(path));
+    j->rfd = open(path, O_RDONLY | O_CLOEXEC);
+    if (j->rfd < 0)
+        return FAIL;
+    j->rmap = mmap(NULL, j->seg_size, PROT_READ, MAP_SHARED, j->rfd, 0);
+    if (j->rmap == MAP_FAILED)
+    {
+        j->rmap = NULL;
+        rseg_unmap(j);
+        return FAIL;
+    }
+    j->rmap_seq = seq;
+    return SUCCESS;
+}
+
+static spill_pos wpos_snapshot(spill_journal *j)
+{
+    spill_pos w;
+
+    cas_lock_acquire(&j->lock);
+    w = j->wpos;
+    cas_lock_release(&j->lock);
+    return w;
+}
+
+// ─── 공개 API ──────────────────────────────────────────────────
+
+int spill_open(spill_journal *j, const char *dir, size_t seg_size)
+{
+    uint64_t lo = 0, hi = 0;
+
+    memset(j, 0, sizeof(*j));
+    if (strlen(dir) >= sizeof(j->dir) || seg_size < 4096)
+        return FAIL;
+    strcpy(j->dir, dir);
+    j->seg_size = seg_size & ~(size_t)7;
+    j->wfd = j->rfd = j->retired_fd = -1;
+    cas_lock_init(&j->lock, LOCK_ADAPTIVE);
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST)
+        return FAIL;
+
+    // 쓰기는 늘 새 세그먼트부터 (이전 실행이 남긴 꼬리 위에 덮어쓰지 않음)
+    if (seg_scan(j, &lo, &hi) == SUCCESS)
+    {
+        j->wpos.seq = hi + 1;
+        if (checkpoint_load(j, &j->cpos) != SUCCESS || j->cpos.seq < lo)
+        {
+            j->cpos.seq = lo;
+            j->cpos.off = 0;
+        }
+    }
+    else
+    {
+        // 남은 세그먼트 없음: 번호만 이어 감
+        j->wpos.seq = checkpoint_load(j, &j->cpos) == SUCCESS ? j->cpos.seq + 1 : 1;
+        j->cpos = j->wpos;
+    }
+    if (j->cpos.seq > j->wpos.seq)
+        j->cpos = j->wpos;
+    j->rpos = j->cpos;
+    return SUCCESS;
+}
+
+void spill_close(spill_journal *j)
+{
+    spill_sync(j);
+    rseg_unmap(j);
+    if (j->wfd >= 0)
+    {
+        munmap(j->wmap, j->seg_size);
+        close(j->wfd);
+    }
+    j->wfd = -1;
+    j->wmap = NULL;
+}
+
+int spill_appendv(spill_journal *j, const struct iovec *iov, int iovcnt)
+{
+    uint64_t len = 0, total;
+    int i;
+
+    for (i = 0; i < iovcnt; i++)
+        len += iov[i].iov_len;
+    total = REC_ALIGN(SPILL_REC_HDR + len);
+    if (len == 0 || total > j->seg_size)
+        return FAIL;
+
+    cas_lock_acquire(&j->lock);
+    if (j->wfd < 0 || j->wpos.off + total > j->seg_size)
+    {
+        if (seg_rotate(j) != SUCCESS)
+        {
+            cas_lock_release(&j->lock);
+            return FAIL;
+        }
+    }
+    char *rec = j->wmap + j->wpos.off;
+    char *p = rec + SPILL_REC_HDR;
+    uint32_t len32 = (uint32_t)len;
+    uint32_t sum = 0;
+
+    for (i = 0; i < iovcnt; i++)
+    {
+        memcpy(p, iov[i].iov_base, iov[i].iov_len);
+        p += iov[i].iov_len;
+    }
+    sum = rec_sum(rec + SPILL_REC_HDR, len32);
+    memcpy(rec + 4, &sum, 4);
+    memcpy(rec, &len32, 4);
+    j->wpos.off += total;
+    cas_lock_release(&j->lock);
+    atomic_fetch_add_explicit(&j->appended, 1, memory_order_relaxed);
+    return SUCCESS;
+}
+
+int spill_append(spill_journal *j, const void *data, size_t len)
+{
+    struct iovec iov = { (void *)data, len };
+    return spill_appendv(j, &iov, 1);
+}
+
+int spill_sync(spill_journal *j)
+{
+    int cur = -1, old = -1, rc = SUCCESS;
+
+    // fdatasync 는 디스크 시간만큼 걸리므로 fd 만 챙겨서 락 밖에서
+    cas_lock_acquire(&j->lock);
+    if (j->wfd >= 0)
+        cur = dup(j->wfd);
+    old = j->retired_fd;
+    j->retired_fd = -1;
+    cas_lock_release(&j->lock);
+
+    if (old >= 0)
+    {
+        if (fdatasync(old) != 0)
+            rc = FAIL;
+        close(old);
+    }
+    if (cur >= 0)
+    {
+        if (fdatasync(cur) != 0)
+            rc = FAIL;
+        close(cur);
+    }
+    return rc;
+}
+
+int spill_pending(spill_journal *j)
+{
+    spill_pos w = wpos_snapshot(j);
+    return j->rpos.seq < w.seq || (j->rpos.seq == w.seq && j->rpos.off < w.off);
+}
+
+ssize_t spill_read(spill_journal *j, void *buf, size_t cap)
+{
+    spill_pos w = wpos_snapshot(j);
+
+    while (j->rpos.seq < w.seq || (j->rpos.seq == w.seq && j->rpos.off < w.off))
+    {
+        uint32_t len = 0, sum = 0;
+        int sealed = j->rpos.seq < w.seq;     // 쓰기가 이미 떠난 세그먼트
+
+        if (rseg_map(j, j->rpos.seq) != SUCCESS)
+        {
+            if (!sealed)
+                return 0;       // 쓰는 쪽이 아직 파일을 안 만듦
+            j->rpos.seq++;      // 지워진 세그먼트
+            j->rpos.off = 0;
+            continue;
+        }
+        if (j->rpos.off + SPILL_REC_HDR <= j->seg_size)
+        {
+            memcpy(&len, j->rmap + j->rpos.off, 4);
+            memcpy(&sum, j->rmap + j->rpos.off + 4, 4);
+        }
+        // 끝 표시(0) 이거나, 죽기 전에 반쯤 쓰인 기록 → 이 세그먼트는 여기까지
+        if (len == 0 || j->rpos.off + REC_ALIGN(SPILL_REC_HDR + len) > j->seg_size ||
+            rec_sum(j->rmap + j->rpos.off + SPILL_REC_HDR, len) != sum)
+        {
+            if (!sealed)
+                return 0;
+            j->rpos.seq++;
+            j->rpos.off = 0;
+            continue;
+        }
+
+        const char *body = j->rmap + j->rpos.off + SPILL_REC_HDR;
+        j->rpos.off += REC_ALIGN(SPILL_REC_HDR + len);
+        j->nread++;
+        if (len > cap)
+            return -1;
+        memcpy(buf, body, len);
+        return len;
+    }
+    return 0;
+}
+
+int spill_commit(spill_journal *j)
+{
+    char path[300];
+    uint64_t seq;
+
+    if (j->nread == 0 && j->rpos.seq == j->cpos.seq && j->rpos.off == j->cpos.off)
+        return SUCCESS;
+    if (checkpoint_store(j, &j->rpos) != SUCCESS)
+        return FAIL;
+    // 다 읽은 세그먼트 삭제 (쓰는 쪽은 rpos.seq 이상에만 있음)
+    for (seq = j->cpos.seq; seq < j->rpos.seq; seq++)
+    {
+        if (j->rmap != NULL && j->rmap_seq == seq)
+            rseg_unmap(j);
+        seg_path(j, seq, path, sizeof(path));
+        unlink(path);
+    }
+    atomic_fetch_add_explicit(&j->replayed, j->nread, memory_order_relaxed);
+    j->nread = 0;
+    j->cpos = j->rpos;
+    return SUCCESS;
+}
+
+void spill_rewind(spill_journal *j)
+{
+    j->rpos = j->cpos;
+    j->nread = 0;
+}
@@ -0,0 +1,65 @@
+#ifndef SPILL_H
+#define SPILL_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "cas_lock.h"
+
+// 디스크 spill 저널: DB 가 느리거나 죽었을 때 메시지를 버리지 않고 디스크로 흘려 둠
+//   디렉터리 안에 고정 크기 세그먼트 파일(<seq 16 자리 hex>.spill) 을 차례로 만들고 mmap 해서
+//   뒤에 붙이기만 함. 세그먼트는 ftruncate 로 0 이 채워진 채 시작 → 길이 0 = 세그먼트 끝
+//   기록 = [len u32][checksum u32][본문], 8 바이트 정렬. 죽은 뒤 반쯤 쓰인 기록은
+//   checksum 으로 걸러 그 세그먼트의 끝으로 봄. 다시 열면 쓰기는 항상 새 세그먼트부터
+//   읽기(재생)는 스레드 하나: spill_read 로 꺼내 DB 에 쓰고, 성공하면 spill_commit 이 위치를
+//   checkpoint 파일에 남기고 다 읽은 세그먼트를 지움. 실패하면 spill_rewind 로 되돌려 다시 읽음
+//   → 최소 한 번 전달 (commit 전에 죽으면 다시 열 때 마지막 checkpoint 부터 재생)
+//   spill_append 는 여러 스레드가 불러도 됨 (ADAPTIVE 락, 평소엔 memcpy 만. 세그먼트를 바꿀 때만 syscall)
+
+#define SPILL_SEG_SIZE   (64u << 20)    // 기본 세그먼트 크기
+#define SPILL_REC_HDR    8
+
+typedef struct
+{
+    uint64_t seq;       // 세그먼트 번호
+    uint64_t off;       // 세그먼트 안 바이트 위치
+} spill_pos;
+
+typedef struct
+{
+    char      dir[256];
+    size_t    seg_size;
+    cas_lock  lock;         // 쓰기 쪽 (wfd/wmap/wpos/retired_fd)
+    // 쓰기
+    int       wfd;          // -1 = 아직 세그먼트 없음 (첫 append 때 만듦)
+    char     *wmap;
+    spill_pos wpos;         // 다음 기록을 쓸 위치. 이 앞의 기록은 완성돼 있음
+    int       retired_fd;   // 다 채우고 넘어간 세그먼트 (다음 spill_sync 가 fdatasync 후 닫음)
+    // 읽기 (재생 스레드만)
+    int       rfd;
+    char     *rmap;
+    uint64_t  rmap_seq;
+    spill_pos rpos;         // 다음에 읽을 기록
+    spill_pos cpos;         // 마지막 checkpoint (rewind 지점)
+    long      nread;        // cpos 이후 읽은 기록 수
+    // 통계
+    atomic_long appended;
+    atomic_long replayed;   // commit 된 기록
+} spill_journal;
+
+int     spill_open(spill_journal *j, const char *dir, size_t seg_size);   // 디렉터리가 없으면 만듦
+void    spill_close(spill_journal *j);
+
+// 기록 하나 (iov 를 이어 붙여서). 비었거나 세그먼트보다 크거나 파일을 못 만들면 FAIL
+int     spill_appendv(spill_journal *j, const struct iovec *iov, int iovcnt);
+int     spill_append(spill_journal *j, const void *data, size_t len);
+int     spill_sync(spill_journal *j);          // 지금까지 쓴 기록을 디스크로 (fdatasync, 락 밖에서)
+
+int     spill_pending(spill_journal *j);       // 안 읽은 기록이 있으면 TRUE (재생 스레드)
+ssize_t spill_read(spill_journal *j, void *buf, size_t cap);  // 본문 길이, 0 = 없음, -1 = cap 부족 (그 기록은 건너뜀)
+int     spill_commit(spill_journal *j);        // 읽은 데까지 소비 확정
+void    spill_rewind(spill_journal *j);        // 마지막 commit 위치로 되돌림
+
+#endif // SPILL_H
@@ -1,8 +1,10 @@
 #include "thread_safe_queue.h"
+#include "ebr.h"
 
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <stdio.h>
-#include <unistd.h>
+#include <time.h>
 
 // ─── wait_que ───────────────────────────────────────────────
 
@@ -47,6 +49,39 @@ int enque(wait_que *q)
     return conn_index;
 }
 
+// 깨우기를 놓친 대기자가 영원히 자지 않도록 시간 제한을 둔 enque.
+// 시간 초과로 떠난 자리는 이후 deque 가 빈 신호로 소비함
+int enque_timed(wait_que *q, long timeout_ms)
+{
+    int index = 0;
+    int rc = 0;
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec  += timeout_ms / 1000;
+    ts.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if(ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&q->mutex);
+    if(q->count == MAX_QUE_SIZE)
+    {
+        pthread_mutex_unlock(&q->mutex);
+        return FAIL;
+    }
+
+    index = q->rear;
+    q->rear = (q->rear + 1) % MAX_QUE_SIZE;
+    q->count++;
+    rc = pthread_cond_timedwait(&q->que_cond[index], &q->mutex, &ts);
+    pthread_mutex_unlock(&q->mutex);
+
+    return rc == 0 ? SUCCESS : FAIL;
+}
+
 int deque(wait_que *q)
 {
     int index = 0;
@@ -66,187 +101,416 @@ int deque(wait_que *q)
 }
 
 // ─── hash_map ───────────────────────────────────────────────
+// open addressing + 선형 탐사. 키/값은 슬롯에 인라인 → insert 마다 malloc 없음.
+// 쓰기는 맵 락으로 직렬화하고, 읽기는 락 없이 슬롯 그룹의 시퀀스로 검증 (seqlock):
+// 쓰기는 seq 를 홀수로 올린 뒤 슬롯을 고치고 짝수로 공개, 읽기는 앞뒤 seq 가 같은 짝수일 때만 채택.
+// 한 번에 쓰는 쓰기는 하나뿐이라 읽기는 대기 없이 그 그룹만 다시 읽음.
+// fence 대신 슬롯 필드를 release 로 쓰고 acquire 로 읽어 순서를 잡음 (x86 에서는 일반 mov, TSan 도 이해함)
+// 리사이즈는 새 테이블을 붙여 두고 쓰기마다 HASH_MIGRATE_STEP 슬롯씩 옮김.
+// 다 옮긴 옛 테이블은 ebr_retire → 그 테이블을 보던 hash_get 이 모두 빠진 뒤 해제
 
-void hash_init(hash_map *map)
+static hash_table *table_alloc(unsigned long size)
 {
-    int i = 0;
-    for (i = 0; i < MAX_HASH_SIZE; i++)
+    unsigned long groups = (size + (1UL << HASH_SEQ_SHIFT) - 1) >> HASH_SEQ_SHIFT;
+    hash_table *t = calloc(1, sizeof(hash_table) + size * sizeof(hash_slot)
+                              + groups * sizeof(atomic_uint));
+    if (!t) return NULL;
+    t->mask = size - 1;
+    t->seq = (atomic_uint *)&t->slot[size];
+    return t;
+}
+
+// 쓰기 락 하에서 읽는 필드: 바꾸는 쪽이 자기 자신뿐이라 relaxed 로 충분
+static int slot_state(hash_slot *slot)
+{
+    return atomic_load_explicit(&slot->state, memory_order_relaxed);
+}
+
+static hash_table *cur_table(hash_map *map)
+{
+    return atomic_load_explicit(&map->table, memory_order_relaxed);
+}
+
+static hash_table *next_table(hash_table *t)
+{
+    return atomic_load_explicit(&t->next_table, memory_order_relaxed);
+}
+
+// 쓰기 락 하에서: 슬롯 i 가 속한 그룹을 고치는 동안 seq 를 홀수로 유지.
+// 뒤따르는 슬롯 쓰기가 release 라서 홀수 seq 가 그보다 먼저 보임
+static void seq_write_begin(hash_table *t, unsigned long i)
+{
+    atomic_uint *seq = &t->seq[i >> HASH_SEQ_SHIFT];
+    atomic_store_explicit(seq, atomic_load_explicit(seq, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+}
+
+static void seq_write_end(hash_table *t, unsigned long i)
+{
+    atomic_uint *seq = &t->seq[i >> HASH_SEQ_SHIFT];
+    atomic_store_explicit(seq, atomic_load_explicit(seq, memory_order_relaxed) + 1,
+                          memory_order_release);
+}
+
+// 슬롯 i 의 (key, value, state) 를 한 시점의 값으로 읽음
+static int read_slot(hash_table *t, unsigned long i, unsigned long *key, int *value)
+{
+    atomic_uint *seq = &t->seq[i >> HASH_SEQ_SHIFT];
+    hash_slot *slot = &t->slot[i];
+    unsigned int s1, s2;
+    int state;
+
+    do
     {
-        map->bucket[i] = NULL;
-        map->bucket_use[i] = FALSE;
-    }
-    map->que_start = NULL;
-    map->que_end = NULL;
+        s1 = atomic_load_explicit(seq, memory_order_acquire);
+        // acquire 읽기 → 두 번째 seq 읽기가 슬롯 읽기보다 앞당겨지지 않음.
+        // 쓰는 중인 값을 봤다면 그 release 쓰기와 동기화되어 s2 는 홀수 이후 값
+        state  = atomic_load_explicit(&slot->state, memory_order_acquire);
+        *key   = atomic_load_explicit(&slot->key, memory_order_acquire);
+        *value = atomic_load_explicit(&slot->value, memory_order_acquire);
+        s2 = atomic_load_explicit(seq, memory_order_relaxed);
+    } while ((s1 & 1) || s1 != s2);
+    return state;
+}
+
+// 쓰기 락 하에서: 슬롯 상태/값 변경을 seq 로 감싸 공개
+static void slot_set(hash_table *t, hash_slot *slot, int state, int value)
+{
+    unsigned long i = (unsigned long)(slot - t->slot);
+    seq_write_begin(t, i);
+    atomic_store_explicit(&slot->value, value, memory_order_release);
+    atomic_store_explicit(&slot->state, state, memory_order_release);
+    seq_write_end(t, i);
+}
+
+int hash_init(hash_map *map)
+{
+    return hash_init_lock(map, HASH_LOCK_KIND);
+}
+
+int hash_init_lock(hash_map *map, int lock_kind)
+{
+    hash_table *t = table_alloc(HASH_INIT_SIZE);
+    atomic_init(&map->table, t);
+    atomic_init(&map->deleted, 0);
+    map->migrate_pos = 0;
+    cas_lock_init(&map->lock, lock_kind);
+    return t ? SUCCESS : FAIL;
 }
 
-static int get_lock(hash_map *map, int index)
+static int get_lock(hash_map *map)
 {
-    while (!__sync_bool_compare_and_swap(&map->bucket_use[index], FALSE, TRUE));
+    cas_lock_acquire(&map->lock);
     return SUCCESS;
 }
 
-static int release_lock(hash_map *map, int index)
+static int release_lock(hash_map *map)
 {
-    map->bucket_use[index] = FALSE;
+    cas_lock_release(&map->lock);
     return SUCCESS;
 }
 
-unsigned int hash(unsigned long tid)
+// pthread_t 는 정렬된 포인터라 하위 비트가 거의 같음 → 모든 비트를 섞음 (splitmix64 finalizer)
+unsigned long hash(unsigned long key)
 {
-    return tid % MAX_HASH_SIZE;
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9UL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebUL;
+    key ^= key >> 31;
+    return key;
 }
 
-int hash_insert(hash_map *map, unsigned long tid, int value)
+// 테이블 t 에서 key 를 가진 슬롯 탐색. EMPTY 에 닿으면 NULL. 찾으면 그 시점의 state/value 반환
+static hash_slot *probe(hash_table *t, unsigned long key, int *state, int *value)
+{
+    unsigned long i = hash(key) & t->mask;
+    unsigned long n = 0;
+    for (n = 0; n <= t->mask; n++, i = (i + 1) & t->mask)
+    {
+        unsigned long k;
+        int v;
+        int st = read_slot(t, i, &k, &v);
+        if (st == SLOT_EMPTY)
+            return NULL;
+        if (st != SLOT_TOMB && k == key)
+        {
+            *state = st;
+            *value = v;
+            return &t->slot[i];
+        }
+    }
+    return NULL;
+}
+
+// 쓰기 락 하에서: 중복 없음이 확인된 key 를 첫 EMPTY 슬롯에 기록
+static void place(hash_table *t, unsigned long key, int value, int state)
 {
-    int index = hash(tid);
+    unsigned long i = hash(key) & t->mask;
+    while (slot_state(&t->slot[i]) != SLOT_EMPTY)
+        i = (i + 1) & t->mask;
 
-    entry_st *new_entry = (entry_st *)malloc(sizeof(entry_st));
-    if (!new_entry) return FAIL;
+    seq_write_begin(t, i);
+    atomic_store_explicit(&t->slot[i].key, key, memory_order_release);
+    atomic_store_explicit(&t->slot[i].value, value, memory_order_release);
+    atomic_store_explicit(&t->slot[i].state, state, memory_order_release);
+    seq_write_end(t, i);
+    t->used++;
+}
 
-    new_entry->key = tid;
-    new_entry->value = value;
-    new_entry->next = NULL;
-    new_entry->next_trash = NULL;
-    new_entry->delete_flag = FALSE;
+// 쓰기 락 하에서: 옛 테이블 슬롯을 steps 개까지 새 테이블로 이동.
+// 새 슬롯을 먼저 공개한 뒤 옛 슬롯을 MOVED 로 바꾸므로 읽기는 어느 쪽에서든 항목을 찾음
+static void migrate(hash_map *map, unsigned long steps)
+{
+    hash_table *old = cur_table(map);
+    hash_table *nt = next_table(old);
+    if (!nt)
+        return;
 
-    get_lock(map, index);
-    entry_st *entry = map->bucket[index];
-    if (entry == NULL)
+    while (steps-- > 0 && map->migrate_pos <= old->mask)
     {
-        map->bucket[index] = new_entry;
-        release_lock(map, index);
-        return SUCCESS;
+        hash_slot *slot = &old->slot[map->migrate_pos++];
+        int state = slot_state(slot);
+        int value = atomic_load_explicit(&slot->value, memory_order_relaxed);
+        if (state != SLOT_LIVE && state != SLOT_DELETED)
+            continue;   // TOMB 는 여기서 사라짐
+        place(nt, atomic_load_explicit(&slot->key, memory_order_relaxed), value, state);
+        slot_set(old, slot, SLOT_MOVED, value);
     }
 
-    while(entry)
+    if (map->migrate_pos > old->mask)
     {
-        if(entry->key == new_entry->key)
-        {
-            // 살아있는 노드: 값 갱신
-            // 삭제된 노드: delete_flag 해제 후 재활용
-            entry->value = value;
-            entry->delete_flag = FALSE;
-            free(new_entry);
-            release_lock(map, index);
-            return SUCCESS;
-        }
-        else if (entry->next == NULL)
-        {
-            entry->next = new_entry;
-            release_lock(map, index);
-            return SUCCESS;
-        }
-        entry = entry->next;
+        // 옛 테이블은 next_table 을 유지한 채 retire → 아직 보는 읽기는 MOVED 를 따라감.
+        // 교체 후 epoch 검사(ebr)와 store→load 순서가 필요해 seq_cst
+        atomic_store_explicit(&map->table, nt, memory_order_seq_cst);
+        map->migrate_pos = 0;
+        ebr_retire(old, free);
     }
-    release_lock(map, index);
-    return FAIL;
 }
 
-int hash_get(hash_map *map, unsigned long tid)
+// 쓰기 락 하에서: 살아있는 항목 수에 맞춰 새 테이블을 붙임 (TOMB 만 많으면 같은 크기로 재구축)
+static int start_resize(hash_map *map)
 {
-    int index = hash(tid);
-    entry_st *entry = map->bucket[index];
-    while (entry)
+    hash_table *t = cur_table(map);
+    unsigned long count = 0;
+    unsigned long size = HASH_INIT_SIZE;
+    unsigned long i = 0;
+
+    for (i = 0; i <= t->mask; i++)
     {
-        if (tid == entry->key && !entry->delete_flag)
-            return entry->value;
-        entry = entry->next;
+        int state = slot_state(&t->slot[i]);
+        if (state == SLOT_LIVE || state == SLOT_DELETED)
+            count++;
     }
-    return FAIL;
+    while (size < (count + 1) * 2)
+        size <<= 1;
+
+    hash_table *nt = table_alloc(size);
+    if (!nt)
+        return FAIL;
+    // 새 테이블의 빈 슬롯(calloc)이 next_table 을 따라온 읽기에게 보이도록 release
+    atomic_store_explicit(&t->next_table, nt, memory_order_release);
+    map->migrate_pos = 0;
+    return SUCCESS;
 }
 
-int hash_delete_soft(hash_map *map, unsigned long tid)
+static int overloaded(hash_table *t)
+{
+    return (t->used + 1) * 4 > (t->mask + 1) * 3;
+}
+
+int hash_insert(hash_map *map, unsigned long tid, int value)
 {
-    int index = hash(tid);
-    entry_st *entry = map->bucket[index];
-    while (entry)
+    hash_table *t = NULL;
+    hash_slot *slot = NULL;
+    int state = 0;
+    int old_value = 0;
+
+    get_lock(map);
+    migrate(map, HASH_MIGRATE_STEP);
+
+    // 이미 있는 키 (옛 테이블이든 새 테이블이든): 값 갱신
+    for (t = cur_table(map); t; t = next_table(t))
+    {
+        slot = probe(t, tid, &state, &old_value);
+        if (!slot || state == SLOT_MOVED)
+            continue;
+
+        // 살아있는 노드: 값 갱신
+        // 삭제된 노드: state 를 LIVE 로 되돌려 재활용 (값과 함께 한 번에 공개)
+        slot_set(t, slot, SLOT_LIVE, value);
+        if (state == SLOT_DELETED)
+            atomic_fetch_sub_explicit(&map->deleted, 1, memory_order_relaxed);
+        release_lock(map);
+        return SUCCESS;
+    }
+
+    // 새 키: 리사이즈 중이면 새 테이블에
+    t = cur_table(map);
+    if (next_table(t))
+        t = next_table(t);
+    if (overloaded(t))
     {
-        if (tid == entry->key)
+        migrate(map, (unsigned long)-1);    // 진행 중인 이동을 끝내고 다시 판단
+        t = cur_table(map);
+        if (overloaded(t))
         {
-            __sync_bool_compare_and_swap(&entry->delete_flag, FALSE, TRUE);
-            return SUCCESS;
+            if (start_resize(map) == SUCCESS)
+                t = next_table(t);
+            else if (t->used == t->mask)    // 빈 슬롯이 하나는 남아야 탐사가 끝남
+            {
+                release_lock(map);
+                return FAIL;
+            }
         }
-        entry = entry->next;
     }
-    return FAIL;
+    place(t, tid, value, SLOT_LIVE);
+    release_lock(map);
+    return SUCCESS;
 }
 
-static void insert_trash(hash_map *map, entry_st *entry)
+int hash_get(hash_map *map, unsigned long tid)
 {
-    if(map->que_start)
-    {
-        map->que_end->next_trash = entry;
-        map->que_end = entry;
-    }
-    else
+    int value = FAIL;
+    hash_table *t = NULL;
+
+    // 이 구간에서 본 테이블은 retire 되더라도 해제되지 않음 (ebr_enter 의 epoch 공표와 짝으로 seq_cst)
+    ebr_enter();
+    t = atomic_load_explicit(&map->table, memory_order_seq_cst);
+    while (t)
     {
-        map->que_start = entry;
-        map->que_end = entry;
+        int state = 0;
+        int v = 0;
+        hash_slot *slot = probe(t, tid, &state, &v);
+        if (slot && state == SLOT_LIVE)
+        {
+            value = v;
+            break;
+        }
+        if (slot && state == SLOT_DELETED)
+            break;
+        // 없음 또는 MOVED: 리사이즈 중이면 새 테이블에서 다시
+        t = atomic_load_explicit(&t->next_table, memory_order_acquire);
     }
+    ebr_exit();
+    return value;
 }
 
-static void clean_trash(hash_map *map)
+int hash_delete_soft(hash_map *map, unsigned long tid)
 {
-    entry_st *entry = map->que_start;
-    entry_st *next = NULL;
-    while(entry)
+    hash_table *t = NULL;
+    int state = 0;
+    int value = 0;
+
+    // 이동 중인 슬롯과 엇갈리지 않도록 쓰기 락 (종료 스레드/테스트에서만 호출)
+    get_lock(map);
+    for (t = cur_table(map); t; t = next_table(t))
     {
-        next = entry->next_trash;
-        free(entry);
-        entry = next;
+        hash_slot *slot = probe(t, tid, &state, &value);
+        if (!slot || state == SLOT_MOVED)
+            continue;
+        if (state == SLOT_LIVE)
+        {
+            slot_set(t, slot, SLOT_DELETED, value);
+            atomic_fetch_add_explicit(&map->deleted, 1, memory_order_relaxed);
+        }
+        release_lock(map);
+        return SUCCESS;
     }
-    map->que_start = NULL;
-    map->que_end = NULL;
+    release_lock(map);
+    return FAIL;
 }
 
 int hash_delete(hash_map *map)
 {
-    entry_st *prev = NULL;
-    int i = 0;
-    for (i = 0; i < MAX_HASH_SIZE; i++)
+    hash_table *t = NULL;
+    unsigned long i = 0;
+    unsigned long tombs = 0;
+
+    get_lock(map);
+    migrate(map, (unsigned long)-1);
+
+    t = cur_table(map);
+    for (i = 0; i <= t->mask; i++)
     {
-        prev = NULL;
-        get_lock(map, i);
-        entry_st *entry = map->bucket[i];
-        while (entry)
+        hash_slot *slot = &t->slot[i];
+        int state = slot_state(slot);
+        if (state == SLOT_DELETED)
         {
-            if (entry->delete_flag)
-            {
-                entry_st *next = entry->next;
-                if (prev)
-                    prev->next = next;
-                else
-                    map->bucket[i] = next;
-                insert_trash(map, entry);
-                entry = next;
-            }
-            else
-            {
-                prev = entry;
-                entry = entry->next;
-            }
+            slot_set(t, slot, SLOT_TOMB, atomic_load_explicit(&slot->value, memory_order_relaxed));
+            atomic_fetch_sub_explicit(&map->deleted, 1, memory_order_relaxed);
+            state = SLOT_TOMB;
         }
-        release_lock(map, i);
+        if (state == SLOT_TOMB)
+            tombs++;
     }
-    sleep(1);
-    clean_trash(map);
+
+    // TOMB 가 1/4 을 넘으면 재구축해 탐사 길이를 되돌림 (GC 스레드에서 한 번에)
+    if (tombs * 4 > t->mask + 1 && start_resize(map) == SUCCESS)
+        migrate(map, (unsigned long)-1);
+    release_lock(map);
+
+    // 읽기를 기다리며 잠들지 않고, 이미 안전해진 옛 테이블만 해제
+    ebr_collect();
     return SUCCESS;
 }
 
 int hash_get_all(hash_map *map)
 {
-    int i = 0;
-    for (i = 0; i < MAX_HASH_SIZE; i++)
+    hash_table *t = NULL;
+    unsigned long i = 0;
+
+    get_lock(map);
+    for (t = cur_table(map); t; t = next_table(t))
     {
-        get_lock(map, i);
-        entry_st *entry = map->bucket[i];
-        while (entry)
+        for (i = 0; i <= t->mask; i++)
         {
+            hash_slot *slot = &t->slot[i];
+            int state = slot_state(slot);
+            if (state != SLOT_LIVE && state != SLOT_DELETED)
+                continue;
             printf("hash_get_all: key=%lu value=%d deleted=%d\n",
-                   entry->key, entry->value, entry->delete_flag);
-            entry = entry->next;
+                   atomic_load_explicit(&slot->key, memory_order_relaxed),
+                   atomic_load_explicit(&slot->value, memory_order_relaxed),
+                   state == SLOT_DELETED);
         }
-        release_lock(map, i);
     }
+    release_lock(map);
     return SUCCESS;
 }
+
+int hash_count(hash_map *map, bool with_deleted)
+{
+    hash_table *t = NULL;
+    unsigned long i = 0;
+    int count = 0;
+
+    get_lock(map);
+    for (t = cur_table(map); t; t = next_table(t))
+    {
+        for (i = 0; i <= t->mask; i++)
+        {
+            int state = slot_state(&t->slot[i]);
+            if (state == SLOT_LIVE || (with_deleted && state == SLOT_DELETED))
+                count++;
+        }
+    }
+    release_lock(map);
+    return count;
+}
+
+int hash_deleted(hash_map *map)
+{
+    return atomic_load_explicit(&map->deleted, memory_order_relaxed);
+}
+
+void hash_destroy(hash_map *map)
+{
+    hash_table *t = cur_table(map);
+    if (t)
+    {
+        free(next_table(t));
+        free(t);
+    }
+    atomic_store_explicit(&map->table, NULL, memory_order_relaxed);
+}
@@ -2,8 +2,15 @@
 #define THREAD_SAFE_QUEUE_H
 
 #include <pthread.h>
+#include <stdatomic.h>
+#include "cas_lock.h"
 
-#define MAX_HASH_SIZE   256
+#define HASH_INIT_SIZE   64     // 초기 슬롯 수 (2의 거듭제곱)
+#define HASH_MIGRATE_STEP 32    // 쓰기 1회당 새 테이블로 옮기는 옛 슬롯 수
+#define HASH_SEQ_SHIFT    3     // 슬롯 8개(캐시 라인 2개)마다 시퀀스 카운터 1개
+#ifndef HASH_LOCK_KIND
+#define HASH_LOCK_KIND   LOCK_ADAPTIVE  // hash_init 의 쓰기 락 종류 (enum lock_kind)
+#endif
 #define MAX_QUE_SIZE     10
 #define FAIL             -1
 #define SUCCESS           0
@@ -21,36 +28,58 @@ typedef struct
     int count;
 } wait_que;
 
-typedef struct entry_st
+// 슬롯 상태. 키는 테이블 수명 동안 불변(TOMB 재사용 안 함). 읽기는 락 없이 그룹 seq 로 검증
+enum slot_state
 {
-    unsigned long    key;
-    int              value;
-    int              delete_flag;
-    struct entry_st *next;
-    struct entry_st *next_trash;
-} entry_st;
+    SLOT_EMPTY = 0,     // 한 번도 쓰지 않음: 탐사 종료 지점
+    SLOT_LIVE,
+    SLOT_DELETED,       // soft delete: 같은 키 재insert 시 부활
+    SLOT_TOMB,          // GC 된 자리: 탐사는 계속, 리사이즈 때 사라짐
+    SLOT_MOVED          // 증분 리사이즈로 새 테이블에 옮겨짐
+};
 
+// 키/값을 슬롯에 그대로 담아 캐시 라인 하나에 4개
 typedef struct
 {
-    entry_st *bucket[MAX_HASH_SIZE];
-    bool      bucket_use[MAX_HASH_SIZE];
-    entry_st *que_start;
-    entry_st *que_end;
-} hash_map;
+    atomic_ulong key;
+    atomic_int   value;
+    atomic_int   state;
+} hash_slot;
+
+typedef struct hash_table
+{
+    unsigned long      mask;        // 슬롯 수 - 1
+    unsigned long      used;        // EMPTY 가 아닌 슬롯 수 (LIVE + DELETED + TOMB)
+    _Atomic(struct hash_table *) next_table;  // 리사이즈 대상 (MOVED 슬롯을 만난 읽기가 따라감)
+    atomic_uint       *seq;         // 슬롯 그룹별 시퀀스 (홀수 = 쓰는 중). slot[] 뒤에 같이 할당
+    hash_slot          slot[];
+} hash_table;
 
+typedef struct
+{
+    _Atomic(hash_table *) table;    // 읽기 시작 테이블
+    unsigned long migrate_pos;      // table → table->next_table 이동 진행 위치 (쓰기 락 하에서만)
+    cas_lock      lock;             // 쓰기 직렬화 (읽기는 락 없음)
+    atomic_int    deleted;          // soft delete 후 아직 GC 되지 않은 항목 수
+} hash_map;
 // wait_que
 void queue_init(wait_que *q);
 void queue_destroy(wait_que *q);
 int  enque(wait_que *q);
+int  enque_timed(wait_que *q, long timeout_ms);   // deque 전에 시간이 지나면 FAIL
 int  deque(wait_que *q);
 
-// hash_map
-void         hash_init(hash_map *map);
-unsigned int hash(unsigned long tid);
-int          hash_insert(hash_map *map, unsigned long tid, int value);
-int          hash_get(hash_map *map, unsigned long tid);
-int          hash_delete(hash_map *map);
-int          hash_delete_soft(hash_map *map, unsigned long tid);
-int          hash_get_all(hash_map *map);
+// hash_map (open addressing + 선형 탐사 + 증분 리사이즈)
+int           hash_init(hash_map *map);                   // 쓰기 락 = HASH_LOCK_KIND
+int           hash_init_lock(hash_map *map, int lock_kind);
+unsigned long hash(unsigned long key);
+int           hash_insert(hash_map *map, unsigned long tid, int value);
+int           hash_get(hash_map *map, unsigned long tid);
+int           hash_delete(hash_map *map);
+int           hash_delete_soft(hash_map *map, unsigned long tid);
+int           hash_get_all(hash_map *map);
+int           hash_count(hash_map *map, bool with_deleted);   // 항목 수 (soft delete 포함 여부)
+int           hash_deleted(hash_map *map);                    // GC 대기 중인 soft delete 수
+void          hash_destroy(hash_map *map);   // 모든 테이블 해제 (동시 접근이 없을 때만)
 
 #endif // THREAD_SAFE_QUEUE_H
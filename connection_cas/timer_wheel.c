@@ -0,0 +1,217 @@
+#include "timer_wheel.h"
+#include "thread_safe_queue.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TW_MASK     (TW_SLOTS - 1)
+#define TW_SPAN     (1ull << (TW_BITS * TW_LEVELS))     // 휠이 담을 수 있는 최대 tick 차
+
+static uint64_t mono_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void list_init(tw_timer *head)
+{
+    head->prev = head->next = head;
+}
+
+static void list_unlink(tw_timer *t)
+{
+    t->prev->next = t->next;
+    t->next->prev = t->prev;
+    t->prev = t->next = NULL;
+}
+
+static void list_push(tw_timer *head, tw_timer *t)
+{
+    t->prev = head->prev;
+    t->next = head;
+    head->prev->next = t;
+    head->prev = t;
+}
+
+// expire 까지 남은 tick 수로 단을 고름. 위 단 칸 번호는 expire 의 그 단 자리 비트
+static void wheel_insert(timer_wheel *w, tw_timer *t)
+{
+    uint64_t diff = t->expire - w->now;
+    int level = 0;
+
+    if (diff >= TW_SPAN)
+    {
+        t->expire = w->now + TW_SPAN - 1;
+        diff = TW_SPAN - 1;
+    }
+    while (diff >= (1ull << (TW_BITS * (level + 1))))
+        level++;
+    list_push(&w->slots[level][(t->expire >> (TW_BITS * level)) & TW_MASK], t);
+}
+
+// 위 단 칸 하나를 떼어 아래 단으로 다시 넣음 (콜백은 부르지 않음)
+static void cascade(timer_wheel *w, int level)
+{
+    tw_timer *head = &w->slots[level][(w->now >> (TW_BITS * level)) & TW_MASK];
+    tw_timer moved;
+
+    if (head->next == head)
+        return;
+    moved.prev = head->prev;
+    moved.next = head->next;
+    moved.prev->next = &moved;
+    moved.next->prev = &moved;
+    list_init(head);
+    while (moved.next != &moved)
+    {
+        tw_timer *t = moved.next;
+        list_unlink(t);
+        wheel_insert(w, t);
+    }
+}
+
+static void timerfd_set(timer_wheel *w, int on)
+{
+    struct itimerspec its;
+
+    memset(&its, 0, sizeof(its));
+    if (on)
+    {
+        its.it_interval.tv_sec = w->tick_ms / 1000;
+        its.it_interval.tv_nsec = (long)(w->tick_ms % 1000) * 1000000L;
+        its.it_value = its.it_interval;
+    }
+    if (w->tfd >= 0)
+        timerfd_settime(w->tfd, 0, &its, NULL);
+    w->ticking = on;
+}
+
+int tw_init(timer_wheel *w, unsigned tick_ms, void *ctx)
+{
+    int lv, s;
+
+    if (tick_ms == 0)
+        return FAIL;
+    memset(w, 0, sizeof(*w));
+    for (lv = 0; lv < TW_LEVELS; lv++)
+        for (s = 0; s < TW_SLOTS; s++)
+            list_init(&w->slots[lv][s]);
+    w->tick_ms = tick_ms;
+    w->ctx = ctx;
+    w->origin_ms = mono_ms();
+    w->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    return w->tfd >= 0 ? SUCCESS : FAIL;
+}
+
+void tw_destroy(timer_wheel *w)
+{
+    // 걸린 타이머는 소유자 구조체에 박혀 있으므로 목록만 끊음
+    for (int lv = 0; lv < TW_LEVELS; lv++)
+    {
+        for (int s = 0; s < TW_SLOTS; s++)
+        {
+            tw_timer *head = &w->slots[lv][s];
+            while (head->next != head)
+                list_unlink(head->next);
+        }
+    }
+    w->count = 0;
+    if (w->tfd >= 0)
+        close(w->tfd);
+    w->tfd = -1;
+}
+
+int tw_fd(const timer_wheel *w)
+{
+    return w->tfd;
+}
+
+void tw_timer_init(tw_timer *t, void (*fn)(tw_timer *t, void *ctx))
+{
+    t->prev = t->next = NULL;
+    t->expire = 0;
+    t->fn = fn;
+}
+
+void tw_arm(timer_wheel *w, tw_timer *t, unsigned timeout_ms)
+{
+    uint64_t ticks = (timeout_ms + w->tick_ms - 1) / w->tick_ms;
+    uint64_t now = (mono_ms() - w->origin_ms) / w->tick_ms;
+
+    if (tw_armed(t))
+        list_unlink(t);
+    else
+        w->count++;
+    if (!w->ticking)
+    {
+        // 멈춰 있던 동안의 tick 은 처리할 타이머가 없었으므로 건너뜀
+        if (now > w->now)
+            w->now = now;
+        timerfd_set(w, TRUE);
+    }
+    // 도는 중에도 tw_expire 가 늦어 w->now 가 여러 tick 뒤처질 수 있으므로 실제 시각 기준.
+    // now 는 tick 안에서 내림한 값이라 하나 더 (일찍 만료되지 않음)
+    if (now < w->now)
+        now = w->now;
+    t->expire = now + ticks + 1;
+    wheel_insert(w, t);
+}
+
+void tw_cancel(timer_wheel *w, tw_timer *t)
+{
+    if (!tw_armed(t))
+        return;
+    list_unlink(t);
+    w->count--;
+}
+
+int tw_advance(timer_wheel *w, uint64_t now_ms)
+{
+    uint64_t target = now_ms > w->origin_ms ? (now_ms - w->origin_ms) / w->tick_ms : 0;
+    int fired = 0;
+
+    while (w->now < target)
+    {
+        if (w->count == 0)
+        {
+            w->now = target;    // 걸린 타이머가 없으면 빈 칸을 돌 필요 없음
+            break;
+        }
+        w->now++;
+        // 0 단이 한 바퀴 돌면 위 단 칸을 내림 (그 단도 한 바퀴면 그 위도)
+        for (int lv = 1; lv < TW_LEVELS; lv++)
+        {
+            if ((w->now & ((1ull << (TW_BITS * lv)) - 1)) != 0)
+                break;
+            cascade(w, lv);
+        }
+        tw_timer *head = &w->slots[0][w->now & TW_MASK];
+        while (head->next != head)
+        {
+            // 콜백이 같은 칸의 다른 타이머를 cancel 할 수 있으므로 매번 머리에서 하나씩
+            tw_timer *t = head->next;
+            list_unlink(t);
+            w->count--;
+            t->fn(t, w->ctx);
+            fired++;
+        }
+    }
+    return fired;
+}
+
+int tw_expire(timer_wheel *w)
+{
+    uint64_t ticks;
+    int fired;
+
+    while (read(w->tfd, &ticks, sizeof(ticks)) < 0 && errno == EINTR)
+        ;
+    fired = tw_advance(w, mono_ms());
+    if (w->count == 0 && w->ticking)
+        timerfd_set(w, FALSE);
+    return fired;
+}
@@ -0,0 +1,57 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 계층 타이밍 휠 (연결별 idle / 읽기 마감 시간용). 스레드 하나가 소유 (reactor 마다 하나)
+//   TW_LEVELS 단 × TW_SLOTS 칸. 0 단 한 칸 = tick 하나, 위 단 한 칸 = 아래 단 한 바퀴
+//   타이머는 연결 구조체에 박힌 이중 연결 노드 → arm / 다시 arm / cancel 모두 O(1), 할당 없음
+//   tick 마다 0 단 칸 하나만 보고, 0 단이 한 바퀴 돌 때 위 단 칸 하나를 아래로 내림
+//   → 시간 초과 확인 비용은 연결 수가 아니라 만료되는 타이머 수에 비례
+//   timerfd 하나가 tick 을 알림. 걸린 타이머가 없으면 timerfd 를 멈춰 쉬는 reactor 를 깨우지 않음
+//   시간은 tick 단위: 요청 시간보다 일찍 만료되지 않고, 늦어도 tick 두 개 이내
+
+#define TW_BITS     6
+#define TW_SLOTS    (1 << TW_BITS)
+#define TW_LEVELS   4           // 64^4 tick (tick 100ms 면 약 19 일). 넘으면 최대로 자름
+
+typedef struct tw_timer
+{
+    struct tw_timer *prev;
+    struct tw_timer *next;      // NULL = 걸려 있지 않음
+    uint64_t         expire;    // tick
+    void           (*fn)(struct tw_timer *t, void *ctx);
+} tw_timer;
+
+typedef struct
+{
+    tw_timer  slots[TW_LEVELS][TW_SLOTS];  // 칸마다 원형 리스트의 머리 (sentinel)
+    uint64_t  now;              // 처리를 마친 tick
+    uint64_t  origin_ms;        // tick 0 의 CLOCK_MONOTONIC (ms)
+    unsigned  tick_ms;
+    size_t    count;            // 걸린 타이머 수
+    int       tfd;              // timerfd (non-blocking)
+    int       ticking;          // timerfd 가 돌고 있음
+    void     *ctx;              // 콜백의 두 번째 인자 (보통 reactor)
+} timer_wheel;
+
+int    tw_init(timer_wheel *w, unsigned tick_ms, void *ctx);
+void   tw_destroy(timer_wheel *w);
+int    tw_fd(const timer_wheel *w);     // epoll / io_uring poll 에 등록
+
+void   tw_timer_init(tw_timer *t, void (*fn)(tw_timer *t, void *ctx));
+void   tw_arm(timer_wheel *w, tw_timer *t, unsigned timeout_ms);   // 이미 걸려 있으면 옮김
+void   tw_cancel(timer_wheel *w, tw_timer *t);                      // 안 걸려 있으면 아무것도 안 함
+
+static inline int tw_armed(const tw_timer *t)
+{
+    return t->next != NULL;
+}
+
+// timerfd 가 읽을 수 있게 되면 호출: 지금까지의 tick 을 처리하고 만료된 콜백을 부름
+// (콜백 안에서 arm / cancel / 연결 해제 가능). 반환 = 부른 콜백 수
+int    tw_expire(timer_wheel *w);
+int    tw_advance(timer_wheel *w, uint64_t now_ms);     // 시각을 직접 줌 (tw_expire 가 씀, 테스트용)
+
+#endif // TIMER_WHEEL_H
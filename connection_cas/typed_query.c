@@ -0,0 +1,169 @@
+#include "typed_query.h"
+#include "thread_safe_queue.h"
+
+#include <string.h>
+#include <endian.h>
+
+// PostgreSQL timestamp 기준점(2000-01-01)과 unix epoch 의 차이 (마이크로초)
+#define PG_EPOCH_OFFSET_US  (946684800LL * 1000000LL)
+
+PGresult *typed_exec(PGconn *conn, const char *sql,
+                     int nparams, const char *const *params)
+{
+    PGresult *res = PQexecParams(conn, sql, nparams, NULL, params, NULL, NULL, 1);
+    if (PQresultStatus(res) != PGRES_TUPLES_OK)
+    {
+        PQclear(res);
+        return NULL;
+    }
+    return res;
+}
+
+// 요청한 디코더와 서버가 보낸 타입이 바이너리 호환인지 확인
+static int type_match(int type, Oid oid)
+{
+    switch (type)
+    {
+        case COL_INT4:      return oid == INT4OID;
+        case COL_INT8:      return oid == INT8OID;
+        case COL_FLOAT8:    return oid == FLOAT8OID;
+        case COL_TIMESTAMP: return oid == TIMESTAMPOID || oid == TIMESTAMPTZOID;
+        case COL_BYTEA:     return oid == BYTEAOID;
+        case COL_TEXT:      return oid == TEXTOID || oid == VARCHAROID || oid == BPCHAROID;
+    }
+    return FALSE;
+}
+
+static int fixed_len(int type)
+{
+    switch (type)
+    {
+        case COL_INT4:      return 4;
+        case COL_INT8:
+        case COL_FLOAT8:
+        case COL_TIMESTAMP: return 8;
+    }
+    return -1;
+}
+
+static void decode_value(int type, const char *src, int len, char *dst)
+{
+    uint32_t u32;
+    uint64_t u64;
+    int32_t  i32;
+    int64_t  i64;
+    col_bytes bytes;
+
+    switch (type)
+    {
+        case COL_INT4:
+            memcpy(&u32, src, 4);
+            i32 = (int32_t)be32toh(u32);
+            memcpy(dst, &i32, sizeof(i32));
+            break;
+        case COL_INT8:
+            memcpy(&u64, src, 8);
+            i64 = (int64_t)be64toh(u64);
+            memcpy(dst, &i64, sizeof(i64));
+            break;
+        case COL_FLOAT8:
+            // IEEE 754 비트열 그대로 전송됨 → 바이트 순서만 뒤집음
+            memcpy(&u64, src, 8);
+            u64 = be64toh(u64);
+            memcpy(dst, &u64, sizeof(u64));
+            break;
+        case COL_TIMESTAMP:
+            memcpy(&u64, src, 8);
+            i64 = (int64_t)be64toh(u64);
+            // 'infinity' / '-infinity' 는 INT64_MAX / INT64_MIN 그대로 (더하면 overflow)
+            if (i64 != INT64_MAX && i64 != INT64_MIN)
+                i64 += PG_EPOCH_OFFSET_US;
+            memcpy(dst, &i64, sizeof(i64));
+            break;
+        case COL_BYTEA:
+        case COL_TEXT:
+            bytes.data = src;
+            bytes.len  = len;
+            memcpy(dst, &bytes, sizeof(bytes));
+            break;
+    }
+}
+
+int typed_decode(const PGresult *res, const col_bind *binds, int nbinds,
+                 void *rows, size_t row_size, int max_rows)
+{
+    int r, c;
+    int ntuples;
+
+    if (PQresultStatus(res) != PGRES_TUPLES_OK || PQnfields(res) < nbinds)
+        return FAIL;
+
+    // 컬럼 검증은 행 루프 밖에서 한 번만
+    for (c = 0; c < nbinds; c++)
+    {
+        if (PQfformat(res, c) != 1 || !type_match(binds[c].type, PQftype(res, c)))
+            return FAIL;
+    }
+
+    ntuples = PQntuples(res);
+    if (ntuples > max_rows)
+        ntuples = max_rows;
+
+    for (r = 0; r < ntuples; r++)
+    {
+        char *row = (char *)rows + (size_t)r * row_size;
+        for (c = 0; c < nbinds; c++)
+        {
+            int is_null = PQgetisnull(res, r, c);
+            int len     = PQgetlength(res, r, c);
+
+            if (binds[c].null_offset >= 0)
+                memcpy(row + binds[c].null_offset, &is_null, sizeof(is_null));
+            if (is_null)
+            {
+                if (binds[c].null_offset < 0)
+                    return FAIL;
+                continue;
+            }
+            if (fixed_len(binds[c].type) > 0 && len != fixed_len(binds[c].type))
+                return FAIL;
+
+            decode_value(binds[c].type, PQgetvalue(res, r, c), len, row + binds[c].offset);
+        }
+    }
+    return ntuples;
+}
+
+int typed_query(PGconn *conn, const char *sql,
+                int nparams, const char *const *params,
+                const col_bind *binds, int nbinds,
+                void *rows, size_t row_size, int max_rows,
+                PGresult **res_out)
+{
+    int n, c;
+    PGresult *res;
+
+    // 실패하면 호출자가 PQclear 할 것이 없도록 항상 NULL 부터
+    if (res_out)
+        *res_out = NULL;
+    // COL_TEXT/COL_BYTEA 는 결과 안을 가리키므로 결과를 넘겨받지 않으면 쓸 수 없음
+    if (res_out == NULL)
+    {
+        for (c = 0; c < nbinds; c++)
+        {
+            if (binds[c].type == COL_TEXT || binds[c].type == COL_BYTEA)
+                return FAIL;
+        }
+    }
+
+    res = typed_exec(conn, sql, nparams, params);
+    if (!res)
+        return FAIL;
+
+    n = typed_decode(res, binds, nbinds, rows, row_size, max_rows);
+    if (res_out && n != FAIL)
+        *res_out = res;
+    else
+        PQclear(res);
+    return n;
+}
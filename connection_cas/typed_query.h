@@ -0,0 +1,60 @@
+#ifndef TYPED_QUERY_H
+#define TYPED_QUERY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <libpq-fe.h>
+
+// PostgreSQL 타입 OID (catalog/pg_type.h 와 동일)
+#define BYTEAOID        17
+#define INT8OID         20
+#define INT4OID         23
+#define TEXTOID         25
+#define FLOAT8OID      701
+#define BPCHAROID     1042
+#define VARCHAROID    1043
+#define TIMESTAMPOID  1114
+#define TIMESTAMPTZOID 1184
+
+enum col_type
+{
+    COL_INT4 = 0,     // int32_t
+    COL_INT8,         // int64_t
+    COL_FLOAT8,       // double
+    COL_TIMESTAMP,    // int64_t: 1970-01-01 UTC 기준 마이크로초
+    COL_BYTEA,        // col_bytes
+    COL_TEXT          // col_bytes (NUL 종료 보장)
+};
+
+// 가변 길이 컬럼: PGresult 내부 버퍼를 그대로 가리킴 → PQclear 전까지만 유효
+typedef struct
+{
+    const char *data;
+    int         len;
+} col_bytes;
+
+// 결과 컬럼 하나를 호출자 구조체 필드 하나에 바인딩
+typedef struct
+{
+    int    type;          // enum col_type
+    size_t offset;        // offsetof(row 구조체, 필드)
+    int    null_offset;   // NULL 여부(int) 저장 위치, -1 이면 NULL 을 FAIL 로 처리
+} col_bind;
+
+// resultFormat = 1 로 실행. 실패 시 NULL (에러는 PQerrorMessage 로 확인)
+PGresult *typed_exec(PGconn *conn, const char *sql,
+                     int nparams, const char *const *params);
+
+// 바이너리 결과를 rows[max_rows] 로 디코딩. 반환: 디코딩한 행 수, 타입 불일치 시 FAIL
+int typed_decode(const PGresult *res, const col_bind *binds, int nbinds,
+                 void *rows, size_t row_size, int max_rows);
+
+// typed_exec + typed_decode. res_out 이 NULL 이 아니면 결과를 넘겨받아 호출자가 PQclear (실패하면 *res_out = NULL)
+// (COL_TEXT/COL_BYTEA 를 쓰면 res_out 필수, NULL 이면 실행하지 않고 FAIL)
+int typed_query(PGconn *conn, const char *sql,
+                int nparams, const char *const *params,
+                const col_bind *binds, int nbinds,
+                void *rows, size_t row_size, int max_rows,
+                PGresult **res_out);
+
+#endif // TYPED_QUERY_H
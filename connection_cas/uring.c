@@ -0,0 +1,253 @@
+#include "uring.h"
+#include "thread_safe_queue.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+static int sys_setup(unsigned entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+                     void *arg, size_t argsz)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+static int sys_register(int fd, unsigned op, void *arg, unsigned nr)
+{
+    return (int)syscall(__NR_io_uring_register, fd, op, arg, nr);
+}
+
+int uring_init(uring *u, unsigned entries, unsigned flags)
+{
+    struct io_uring_params p;
+    unsigned i;
+
+    memset(u, 0, sizeof(*u));
+    memset(&p, 0, sizeof(p));
+    p.flags = flags;
+    u->fd = sys_setup(entries, &p);
+    if (u->fd < 0)
+        return -errno;
+    u->features = p.features;
+
+    u->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    u->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (u->cq_ring_size > u->sq_ring_size)
+            u->sq_ring_size = u->cq_ring_size;
+        u->cq_ring_size = u->sq_ring_size;
+    }
+    u->sq_ring = mmap(NULL, u->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      u->fd, IORING_OFF_SQ_RING);
+    if (u->sq_ring == MAP_FAILED)
+        goto fail;
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        u->cq_ring = u->sq_ring;
+    else
+    {
+        u->cq_ring = mmap(NULL, u->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          u->fd, IORING_OFF_CQ_RING);
+        if (u->cq_ring == MAP_FAILED)
+            goto fail;
+    }
+    u->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   u->fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED)
+        goto fail;
+
+    u->sq_head = (unsigned *)((char *)u->sq_ring + p.sq_off.head);
+    u->sq_tail = (unsigned *)((char *)u->sq_ring + p.sq_off.tail);
+    u->sq_mask = *(unsigned *)((char *)u->sq_ring + p.sq_off.ring_mask);
+    u->sq_entries = p.sq_entries;
+    u->sq_local = *u->sq_tail;
+    // SQ 배열은 항상 같은 자리 (i → i): SQE 칸을 순서대로 씀
+    for (i = 0; i < p.sq_entries; i++)
+        ((unsigned *)((char *)u->sq_ring + p.sq_off.array))[i] = i;
+
+    u->cq_head = (unsigned *)((char *)u->cq_ring + p.cq_off.head);
+    u->cq_tail = (unsigned *)((char *)u->cq_ring + p.cq_off.tail);
+    u->cq_mask = *(unsigned *)((char *)u->cq_ring + p.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe *)((char *)u->cq_ring + p.cq_off.cqes);
+    return SUCCESS;
+
+fail:
+    i = (unsigned)errno;
+    uring_exit(u);
+    return -(int)i;
+}
+
+void uring_exit(uring *u)
+{
+    if (u->sqes && u->sqes != MAP_FAILED)
+        munmap(u->sqes, u->sqes_size);
+    if (u->cq_ring && u->cq_ring != MAP_FAILED && u->cq_ring != u->sq_ring)
+        munmap(u->cq_ring, u->cq_ring_size);
+    if (u->sq_ring && u->sq_ring != MAP_FAILED)
+        munmap(u->sq_ring, u->sq_ring_size);
+    if (u->fd >= 0)
+        close(u->fd);
+    u->fd = -1;
+    u->sqes = NULL;
+    u->sq_ring = u->cq_ring = NULL;
+}
+
+// 채운 SQE 를 커널에 보이게 함 (SQE 내용 → tail 순서는 release 로)
+static unsigned sq_publish(uring *u)
+{
+    unsigned n = u->sq_local - *u->sq_tail;
+    __atomic_store_n(u->sq_tail, u->sq_local, __ATOMIC_RELEASE);
+    return n;
+}
+
+struct io_uring_sqe *uring_get_sqe(uring *u)
+{
+    unsigned head = __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE);
+    struct io_uring_sqe *sqe = NULL;
+
+    if (u->sq_local - head >= u->sq_entries)
+    {
+        // 가득 참: 지금까지 채운 것을 먼저 넘기고 다시 봄
+        uring_submit_wait(u, 0, -1);
+        head = __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE);
+        if (u->sq_local - head >= u->sq_entries)
+            return NULL;
+    }
+    sqe = &u->sqes[u->sq_local & u->sq_mask];
+    u->sq_local++;
+    return sqe;
+}
+
+int uring_submit_wait(uring *u, unsigned wait_nr, int timeout_ms)
+{
+    unsigned submit = sq_publish(u);
+    unsigned flags = wait_nr ? IORING_ENTER_GETEVENTS : 0;
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    int rc;
+
+    if (submit == 0 && wait_nr == 0)
+        return 0;
+    if (wait_nr && timeout_ms >= 0 && (u->features & IORING_FEAT_EXT_ARG))
+    {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+        memset(&arg, 0, sizeof(arg));
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+        u->nenter++;
+        rc = sys_enter(u->fd, submit, wait_nr, flags | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    }
+    else
+    {
+        u->nenter++;
+        rc = sys_enter(u->fd, submit, wait_nr, flags, NULL, 0);
+    }
+    return rc < 0 ? -errno : rc;
+}
+
+struct io_uring_cqe *uring_peek(uring *u)
+{
+    unsigned head = *u->cq_head;
+    unsigned tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail)
+        return NULL;
+    return &u->cqes[head & u->cq_mask];
+}
+
+void uring_advance(uring *u, unsigned n)
+{
+    __atomic_store_n(u->cq_head, *u->cq_head + n, __ATOMIC_RELEASE);
+}
+
+int uring_register_files_sparse(uring *u, unsigned n)
+{
+    struct io_uring_rsrc_register reg;
+
+    memset(&reg, 0, sizeof(reg));
+    reg.nr = n;
+    reg.flags = IORING_RSRC_REGISTER_SPARSE;
+    if (sys_register(u->fd, IORING_REGISTER_FILES2, &reg, sizeof(reg)) < 0)
+        return -errno;
+    return SUCCESS;
+}
+
+int uring_bufs_init(uring *u, uring_bufs *b, uint16_t bgid, unsigned nbufs, unsigned size)
+{
+    struct io_uring_buf_reg reg;
+    size_t ring_size = nbufs * sizeof(struct io_uring_buf);
+    unsigned i;
+
+    memset(b, 0, sizeof(*b));
+    // 버퍼 링은 페이지 정렬이어야 함
+    b->br = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (b->br == MAP_FAILED)
+    {
+        b->br = NULL;
+        return -ENOMEM;
+    }
+    if (posix_memalign((void **)&b->base, 64, (size_t)nbufs * size) != 0)
+    {
+        munmap(b->br, ring_size);
+        b->br = NULL;
+        return -ENOMEM;
+    }
+    b->nbufs = nbufs;
+    b->size = size;
+    b->bgid = bgid;
+
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)b->br;
+    reg.ring_entries = nbufs;
+    reg.bgid = bgid;
+    if (sys_register(u->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        int err = errno;
+        uring_bufs_destroy(NULL, b);
+        return -err;
+    }
+    for (i = 0; i < nbufs; i++)
+    {
+        struct io_uring_buf *buf = &b->br->bufs[i];
+        buf->addr = (uint64_t)(uintptr_t)uring_buf_addr(b, i);
+        buf->len = size;
+        buf->bid = (uint16_t)i;
+    }
+    b->tail = (uint16_t)nbufs;
+    __atomic_store_n(&b->br->tail, b->tail, __ATOMIC_RELEASE);
+    return SUCCESS;
+}
+
+void uring_bufs_destroy(uring *u, uring_bufs *b)
+{
+    if (u != NULL && b->br != NULL)
+    {
+        struct io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.bgid = b->bgid;
+        sys_register(u->fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+    }
+    if (b->br != NULL)
+        munmap(b->br, b->nbufs * sizeof(struct io_uring_buf));
+    free(b->base);
+    b->br = NULL;
+    b->base = NULL;
+}
+
+void uring_buf_recycle(uring_bufs *b, unsigned bid)
+{
+    struct io_uring_buf *buf = &b->br->bufs[b->tail & (b->nbufs - 1)];
+
+    buf->addr = (uint64_t)(uintptr_t)uring_buf_addr(b, bid);
+    buf->len = b->size;
+    buf->bid = (uint16_t)bid;
+    b->tail++;
+    __atomic_store_n(&b->br->tail, b->tail, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,121 @@
+#ifndef URING_H
+#define URING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <poll.h>
+#include <string.h>
+#include <linux/io_uring.h>
+
+// io_uring 최소 래퍼 (liburing 없이 syscall 직접). 한 스레드가 소유하는 링 하나 기준
+//   SQ/CQ 링과 SQE 배열을 mmap 하고, 헤드/테일은 커널과 공유하므로 acquire/release 로 접근
+//   제출 = SQE 채우고 로컬 tail 증가 → uring_submit_wait 가 tail 공개 + io_uring_enter 1 회
+//   완료 = uring_peek 으로 CQE 를 보고 uring_advance 로 소비 (syscall 없음)
+// provided buffer ring: 커널이 recv 마다 빈 버퍼를 골라 쓰고 CQE 에 buffer id 를 알려 줌.
+// 다 쓴 버퍼는 uring_buf_recycle 로 링에 돌려줌 (역시 syscall 없음)
+
+typedef struct
+{
+    int                   fd;
+    unsigned             *sq_head;
+    unsigned             *sq_tail;
+    unsigned              sq_mask;
+    unsigned              sq_entries;
+    unsigned              sq_local;     // 채웠지만 아직 공개하지 않은 tail
+    struct io_uring_sqe  *sqes;
+    unsigned             *cq_head;
+    unsigned             *cq_tail;
+    unsigned              cq_mask;
+    struct io_uring_cqe  *cqes;
+    unsigned              features;
+    void                 *sq_ring;
+    size_t                sq_ring_size;
+    void                 *cq_ring;      // SINGLE_MMAP 이면 sq_ring 과 같음
+    size_t                cq_ring_size;
+    size_t                sqes_size;
+    unsigned long         nenter;       // io_uring_enter 호출 수 (통계)
+} uring;
+
+typedef struct
+{
+    struct io_uring_buf_ring *br;
+    char                     *base;     // nbufs * size 바이트
+    unsigned                  nbufs;    // 2의 거듭제곱
+    unsigned                  size;
+    uint16_t                  bgid;
+    uint16_t                  tail;     // 로컬 tail (recycle 마다 공개)
+} uring_bufs;
+
+// flags: IORING_SETUP_* (커널이 모르는 플래그면 EINVAL → 호출자가 빼고 다시 시도)
+int  uring_init(uring *u, unsigned entries, unsigned flags);
+void uring_exit(uring *u);
+
+struct io_uring_sqe *uring_get_sqe(uring *u);  // SQ 가 가득이면 먼저 공개·제출한 뒤 줌. 그래도 없으면 NULL
+// 채운 SQE 를 제출하고 CQE 가 wait_nr 개 될 때까지 (timeout_ms < 0 이면 무제한) 기다림.
+// 반환 = 제출한 수 또는 -errno (시간 초과는 -ETIME)
+int  uring_submit_wait(uring *u, unsigned wait_nr, int timeout_ms);
+
+struct io_uring_cqe *uring_peek(uring *u);     // 없으면 NULL
+void uring_advance(uring *u, unsigned n);      // CQE n 개 소비
+
+int  uring_register_files_sparse(uring *u, unsigned n);    // 빈 고정 파일 테이블 (direct descriptor 용)
+
+int  uring_bufs_init(uring *u, uring_bufs *b, uint16_t bgid, unsigned nbufs, unsigned size);
+void uring_bufs_destroy(uring *u, uring_bufs *b);
+void uring_buf_recycle(uring_bufs *b, unsigned bid);
+
+static inline char *uring_buf_addr(uring_bufs *b, unsigned bid)
+{
+    return b->base + (size_t)bid * b->size;
+}
+
+// ─── SQE 준비 ────────────────────────────────────────────────
+
+static inline void uring_prep(struct io_uring_sqe *sqe, int op, int fd, uint64_t user_data)
+{
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = (uint8_t)op;
+    sqe->fd = fd;
+    sqe->user_data = user_data;
+}
+
+// 연결마다 CQE 하나, 받은 소켓은 고정 파일 테이블 빈 칸에 (CQE res = 칸 번호)
+static inline void uring_prep_accept_multishot_direct(struct io_uring_sqe *sqe, int fd, uint64_t user_data)
+{
+    uring_prep(sqe, IORING_OP_ACCEPT, fd, user_data);
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->file_index = IORING_FILE_INDEX_ALLOC;
+}
+
+// 데이터가 올 때마다 CQE 하나, 버퍼는 그룹 bgid 에서 커널이 고름 (cqe->flags >> IORING_CQE_BUFFER_SHIFT)
+static inline void uring_prep_recv_multishot_fixed(struct io_uring_sqe *sqe, int slot, uint16_t bgid,
+                                                   uint64_t user_data)
+{
+    uring_prep(sqe, IORING_OP_RECV, slot, user_data);
+    sqe->flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->buf_group = bgid;
+}
+
+static inline void uring_prep_close_fixed(struct io_uring_sqe *sqe, int slot, uint64_t user_data)
+{
+    uring_prep(sqe, IORING_OP_CLOSE, 0, user_data);
+    sqe->file_index = (uint32_t)slot + 1;
+}
+
+// fd 가 읽을 수 있게 될 때마다 CQE 하나 (timerfd 등)
+static inline void uring_prep_poll_multishot(struct io_uring_sqe *sqe, int fd, uint64_t user_data)
+{
+    uring_prep(sqe, IORING_OP_POLL_ADD, fd, user_data);
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+}
+
+// user_data 가 target 인 요청을 취소
+static inline void uring_prep_cancel(struct io_uring_sqe *sqe, uint64_t target, uint64_t user_data)
+{
+    uring_prep(sqe, IORING_OP_ASYNC_CANCEL, -1, user_data);
+    sqe->addr = target;
+}
+
+#endif // URING_H
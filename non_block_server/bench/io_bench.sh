@@ -0,0 +1,25 @@
+#!/bin/sh
+# epoll / io_uring 백엔드 비교: 서버를 -n (DB 없음) 으로 띄우고 load_gen 으로 부하
+# 서버 출력의 syscalls/msg 와 load_gen 의 msgs/s 를 백엔드별로 보여 줌
+# run: make bench && ./bench/io_bench.sh [conns] [msgs/conn] [msg_len] [batch]
+cd "$(dirname "$0")/.." || exit 1
+CONNS=${1:-64}
+MSGS=${2:-50000}
+LEN=${3:-64}
+BATCH=${4:-16}
+
+for backend in epoll io_uring; do
+    flag=""
+    [ "$backend" = io_uring ] && flag="-u"
+    log=$(mktemp)
+    stdbuf -oL ./server -n $flag 1 > "$log" 2>&1 &
+    pid=$!
+    sleep 0.5
+    echo "== $backend"
+    ./load_gen "$CONNS" "$MSGS" "$LEN" "$BATCH"
+    sleep 1.2       # 서버 초당 통계가 한 번 더 찍히도록
+    kill "$pid" 2>/dev/null
+    wait "$pid" 2>/dev/null
+    grep -E "Server listening|unavailable|syscalls/msg" "$log" | sed 's/^/  server: /'
+    rm -f "$log"
+done
@@ -0,0 +1,122 @@
+// 서버 I/O 벤치용 부하 생성기: 연결 여러 개로 길이 접두 프레임을 보내기만 함
+//   연결마다 msgs 개, 한 write 에 batch 개씩 (파이프라인). 스레드는 연결을 나눠 맡아 돌아가며 보냄
+// 서버는 -n (DB 없음) 으로 띄우고, 서버 쪽 초당 통계(syscalls/msg) 와 여기 처리량을 같이 봄
+// build: make bench   (non_block_server 디렉터리에서)
+// run:   ./load_gen [conns] [msgs/conn] [msg_len] [batch] [threads] [host] [port]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+typedef struct {
+    int  nconn;
+    int *fds;
+    long msgs;          // 연결당
+    int  batch;
+    char *wire;         // batch 개 프레임
+    size_t wire_len;
+} load_arg_t;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int write_all(int fd, const char *p, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0)
+            return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static void *load_thread(void *arg) {
+    load_arg_t *a = (load_arg_t *)arg;
+    for (long sent = 0; sent < a->msgs; sent += a->batch) {
+        for (int i = 0; i < a->nconn; i++) {
+            if (write_all(a->fds[i], a->wire, a->wire_len) < 0) {
+                perror("write");
+                return NULL;
+            }
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    int conns   = argc > 1 ? atoi(argv[1]) : 64;
+    long msgs   = argc > 2 ? atol(argv[2]) : 100000;
+    int len     = argc > 3 ? atoi(argv[3]) : 64;
+    int batch   = argc > 4 ? atoi(argv[4]) : 16;
+    int threads = argc > 5 ? atoi(argv[5]) : 4;
+    const char *host = argc > 6 ? argv[6] : "127.0.0.1";
+    int port    = argc > 7 ? atoi(argv[7]) : 8080;
+
+    if (threads > conns)
+        threads = conns;
+    msgs = (msgs + batch - 1) / batch * batch;
+
+    // 프레임 batch 개: 4 바이트 big-endian 길이 + 본문
+    size_t frame = 4 + (size_t)len;
+    char *wire = malloc(frame * batch);
+    for (int i = 0; i < batch; i++) {
+        char *p = wire + frame * i;
+        uint32_t be = htonl((uint32_t)len);
+        memcpy(p, &be, 4);
+        for (int j = 0; j < len; j++)
+            p[4 + j] = (char)('a' + (i + j) % 26);
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, host, &addr.sin_addr);
+
+    int *fds = malloc(sizeof(int) * conns);
+    for (int i = 0; i < conns; i++) {
+        int one = 1;
+        fds[i] = socket(AF_INET, SOCK_STREAM, 0);
+        setsockopt(fds[i], IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (connect(fds[i], (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+            perror("connect");
+            return 1;
+        }
+    }
+
+    pthread_t tid[threads];
+    load_arg_t args[threads];
+    int per = conns / threads;
+    double start = now_sec();
+    for (int t = 0; t < threads; t++) {
+        args[t].fds = fds + t * per;
+        args[t].nconn = t == threads - 1 ? conns - t * per : per;
+        args[t].msgs = msgs;
+        args[t].batch = batch;
+        args[t].wire = wire;
+        args[t].wire_len = frame * batch;
+        pthread_create(&tid[t], NULL, load_thread, &args[t]);
+    }
+    for (int t = 0; t < threads; t++)
+        pthread_join(tid[t], NULL);
+    double sec = now_sec() - start;
+
+    for (int i = 0; i < conns; i++)
+        close(fds[i]);
+    double total = (double)msgs * conns;
+    printf("conns=%d msgs=%.0f len=%d batch=%d: %.2f s, %.0f msgs/s, %.1f MB/s\n",
+           conns, total, len, batch, sec, total / sec, total * frame / sec / 1e6);
+    free(fds);
+    free(wire);
+    return 0;
+}
@@ -1,19 +1,39 @@
+#define _GNU_SOURCE     // accept4, pthread_setaffinity_np
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/epoll.h>
-#include <fcntl.h>
+#include <sched.h>
+#include <sys/socket.h>
 #include <errno.h>
 #include <pthread.h>
+#include <time.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <signal.h>
 #include <libpq-fe.h>
+#include "slab.h"
+#include "rx_ring.h"
+#include "copy_text.h"
+#include "uring.h"
+#include "mpmc_queue.h"
+#include "conn_pool.h"
+#include "async_log.h"
+#include "spill.h"
+#include "lat_hist.h"
+#include "timer_wheel.h"
 
 #define PORT 8080
-#define MAX_EVENTS 10
-#define BUF_SIZE 1024
-#define POOL_SIZE 10
-#define QUEUE_SIZE 1000
+#define MAX_EVENTS 256     // epoll_wait 1 회에 받는 이벤트 수 (reactor 마다)
+#define MAX_REACTORS 64
+#define LISTEN_BACKLOG 1024
+#define BUF_SIZE 1024      // 프레임 본문 최대 길이 (넘으면 연결을 끊음)
+#define QUEUE_SIZE 1024    // MPMC 링 칸 수 (2의 거듭제곱)
+#define HK_INTERVAL_MS 1000 // 끊긴 DB 커넥션 재연결 주기
+#define DB_WORKERS 4
 
 // PostgreSQL 연결 정보
 #define DB_HOST "172.17.0.3"
@@ -22,322 +42,1508 @@
 #define DB_USER "pguser"
 #define DB_PASS "pgpass"
 
-typedef struct {
+// epoll data.ptr 가 가리키는 객체 종류 (첫 필드). listener 는 NULL
+enum ev_kind {
+    EV_CLIENT = 1,
+    EV_DB,
+    EV_TIMER                // reactor 의 타이밍 휠 timerfd
+};
+
+// 연결 시간 제한 (reactor 마다 타이밍 휠 하나, timerfd 가 tick 을 알림)
+#define TW_TICK_MS       100
+#define IDLE_TIMEOUT_MS  60000  // 아무것도 보내지 않는 연결
+#define READ_TIMEOUT_MS  5000   // 프레임 조각을 받은 뒤 다음 프레임이 완성되기까지
+#define TIMER_POLL_RETRY 3      // io_uring timer poll 이 연달아 실패하면 다시 거는 횟수
+
+enum deadline {
+    DEADLINE_IDLE = 1,
+    DEADLINE_READ
+};
+
+// 클라이언트 연결. 수신 링은 g_rx_pool 에서 빌리고 비면 돌려줌
+typedef struct sock_buffer {
+    int kind;               // EV_CLIENT
     int fd;
-    char buf[BUF_SIZE];
-    size_t buf_len;
+    rx_ring rx;             // 아직 프레임이 되지 못한 바이트
+    int stalled;            // backpressure 로 읽기를 멈춘 연결 목록에 있음
+    int armed;              // io_uring: multishot recv 가 살아 있음
+    int canceling;          // io_uring: recv 취소를 보냄 (backpressure)
+    int closing;            // io_uring: 닫는 중 (recv 가 끝나면 close)
+    int held_head;          // io_uring: 링에 못 넣고 잡아 둔 provided buffer (bid 목록, -1 = 없음)
+    int held_tail;
+    uint64_t rx_at;         // 링에 남은 바이트를 마지막으로 받은 시각 (이후 완성된 프레임의 t_recv)
+    struct sock_buffer *stall_prev, *stall_next;
+    tw_timer timer;         // idle 또는 읽기 마감 (conn_touch 가 고름)
+    int deadline;           // enum deadline
+    unsigned frames;        // 완성한 프레임 수 (읽기 마감을 늘릴지 판단)
+    unsigned frames_at;     // 읽기 마감을 건 때의 frames
 } sock_buffer_t;
 
+// 프레임 본문을 담는 메시지 버퍼. 큐에는 포인터만 오가고 워커가 다 쓰면 slab 으로 반납
 typedef struct {
-    char data[BUF_SIZE];
-    int len;
     int client_fd;
-} db_task_t;
+    int len;
+    uint64_t t_recv;            // 프레임을 읽은 시각 (lat_now, 재생한 메시지는 0)
+    uint64_t t_deq;             // DB 워커가 꺼낸 시각
+    char data[BUF_SIZE + 1];    // + NUL (text 파라미터로 넘김)
+} db_msg_t;
 
-typedef struct {
-    PGconn *conn;
-    int in_use;
-} pg_conn_t;
+// ─── 단계별 지연 ────────────────────────────────────────────
+// 메시지마다 단계 경계에서 lat_now (CLOCK_MONOTONIC, vDSO) 를 찍고 스레드별 히스토그램에 기록.
+// 집계는 SIGUSR1 (kill -USR1 <pid>) 을 받은 통계 스레드가 스레드들을 더해서 p50/p99/p999 로 로그
+//   recv   : 소켓 읽기 syscall 한 번 (epoll 백엔드만. io_uring 은 커널 안에서 끝남)
+//   queue  : 프레임을 읽은 뒤 → DB 워커가 꺼냄 (async: reactor 대기열 → INSERT 전송)
+//   batch  : 워커가 꺼냄 → 배치 COPY 시작 (group commit 으로 더 모으는 시간)
+//   conn   : get_conn_2 대기 (배치당)
+//   commit : COPY / INSERT 왕복 (배치당)
+//   total  : 프레임을 읽은 뒤 → 커밋 완료 (메시지당, 실패한 배치는 빠짐)
 
-typedef struct {
-    pg_conn_t pool[POOL_SIZE];
-    pthread_mutex_t pool_lock;  // 전체 풀만 보호하면 충분
-} pg_pool_t;
+enum lat_stage {
+    LAT_RECV = 0,
+    LAT_QUEUE,
+    LAT_BATCH,
+    LAT_CONN,
+    LAT_COMMIT,
+    LAT_TOTAL,
+    LAT_NSTAGES
+};
+
+static const char *const LAT_NAMES[LAT_NSTAGES] = {
+    "recv", "queue", "batch", "conn", "commit", "total"
+};
+
+enum backend {
+    BACKEND_EPOLL = 0,
+    BACKEND_URING
+};
+
+char g_conninfo[512];
+int g_async = 0;            // 1 = reactor 가 non-blocking libpq 로 직접 저장 (DB 워커 없음)
+int g_backend = BACKEND_EPOLL;
+int g_sink = 0;             // 1 = DB 없이 프레임만 세고 버림 (I/O 벤치용, 초당 통계 출력)
+conn_pool *g_pool = NULL;    // CAS 슬롯 점유 + 고갈 시 반납이 깨우는 대기 큐
+mpmc_queue g_queue;         // epoll 스레드 → DB 워커 (db_msg_t 포인터, 빌 때 워커는 eventfd 에서 잠듦)
+slab_cache g_buf_cache;     // 연결별 sock_buffer_t (accept 마다 malloc 하지 않음)
+slab_cache g_msg_cache;     // db_msg_t
+rx_pool g_rx_pool;          // 연결별 수신 링 버퍼 (4K~64K 크기별 slab, 모든 reactor 공유)
+spill_journal g_spill;      // -j: DB 가 밀리거나 쓰기가 실패한 메시지를 디스크로
+int g_spill_on = 0;
+atomic_int g_spill_stop;
+lat_set g_lat;              // 단계별 지연 (스레드마다 lat_register)
+
+// ─── group commit ───────────────────────────────────────────
+// 워커는 첫 메시지를 받은 뒤 limit 개가 찰 때까지, 또는 BATCH_WAIT_US 동안 더 모아
+// COPY 한 번(= 트랜잭션/fsync 한 번)으로 씀. limit 은 커밋 지연에 맞춰 조절:
+// 꽉 찬 배치가 목표 지연보다 충분히 빠르면 두 배로, 목표를 넘으면 절반으로
+
+#define BATCH_MIN        1
+#define BATCH_MAX        256
+#define BATCH_WAIT_US    500     // 첫 메시지 이후 더 기다리는 최대 시간
+#define BATCH_TARGET_US  5000    // 커밋 지연 목표 (EWMA)
+#define COPY_ROW_MAX     (BUF_SIZE * 2 + 16)   // 모든 바이트가 escape 돼도 들어가는 한 줄 크기 (copy_escape 는 2 * len 까지 씀)
 
 typedef struct {
-    db_task_t tasks[QUEUE_SIZE];
-    int head;
-    int tail;
-    int count;
-    pthread_mutex_t lock;
-    pthread_cond_t cond;
-    int shutdown;
-} task_queue_t;
-
-pg_pool_t *g_pool = NULL;
-task_queue_t *g_queue = NULL;
-
-// PostgreSQL 연결 풀 초기화
-pg_pool_t* init_pg_pool() {
-    pg_pool_t *pool = malloc(sizeof(pg_pool_t));
-    pthread_mutex_init(&pool->pool_lock, NULL);
-    
-    for (int i = 0; i < POOL_SIZE; i++) {
-        char conninfo[512];
-        snprintf(conninfo, sizeof(conninfo),
-                "host=%s port=%s dbname=%s user=%s password=%s",
-                DB_HOST, DB_PORT, DB_NAME, DB_USER, DB_PASS);
-        
-        pool->pool[i].conn = PQconnectdb(conninfo);
-        
-        if (PQstatus(pool->pool[i].conn) != CONNECTION_OK) {
-            fprintf(stderr, "Connection to database failed: %s\n",
-                    PQerrorMessage(pool->pool[i].conn));
-            PQfinish(pool->pool[i].conn);
-            pool->pool[i].conn = NULL;
+    int     limit;          // 이번 배치 최대 메시지 수
+    double  commit_us;      // 커밋 지연 EWMA
+    char   *copy_buf;       // BATCH_MAX 줄 분량 COPY 텍스트
+    lat_thread *lat;
+} batch_ctl_t;
+
+// PQerrorMessage 는 '\n' 으로 끝남 (로거가 줄바꿈을 붙이므로 뺀 길이, "%.*s" 용)
+static int pq_errlen(const char *m) {
+    size_t n = strlen(m);
+    while (n > 0 && m[n - 1] == '\n')
+        n--;
+    return (int)n;
+}
+
+static long now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+// 메시지 n 개를 COPY 한 번으로 저장 (copy_buf 는 n * COPY_ROW_MAX 바이트). 성공하면 0
+static int copy_rows(PGconn *conn, char *copy_buf, db_msg_t **msgs, int n) {
+    char *p = copy_buf;
+    for (int i = 0; i < n; i++) {
+        p += sprintf(p, "%d\t", msgs[i]->client_fd);
+        p += copy_escape(p, msgs[i]->data, msgs[i]->len);
+        *p++ = '\n';
+    }
+
+    int rc = -1;
+
+    // timestamp 는 열 기본값 NOW() (= 트랜잭션 시작 시각, 배치 안에서 같음)
+    PGresult *res = PQexec(conn, "COPY messages (client_fd, data) FROM STDIN");
+    if (PQresultStatus(res) == PGRES_COPY_IN) {
+        PQclear(res);
+        if (PQputCopyData(conn, copy_buf, (int)(p - copy_buf)) == 1 &&
+            PQputCopyEnd(conn, NULL) == 1) {
+            res = PQgetResult(conn);
+            rc = PQresultStatus(res) == PGRES_COMMAND_OK ? 0 : -1;
+        } else {
+            res = PQgetResult(conn);
         }
-        
-        pool->pool[i].in_use = 0;
     }
-    
-    return pool;
+    if (rc < 0) {
+        const char *err = PQerrorMessage(conn);
+        alog_error("COPY failed (%d rows): %.*s", n, pq_errlen(err), err);
+    }
+    PQclear(res);
+    // COPY 를 중간에 끊었으면 남은 결과를 비워야 커넥션을 다시 쓸 수 있음
+    while ((res = PQgetResult(conn)) != NULL)
+        PQclear(res);
+    return rc;
 }
 
-// 연결 풀에서 사용 가능한 연결 가져오기
-PGconn* get_pg_conn(pg_pool_t *pool) {
+static int flush_batch(batch_ctl_t *b, db_msg_t **msgs, int n) {
+    uint64_t t = lat_now();
+    for (int i = 0; i < n; i++)
+        lat_record(b->lat, LAT_BATCH, t - msgs[i]->t_deq);
+
+    // 워커는 오래 사는 스레드 → TLS 캐시 경로 (대개 같은 슬롯을 CAS 1 회로 다시 잡음)
+    PGconn *conn = get_conn_2(g_pool);
+    t = lat_since(b->lat, LAT_CONN, t);
+    long start = now_us();
+    int rc = copy_rows(conn, b->copy_buf, msgs, n);
+    release_conn(g_pool, conn);
+    t = lat_since(b->lat, LAT_COMMIT, t);
+    for (int i = 0; rc == 0 && i < n; i++) {
+        if (msgs[i]->t_recv)
+            lat_record(b->lat, LAT_TOTAL, t - msgs[i]->t_recv);
+    }
+
+    // 커밋 지연에 맞춰 다음 배치 크기 조절
+    double us = (double)(now_us() - start);
+    b->commit_us = b->commit_us == 0 ? us : b->commit_us * 0.8 + us * 0.2;
+    if (b->commit_us > BATCH_TARGET_US && b->limit > BATCH_MIN)
+        b->limit /= 2;
+    else if (n == b->limit && b->commit_us < BATCH_TARGET_US / 2 && b->limit < BATCH_MAX)
+        b->limit *= 2;
+
+    if (rc == 0)
+        alog_limited(ALOG_INFO, 10, "Data saved to DB: %d rows, commit %.0f us, next limit %d",
+                     n, us, b->limit);
+    return rc;
+}
+
+// ─── spill 저널 ─────────────────────────────────────────────
+// -j <dir>: DB 큐가 high watermark 를 넘거나 (읽기를 멈추는 대신) 저장이 실패한 메시지를
+// 디스크 저널에 붙임. 기록 = client_fd(4 바이트) + 본문. 재생 스레드는 DB 가 따라잡으면
+// (스레드 모드: 큐가 low 아래) 자기 커넥션으로 BATCH_MAX 개씩 COPY 하고, 성공한 만큼
+// checkpoint. 실패하면 되감아 HK_INTERVAL_MS 뒤 다시. 순간적인 지연은 디스크 속도로 흡수됨
+// (저널에 간 메시지는 큐의 메시지보다 늦게 저장될 수 있음)
+
+#define SPILL_REPLAY_MS  100     // 저널이 비었을 때 다시 보는 주기 (이때 fdatasync 도)
+
+static int spill_msg(db_msg_t *msg) {
+    struct iovec iov[2] = {
+        { &msg->client_fd, sizeof(msg->client_fd) },
+        { msg->data, (size_t)msg->len },
+    };
+    return spill_appendv(&g_spill, iov, 2);
+}
+
+static void spill_msgs(db_msg_t **msgs, int n, const char *why) {
+    int lost = 0;
+    for (int i = 0; i < n; i++)
+        lost += spill_msg(msgs[i]) != 0;
+    if (lost)
+        alog_limited(ALOG_ERROR, 10, "Spill journal append failed: %d rows dropped (%s)", lost, why);
+    if (n > lost)
+        alog_limited(ALOG_WARN, 10, "Spilled %d rows to journal (%s)", n - lost, why);
+}
+
+// 워커 스레드 - DB에 비동기 저장. arg = COPY 버퍼 (main 이 할당, 워커가 해제)
+void* db_worker(void *arg) {
+    db_msg_t *msgs[BATCH_MAX];
+    batch_ctl_t b = { .limit = BATCH_MIN, .commit_us = 0, .lat = lat_register(&g_lat) };
+
+    b.copy_buf = arg;
     while (1) {
-        pthread_mutex_lock(&pool->pool_lock);
+        db_msg_t *msg = mpmc_pop_wait(&g_queue);
         
-        for (int i = 0; i < POOL_SIZE; i++) {
-            if (!pool->pool[i].in_use && pool->pool[i].conn != NULL) {
-                pool->pool[i].in_use = 1;
-                PGconn *conn = pool->pool[i].conn;
-                pthread_mutex_unlock(&pool->pool_lock);
-                return conn;
-            }
+        if (msg == NULL) {
+            break; // shutdown
         }
         
-        pthread_mutex_unlock(&pool->pool_lock);
-        usleep(10000); // 10ms 대기
+        // 첫 메시지부터 BATCH_WAIT_US 안에 도착한 것까지 limit 개를 모음
+        int n = 0;
+        long deadline = now_us() + BATCH_WAIT_US;
+        msg->t_deq = lat_now();
+        lat_record(b.lat, LAT_QUEUE, msg->t_deq - msg->t_recv);
+        msgs[n++] = msg;
+        while (n < b.limit) {
+            long left = deadline - now_us();
+            if (left <= 0 || (msg = mpmc_pop_timed(&g_queue, left)) == NULL)
+                break;
+            msg->t_deq = lat_now();
+            lat_record(b.lat, LAT_QUEUE, msg->t_deq - msg->t_recv);
+            msgs[n++] = msg;
+        }
+        
+        if (flush_batch(&b, msgs, n) < 0 && g_spill_on)
+            spill_msgs(msgs, n, "COPY failed");
+        for (int i = 0; i < n; i++)
+            slab_free(&g_msg_cache, msgs[i]);
     }
+    
+    free(b.copy_buf);
+    return NULL;
 }
 
-// 연결 반환
-void release_pg_conn(pg_pool_t *pool, PGconn *conn) {
-    pthread_mutex_lock(&pool->pool_lock);
-    
-    for (int i = 0; i < POOL_SIZE; i++) {
-        if (pool->pool[i].conn == conn) {
-            pool->pool[i].in_use = 0;
+// ─── reactor ────────────────────────────────────────────────
+// reactor 마다 자기 epoll 과 SO_REUSEPORT listener 를 가짐. 커널이 새 연결을 listener 들에
+// 나눠 주므로 accept 경합이 없고, 받은 연결은 끝날 때까지 그 reactor 의 epoll 에만 있음
+
+// ─── async DB: reactor 가 libpq 상태 기계를 직접 구동 ──────────
+// PQsocket 을 같은 epoll 에 등록하고 연결(PQconnectPoll) → 전송(PQsendQueryParams, PQflush)
+// → 결과(PQconsumeInput, PQgetResult) 를 이벤트마다 한 단계씩 진행. 스레드 전달이 없고
+// 비용은 진행 중인 쿼리 수에만 비례. 한 커넥션이 쿼리를 도는 동안 쌓인 메시지는
+// 다음 multi-row INSERT 한 번으로 나감 (자연스러운 group commit)
+
+#define ASYNC_DB_CONNS   2       // reactor 당 커넥션 (하나가 도는 동안 다른 하나가 보냄)
+#define ASYNC_PENDING    4096    // reactor 당 대기 메시지 (2의 거듭제곱)
+#define ASYNC_RETRY_MS   1000    // 연결 실패 후 재시도 간격 (epoll_wait 시간 제한으로도 씀)
+
+enum adb_state {
+    ADB_DOWN = 0,
+    ADB_CONNECTING,
+    ADB_IDLE,
+    ADB_BUSY
+};
+
+typedef struct {
+    int        kind;                    // EV_DB
+    int        state;                   // enum adb_state
+    PGconn    *conn;
+    int        fd;                      // epoll 에 등록한 소켓 (-1 = 없음)
+    unsigned   events;                  // 등록한 관심 이벤트
+    long       retry_at;                // DOWN: 재연결 시각 (us)
+    uint64_t   sent_at;                 // BUSY: 전송 시각 (lat_now)
+    int        ninflight;
+    int        failed;                  // BUSY: 이번 INSERT 가 오류 (결과를 다 받으면 저널로)
+    db_msg_t  *inflight[BATCH_MAX];     // 결과가 오면 slab 으로 반납
+} async_db_t;
+
+typedef struct {
+    int id;
+    int cpu;                // 고정할 코어 (-1 = 고정 안 함)
+    int listen_fd;
+    int epfd;
+    pthread_t thread;
+    // async 모드 전용 (reactor 스레드만 만짐 → 락 없음)
+    async_db_t db[ASYNC_DB_CONNS];
+    db_msg_t  *pending[ASYNC_PENDING];
+    unsigned   pend_head;
+    unsigned   pend_tail;
+    char       sql[BATCH_MAX * 16 + 64];
+    char       fd_str[BATCH_MAX][12];
+    const char *values[BATCH_MAX * 2];
+    // backpressure
+    int        paused;              // DB 큐가 high watermark 를 넘어 읽기를 멈춘 상태
+    int        spill_full;          // -j: 저널 append 실패 → 평소처럼 멈춤 (재개하면 다시 저널)
+    sock_buffer_t *stall_head;      // 읽다 멈춘 연결 (FIFO, 재개 때 앞에서부터)
+    sock_buffer_t *stall_tail;
+    // io_uring 백엔드
+    uring      ring;
+    uring_bufs bufs;
+    sock_buffer_t **conns;          // 고정 파일 칸 → 연결 (URING_FILES 칸)
+    uint16_t  *held_next;           // 잡아 둔 buffer 목록의 다음 bid (URING_BUFS 칸)
+    uint16_t  *held_len;            // 잡아 둔 buffer 에 받은 바이트
+    // 연결 시간 제한
+    timer_wheel wheel;
+    int        timer_ev;            // EV_TIMER (epoll data.ptr 가 가리킴)
+    int        timer_errs;          // io_uring: 연달아 실패한 timer poll 수
+    // 단계별 지연
+    lat_thread *lat;
+    uint64_t   rx_at;               // io_uring: 이번 CQE 묶음을 받은 시각 (연결의 rx_at 으로)
+    // 통계 (-n 모드에서 초마다 출력)
+    long       nmsg;                // 받은 프레임
+    long       nsys;                // epoll 백엔드의 syscall (io_uring 은 ring.nenter)
+    long       stat_at;
+    long       stat_msg;
+    long       stat_sys;
+} reactor_t;
+
+// 등록 소켓/관심 이벤트가 바뀐 경우만 epoll_ctl (PQconnectPoll 중 소켓이 바뀔 수 있음)
+static void adb_watch(reactor_t *r, async_db_t *db, unsigned events) {
+    struct epoll_event ev;
+    int fd = PQsocket(db->conn);
+
+    ev.events = events;
+    ev.data.ptr = db;
+    if (fd != db->fd) {
+        if (db->fd >= 0)
+            epoll_ctl(r->epfd, EPOLL_CTL_DEL, db->fd, NULL);
+        db->fd = fd;
+        if (fd >= 0)
+            epoll_ctl(r->epfd, EPOLL_CTL_ADD, fd, &ev);
+    } else if (events != db->events && fd >= 0) {
+        epoll_ctl(r->epfd, EPOLL_CTL_MOD, fd, &ev);
+    }
+    db->events = events;
+}
+
+static void adb_release_inflight(async_db_t *db) {
+    for (int i = 0; i < db->ninflight; i++)
+        slab_free(&g_msg_cache, db->inflight[i]);
+    db->ninflight = 0;
+}
+
+// 커넥션 폐기. 전송 중이던 메시지는 저널로, 저널이 없으면 버림 (스레드 모드의 COPY 실패와 같음)
+static void adb_fail(reactor_t *r, async_db_t *db, const char *what) {
+    const char *err = db->conn ? PQerrorMessage(db->conn) : "";
+    alog_error("async DB %s failed (reactor %d, %d rows %s): %.*s", what, r->id, db->ninflight,
+               g_spill_on ? "to journal" : "dropped", pq_errlen(err), err);
+    if (g_spill_on)
+        spill_msgs(db->inflight, db->ninflight, "async DB failed");
+    adb_release_inflight(db);
+    db->failed = 0;
+    if (db->fd >= 0)
+        epoll_ctl(r->epfd, EPOLL_CTL_DEL, db->fd, NULL);
+    db->fd = -1;
+    db->events = 0;
+    if (db->conn)
+        PQfinish(db->conn);
+    db->conn = NULL;
+    db->state = ADB_DOWN;
+    db->retry_at = now_us() + ASYNC_RETRY_MS * 1000L;
+}
+
+static void adb_start(reactor_t *r, async_db_t *db) {
+    db->conn = PQconnectStart(g_conninfo);
+    if (db->conn == NULL || PQstatus(db->conn) == CONNECTION_BAD ||
+        PQsetnonblocking(db->conn, 1) != 0) {
+        adb_fail(r, db, "connect");
+        return;
+    }
+    db->state = ADB_CONNECTING;
+    // PQconnectStart 직후는 쓰기 가능을 기다리는 단계 (PGRES_POLLING_WRITING 과 같음)
+    adb_watch(r, db, EPOLLOUT);
+}
+
+static void adb_connect_poll(reactor_t *r, async_db_t *db) {
+    switch (PQconnectPoll(db->conn)) {
+    case PGRES_POLLING_READING:
+        adb_watch(r, db, EPOLLIN);
+        break;
+    case PGRES_POLLING_WRITING:
+        adb_watch(r, db, EPOLLOUT);
+        break;
+    case PGRES_POLLING_OK:
+        db->state = ADB_IDLE;
+        adb_watch(r, db, EPOLLIN);
+        break;
+    default:
+        adb_fail(r, db, "connect");
+        break;
+    }
+}
+
+static unsigned pending_count(reactor_t *r) {
+    return r->pend_tail - r->pend_head;
+}
+
+// 대기 메시지를 최대 BATCH_MAX 개 꺼내 multi-row INSERT 하나로 전송
+static void adb_send(reactor_t *r, async_db_t *db) {
+    int n = (int)pending_count(r);
+    char *p = r->sql;
+    uint64_t now = lat_now();
+
+    if (n > BATCH_MAX)
+        n = BATCH_MAX;
+    p += sprintf(p, "INSERT INTO messages (client_fd, data) VALUES ");
+    for (int i = 0; i < n; i++) {
+        db_msg_t *msg = r->pending[r->pend_head++ & (ASYNC_PENDING - 1)];
+        db->inflight[i] = msg;
+        lat_record(r->lat, LAT_QUEUE, now - msg->t_recv);
+        snprintf(r->fd_str[i], sizeof(r->fd_str[i]), "%d", msg->client_fd);
+        r->values[i * 2] = r->fd_str[i];
+        r->values[i * 2 + 1] = msg->data;
+        p += sprintf(p, "%s($%d,$%d)", i ? "," : "", i * 2 + 1, i * 2 + 2);
+    }
+    db->ninflight = n;
+
+    // 파라미터는 이 호출에서 libpq 출력 버퍼로 복사됨 → sql/values 는 바로 재사용 가능
+    if (!PQsendQueryParams(db->conn, r->sql, n * 2, NULL, r->values, NULL, NULL, 0)) {
+        adb_fail(r, db, "send");
+        return;
+    }
+    db->state = ADB_BUSY;
+    db->sent_at = lat_now();
+    int rc = PQflush(db->conn);
+    if (rc < 0)
+        adb_fail(r, db, "flush");
+    else
+        adb_watch(r, db, rc ? EPOLLIN | EPOLLOUT : EPOLLIN);
+}
+
+static void adb_on_event(reactor_t *r, async_db_t *db, unsigned events) {
+    if (db->state == ADB_CONNECTING) {
+        adb_connect_poll(r, db);
+        return;
+    }
+    if (db->state == ADB_DOWN)
+        return;
+
+    // 보낼 것이 남아 있으면 마저 보냄
+    if (events & EPOLLOUT) {
+        int rc = PQflush(db->conn);
+        if (rc < 0) {
+            adb_fail(r, db, "flush");
+            return;
+        }
+        if (rc == 0)
+            adb_watch(r, db, EPOLLIN);
+    }
+    if (!(events & (EPOLLIN | EPOLLERR | EPOLLHUP)))
+        return;
+
+    if (!PQconsumeInput(db->conn)) {
+        adb_fail(r, db, "read");
+        return;
+    }
+    while (db->state == ADB_BUSY && !PQisBusy(db->conn)) {
+        PGresult *res = PQgetResult(db->conn);
+        if (res == NULL) {
+            // 이번 쿼리의 결과를 다 받음
+            uint64_t now = lat_since(r->lat, LAT_COMMIT, db->sent_at);
+            if (!db->failed) {
+                for (int i = 0; i < db->ninflight; i++)
+                    lat_record(r->lat, LAT_TOTAL, now - db->inflight[i]->t_recv);
+                alog_limited(ALOG_INFO, 10, "Data saved to DB: %d rows, commit %ld us (reactor %d)",
+                             db->ninflight, (long)(now - db->sent_at) / 1000, r->id);
+            } else if (g_spill_on)
+                spill_msgs(db->inflight, db->ninflight, "INSERT failed");
+            adb_release_inflight(db);
+            db->failed = 0;
+            db->state = ADB_IDLE;
             break;
         }
+        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+            const char *err = PQerrorMessage(db->conn);
+            alog_error("INSERT failed (%d rows): %.*s", db->ninflight, pq_errlen(err), err);
+            db->failed = 1;
+        }
+        PQclear(res);
     }
-    
-    pthread_mutex_unlock(&pool->pool_lock);
 }
 
-// 작업 큐 초기화
-task_queue_t* init_task_queue() {
-    task_queue_t *queue = malloc(sizeof(task_queue_t));
-    queue->head = 0;
-    queue->tail = 0;
-    queue->count = 0;
-    queue->shutdown = 0;
-    pthread_mutex_init(&queue->lock, NULL);
-    pthread_cond_init(&queue->cond, NULL);
-    return queue;
+// 쉬는 커넥션에 대기 메시지를 보내고, 끊긴 커넥션은 때가 되면 다시 연결
+static void async_kick(reactor_t *r) {
+    long now = 0;
+    for (int i = 0; i < ASYNC_DB_CONNS; i++) {
+        async_db_t *db = &r->db[i];
+        if (db->state == ADB_DOWN) {
+            if (now == 0)
+                now = now_us();
+            if (now >= db->retry_at)
+                adb_start(r, db);
+        }
+        if (db->state == ADB_IDLE && pending_count(r) > 0)
+            adb_send(r, db);
+    }
 }
 
-// 작업 추가
-int enqueue_task(task_queue_t *queue, const char *data, int len, int client_fd) {
-    pthread_mutex_lock(&queue->lock);
-    
-    if (queue->count >= QUEUE_SIZE) {
-        pthread_mutex_unlock(&queue->lock);
+// ─── backpressure ───────────────────────────────────────────
+// DB 큐(스레드 모드: 공유 MPMC 링, async: reactor 대기열) 깊이가 high 를 넘으면 reactor 는
+// 소켓 읽기를 멈춤. 읽지 않은 바이트는 커널 수신 버퍼에 남아 TCP 윈도가 닫히므로 과부하는
+// 클라이언트를 늦출 뿐 메시지를 버리지 않음. 깊이가 low 아래로 내려가면 멈춘 연결을 차례로
+// 다시 읽음. 메모리는 큐 칸 수 + 연결당 수신 링(최대 64K) 으로 묶임.
+// 각 reactor 는 push 전마다 깊이를 보므로 high 를 넘는 양은 reactor 수 이하
+// (QUEUE_SIZE - high = 256 > MAX_REACTORS → 스레드 모드 push 는 실패하지 않음)
+
+#define QUEUE_HIGH_PCT  75
+#define QUEUE_LOW_PCT   25
+#define STALL_POLL_MS   1       // 멈춘 연결이 있으면 이 주기로 큐 깊이를 다시 봄
+
+static unsigned queue_depth(reactor_t *r) {
+    if (g_sink)
+        return 0;
+    return g_async ? pending_count(r) : (unsigned)mpmc_size(&g_queue);
+}
+
+// 깊이를 보고 멈춤/재개 상태를 갱신 (hysteresis). 1 = 읽으면 안 됨
+static int reactor_paused(reactor_t *r) {
+    if (g_spill_on && !r->spill_full)
+        return 0;       // 멈추는 대신 reactor_submit 이 high 를 넘는 메시지를 저널로 보냄
+    unsigned cap = g_async ? ASYNC_PENDING : QUEUE_SIZE;
+    unsigned depth = queue_depth(r);
+
+    if (!r->paused && depth >= cap * QUEUE_HIGH_PCT / 100) {
+        r->paused = 1;
+        alog_warn("Backpressure: reads paused (reactor %d, queue %u/%u)", r->id, depth, cap);
+    } else if (r->paused && depth <= cap * QUEUE_LOW_PCT / 100) {
+        r->paused = 0;
+        r->spill_full = 0;      // 저널이 받지 못했으면 이번 멈춤이 끝난 뒤 다시 시도
+        alog_info("Backpressure: reads resumed (reactor %d, queue %u/%u)", r->id, depth, cap);
+    }
+    return r->paused;
+}
+
+// 저널 재생 (스레드 하나). 설명은 spill 저널 절 참고. arg = COPY 버퍼 (main 이 할당, 여기서 해제)
+static void *spill_replayer(void *arg) {
+    db_msg_t *msgs[BATCH_MAX];
+    char rec[sizeof(int) + BUF_SIZE];
+    char *copy_buf = arg;
+    PGconn *conn = NULL;
+    struct timespec idle = { 0, SPILL_REPLAY_MS * 1000000L };
+    struct timespec retry = { HK_INTERVAL_MS / 1000, HK_INTERVAL_MS % 1000 * 1000000L };
+
+    while (!atomic_load(&g_spill_stop)) {
+        // 스레드 모드는 워커가 밀려 있으면 재생이 경쟁만 늘리므로 기다림
+        if (!spill_pending(&g_spill) ||
+            (!g_async && mpmc_size(&g_queue) > QUEUE_SIZE * QUEUE_LOW_PCT / 100)) {
+            spill_sync(&g_spill);
+            nanosleep(&idle, NULL);
+            continue;
+        }
+        if (conn == NULL || PQstatus(conn) != CONNECTION_OK) {
+            if (conn)
+                PQfinish(conn);
+            conn = PQconnectdb(g_conninfo);
+            if (PQstatus(conn) != CONNECTION_OK) {
+                nanosleep(&retry, NULL);
+                continue;
+            }
+        }
+
+        int n = 0, oom = 0;
+        ssize_t len;
+        while (n < BATCH_MAX && (len = spill_read(&g_spill, rec, sizeof(rec))) != 0) {
+            if (len < (ssize_t)sizeof(int)) {
+                alog_limited(ALOG_ERROR, 10, "Spill journal: skipped malformed record (%zd bytes)", len);
+                continue;
+            }
+            db_msg_t *msg = slab_alloc(&g_msg_cache);
+            if (msg == NULL) {
+                // 읽은 기록은 아직 commit 전 → 되감아 다음에 다시 읽음
+                alog_limited(ALOG_ERROR, 10, "Spill replay: out of message buffers, retrying");
+                oom = 1;
+                break;
+            }
+            memcpy(&msg->client_fd, rec, sizeof(int));
+            msg->t_recv = 0;
+            msg->len = (int)(len - (ssize_t)sizeof(int));
+            memcpy(msg->data, rec + sizeof(int), msg->len);
+            msg->data[msg->len] = '\0';
+            msgs[n++] = msg;
+        }
+
+        int rc = oom ? -1 : n > 0 ? copy_rows(conn, copy_buf, msgs, n) : 0;
+        if (rc == 0 && spill_commit(&g_spill) == 0) {
+            if (n > 0)
+                alog_limited(ALOG_INFO, 10, "Replayed %d rows from spill journal (%ld total)",
+                             n, atomic_load(&g_spill.replayed));
+        } else {
+            spill_rewind(&g_spill);
+            nanosleep(&retry, NULL);
+        }
+        for (int i = 0; i < n; i++)
+            slab_free(&g_msg_cache, msgs[i]);
+    }
+    if (conn)
+        PQfinish(conn);
+    free(copy_buf);
+    return NULL;
+}
+
+static void stall_add(reactor_t *r, sock_buffer_t *buf) {
+    if (buf->stalled)
+        return;
+    buf->stalled = 1;
+    buf->stall_next = NULL;
+    buf->stall_prev = r->stall_tail;
+    if (r->stall_tail)
+        r->stall_tail->stall_next = buf;
+    else
+        r->stall_head = buf;
+    r->stall_tail = buf;
+}
+
+static void stall_del(reactor_t *r, sock_buffer_t *buf) {
+    if (!buf->stalled)
+        return;
+    buf->stalled = 0;
+    if (buf->stall_prev)
+        buf->stall_prev->stall_next = buf->stall_next;
+    else
+        r->stall_head = buf->stall_next;
+    if (buf->stall_next)
+        buf->stall_next->stall_prev = buf->stall_prev;
+    else
+        r->stall_tail = buf->stall_prev;
+}
+
+static int reactor_init(reactor_t *r) {
+    int opt = 1;
+    struct sockaddr_in addr;
+    struct epoll_event ev;
+
+    for (int i = 0; i < ASYNC_DB_CONNS; i++) {
+        r->db[i].kind = EV_DB;
+        r->db[i].state = ADB_DOWN;
+        r->db[i].fd = -1;
+    }
+    r->epfd = -1;
+    r->timer_ev = EV_TIMER;
+    if (tw_init(&r->wheel, TW_TICK_MS, r) != 0)
         return -1;
+
+    r->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (r->listen_fd < 0)
+        return -1;
+    setsockopt(r->listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    setsockopt(r->listen_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(PORT);
+    if (bind(r->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(r->listen_fd, LISTEN_BACKLOG) < 0)
+        return -1;
+
+    // io_uring 링은 SINGLE_ISSUER 라 reactor 스레드가 직접 만듦 (ur_main)
+    if (g_backend == BACKEND_URING)
+        return 0;
+
+    r->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (r->epfd < 0)
+        return -1;
+    ev.events = EPOLLIN;
+    ev.data.ptr = &r->timer_ev;
+    if (epoll_ctl(r->epfd, EPOLL_CTL_ADD, tw_fd(&r->wheel), &ev) < 0)
+        return -1;
+    ev.data.ptr = NULL;     // NULL = listener, 나머지는 enum ev_kind 로 시작하는 객체
+    return epoll_ctl(r->epfd, EPOLL_CTL_ADD, r->listen_fd, &ev);
+}
+
+// ─── 연결 시간 제한 ─────────────────────────────────────────
+// 연결마다 타이머 하나를 휠에 걸어 둠 (arm/다시 arm/cancel 모두 O(1), 확인은 만료되는 것만)
+//   받은 데이터를 처리한 뒤 링이 비었으면 idle 마감을 새로 걸고, 프레임 조각이 남았으면
+//   읽기 마감을 검. 읽기 마감은 프레임이 새로 완성될 때만 늘어나므로 조금씩 흘려 보내는
+//   연결(slowloris)도 READ_TIMEOUT_MS 안에 프레임을 끝내지 못하면 끊김.
+//   backpressure 로 멈춘 연결은 우리가 안 읽는 것이므로 만료돼도 다시 걸고 둠
+
+static void conn_timeout(tw_timer *t, void *ctx);
+
+static void conn_touch(reactor_t *r, sock_buffer_t *buf) {
+    if (buf->rx.tail == buf->rx.head) {
+        buf->deadline = DEADLINE_IDLE;
+        tw_arm(&r->wheel, &buf->timer, IDLE_TIMEOUT_MS);
+    } else if (buf->deadline != DEADLINE_READ || buf->frames != buf->frames_at) {
+        buf->deadline = DEADLINE_READ;
+        buf->frames_at = buf->frames;
+        tw_arm(&r->wheel, &buf->timer, READ_TIMEOUT_MS);
     }
-    
-    memcpy(queue->tasks[queue->tail].data, data, len);
-    queue->tasks[queue->tail].len = len;
-    queue->tasks[queue->tail].client_fd = client_fd;
-    
-    queue->tail = (queue->tail + 1) % QUEUE_SIZE;
-    queue->count++;
-    
-    pthread_cond_signal(&queue->cond);
-    pthread_mutex_unlock(&queue->lock);
-    
+}
+
+static void conn_init(reactor_t *r, sock_buffer_t *buf, int fd) {
+    buf->kind = EV_CLIENT;
+    buf->fd = fd;
+    rx_ring_init(&buf->rx);
+    buf->stalled = 0;
+    buf->armed = 0;
+    buf->canceling = 0;
+    buf->closing = 0;
+    buf->held_head = buf->held_tail = -1;
+    buf->rx_at = 0;
+    buf->frames = 0;
+    buf->deadline = 0;
+    tw_timer_init(&buf->timer, conn_timeout);
+    conn_touch(r, buf);
+}
+
+static void close_client(reactor_t *r, sock_buffer_t *buf) {
+    tw_cancel(&r->wheel, &buf->timer);
+    stall_del(r, buf);
+    epoll_ctl(r->epfd, EPOLL_CTL_DEL, buf->fd, NULL);
+    close(buf->fd);
+    r->nsys += 2;
+    rx_ring_release(&g_rx_pool, &buf->rx);
+    slab_free(&g_buf_cache, buf);
+}
+
+// 대기 중인 연결을 다 받음 (listener 는 level-triggered)
+static void reactor_accept(reactor_t *r) {
+    struct epoll_event ev;
+
+    while (1) {
+        int client_fd = accept4(r->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        r->nsys++;
+        if (client_fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                alog_error("accept: %s", strerror(errno));
+            return;
+        }
+
+        sock_buffer_t *buf = slab_alloc(&g_buf_cache);
+        if (buf == NULL) {
+            alog_limited(ALOG_ERROR, 10, "Out of connection buffers: refusing fd=%d (reactor %d)",
+                         client_fd, r->id);
+            close(client_fd);
+            r->nsys++;
+            continue;
+        }
+        conn_init(r, buf, client_fd);
+
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.ptr = buf;
+        epoll_ctl(r->epfd, EPOLL_CTL_ADD, client_fd, &ev);
+        r->nsys++;
+
+        alog_limited(ALOG_INFO, 100, "Client connected: fd=%d (reactor %d)", client_fd, r->id);
+    }
+}
+
+// 완성된 프레임 하나를 메시지로 만들어 DB 쪽으로 넘김 (링 → 메시지 복사 1 회)
+// -1 = 저널이 받지 못함: 프레임은 링에 그대로 두고 읽기를 멈춤 (버리지 않음)
+static int reactor_submit(reactor_t *r, int fd, const rx_frame *f, uint64_t t_recv) {
+    if (g_sink) {
+        r->nmsg++;
+        return 0;
+    }
+
+    db_msg_t *msg = slab_alloc(&g_msg_cache);
+    if (msg == NULL) {
+        alog_limited(ALOG_ERROR, 10, "Out of message buffers: frame dropped (fd=%d, reactor %d)", fd, r->id);
+        return 0;
+    }
+    msg->len = (int)rx_frame_copy(f, msg->data);
+    msg->data[msg->len] = '\0'; // null-terminate
+    msg->client_fd = fd;
+    msg->t_recv = t_recv;
+    alog_debug("recv(fd=%d): %.*s", fd, msg->len, msg->data);
+
+    // DB에 비동기 저장 (async: 이 reactor 의 대기열, 아니면 DB 워커 큐)
+    unsigned cap = g_async ? ASYNC_PENDING : QUEUE_SIZE;
+    if (g_spill_on && queue_depth(r) >= cap * QUEUE_HIGH_PCT / 100) {
+        int rc = spill_msg(msg);
+        slab_free(&g_msg_cache, msg);
+        if (rc != 0) {
+            alog_limited(ALOG_ERROR, 10, "Spill journal append failed: pausing reads (reactor %d)", r->id);
+            r->spill_full = 1;
+            return -1;
+        }
+        alog_limited(ALOG_WARN, 10, "Spilled rows to journal (queue above high watermark)");
+    } else if (g_async && pending_count(r) < ASYNC_PENDING) {
+        r->pending[r->pend_tail++ & (ASYNC_PENDING - 1)] = msg;
+    } else if (g_async || mpmc_push(&g_queue, msg) < 0) {
+        alog_limited(ALOG_WARN, 10, "Task queue full! (reactor %d)", r->id);
+        slab_free(&g_msg_cache, msg);
+    }
+    r->nmsg++;
     return 0;
 }
 
-// 작업 가져오기
-int dequeue_task(task_queue_t *queue, db_task_t *task) {
-    pthread_mutex_lock(&queue->lock);
-    
-    while (queue->count == 0 && !queue->shutdown) {
-        pthread_cond_wait(&queue->cond, &queue->lock);
+// 링에 모인 완성 프레임을 넘김. DB 큐가 차 있으면 남은 프레임은 링에 두고 멈춘 목록에 올림.
+// 1 = 계속 읽어도 됨, 0 = 멈춤, -1 = 프로토콜 오류 (호출자가 닫음)
+static int client_drain(reactor_t *r, sock_buffer_t *buf) {
+    rx_frame f;
+    int rc = 0;
+
+    while (!reactor_paused(r) && (rc = rx_ring_next(&buf->rx, BUF_SIZE, &f)) == 1) {
+        if (reactor_submit(r, buf->fd, &f, buf->rx_at) < 0) {
+            // 넘기지 못한 프레임은 링에 되돌려 놓고 멈춤 목록으로 (재개하면 여기서부터)
+            buf->rx.head -= RX_FRAME_HDR + f.len;
+            continue;       // reactor_paused 가 spill_full 을 보고 멈춤
+        }
+        buf->frames++;
     }
-    
-    if (queue->shutdown && queue->count == 0) {
-        pthread_mutex_unlock(&queue->lock);
+    if (rc < 0) {
+        alog_limited(ALOG_WARN, 10, "Frame too long: fd=%d", buf->fd);
         return -1;
     }
-    
-    *task = queue->tasks[queue->head];
-    queue->head = (queue->head + 1) % QUEUE_SIZE;
-    queue->count--;
-    
-    pthread_mutex_unlock(&queue->lock);
-    return 0;
+    if (r->paused) {
+        stall_add(r, buf);
+        return 0;
+    }
+    return 1;
 }
 
-// 워커 스레드 - DB에 비동기 저장
-void* db_worker(void *arg) {
+// 프레임 = 4 바이트 big-endian 길이 + 본문. 한 번의 읽기에 여러 프레임이 오거나
+// 한 프레임이 여러 읽기에 걸쳐 와도 링에 모았다가 완성된 것만 꺼냄.
+// 멈추면 안 읽은 바이트는 커널에 남음
+static void reactor_read(reactor_t *r, sock_buffer_t *buf) {
+    int fd = buf->fd;
+
     while (1) {
-        db_task_t task;
-        
-        if (dequeue_task(g_queue, &task) < 0) {
-            break; // shutdown
+        // 링에 이미 있는 프레임부터 (멈췄다 재개한 경우 남아 있음)
+        int rc = client_drain(r, buf);
+        if (rc < 0) {
+            close_client(r, buf);
+            return;
         }
-        
-        PGconn *conn = get_pg_conn(g_pool);
-        
-        // SQL 준비 (테이블: messages, 컬럼: client_fd, data, timestamp)
-        const char *paramValues[2];
-        char fd_str[32];
-        snprintf(fd_str, sizeof(fd_str), "%d", task.client_fd);
-        paramValues[0] = fd_str;
-        paramValues[1] = task.data;
-        
-        PGresult *res = PQexecParams(conn,
-            "INSERT INTO messages (client_fd, data, timestamp) VALUES ($1, $2, NOW())",
-            2,
-            NULL,
-            paramValues,
-            NULL,
-            NULL,
-            0);
-        
-        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
-            fprintf(stderr, "INSERT failed: %s", PQerrorMessage(conn));
+        if (rc == 0)
+            return;
+
+        uint64_t t = lat_now();
+        ssize_t n = rx_ring_recv(&g_rx_pool, &buf->rx, fd);
+        r->nsys++;
+        if (n > 0) {
+            // 빈 읽기(EAGAIN)는 recv 단계에 넣지 않음
+            buf->rx_at = lat_since(r->lat, LAT_RECV, t);
+            continue;
+        }
+        if (n == 0) {
+            alog_limited(ALOG_INFO, 100, "Client disconnected: fd=%d", fd);
+            close_client(r, buf);
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            alog_limited(ALOG_ERROR, 10, "recv: %s", strerror(errno));
+            close_client(r, buf);
         } else {
-            printf("Data saved to DB: fd=%d, len=%d\n", task.client_fd, task.len);
+            // 다 읽었음: 남은 조각이 없으면 링 버퍼를 pool 로 돌려줌
+            rx_ring_trim(&g_rx_pool, &buf->rx);
+            conn_touch(r, buf);
         }
-        
-        PQclear(res);
-        release_pg_conn(g_pool, conn);
+        return;
     }
-    
+}
+
+// ─── io_uring 백엔드 ────────────────────────────────────────
+// epoll 의 "준비됨 → recv" 대신 커널이 읽기까지 해서 결과만 CQ 에 올림:
+//   multishot accept : SQE 1 개로 모든 연결을 받고, 소켓은 고정 파일 테이블 칸으로 (fd 없음)
+//   multishot recv   : 연결마다 SQE 1 개. 데이터가 올 때마다 provided buffer 하나에 채워 CQE
+//   registered files : 매 요청의 fd 조회/참조 카운트 비용이 없음
+// syscall 은 루프 1 회에 io_uring_enter 1 번 (제출 + 대기). 받은 버퍼는 연결의 수신 링에
+// 붙여 같은 프레이밍/backpressure 를 탐. 멈출 때는 recv 를 취소해 데이터를 커널에 남김.
+// 연결 id(client_fd) 는 고정 파일 칸 번호
+
+#define URING_ENTRIES   1024
+#define URING_FILES     4096    // reactor 당 최대 연결
+#define URING_BUFS      1024    // provided buffer 수 (2의 거듭제곱)
+#define URING_BUF_SIZE  4096
+#define URING_BGID      1
+#define UR_NO_BUF       0xffff  // held_next 의 끝
+
+enum ur_op {
+    UR_ACCEPT = 1,
+    UR_RECV,
+    UR_CLOSE,
+    UR_CANCEL,
+    UR_TIMER
+};
+
+#define UR_DATA(op, slot)  (((uint64_t)(op) << 32) | (uint32_t)(slot))
+
+static unsigned g_uring_flags;  // ur_probe 가 고른 IORING_SETUP_*
+
+// 필요한 기능(고정 파일 테이블, buffer ring)이 되는지 미리 봄. 0 이면 io_uring 사용
+static int ur_probe(void) {
+    uring u;
+    uring_bufs b;
+    unsigned flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    int rc = uring_init(&u, 8, flags);
+
+    if (rc == -EINVAL) {
+        flags = 0;      // 6.1 이전 커널
+        rc = uring_init(&u, 8, flags);
+    }
+    if (rc < 0)
+        return rc;
+    rc = uring_register_files_sparse(&u, 8);
+    if (rc == 0) {
+        rc = uring_bufs_init(&u, &b, URING_BGID, 8, 64);
+        if (rc == 0)
+            uring_bufs_destroy(&u, &b);
+    }
+    uring_exit(&u);
+    if (rc == 0)
+        g_uring_flags = flags;
+    return rc;
+}
+
+static struct io_uring_sqe *ur_sqe(reactor_t *r) {
+    struct io_uring_sqe *sqe = uring_get_sqe(&r->ring);
+    while (sqe == NULL) {
+        // CQ 를 비우지 않아 SQ 가 안 빠지는 경우: 완료를 기다렸다 다시
+        uring_submit_wait(&r->ring, 1, -1);
+        sqe = uring_get_sqe(&r->ring);
+    }
+    return sqe;
+}
+
+static void ur_arm_accept(reactor_t *r) {
+    uring_prep_accept_multishot_direct(ur_sqe(r), r->listen_fd, UR_DATA(UR_ACCEPT, 0));
+}
+
+static void ur_arm_recv(reactor_t *r, sock_buffer_t *buf) {
+    uring_prep_recv_multishot_fixed(ur_sqe(r), buf->fd, URING_BGID, UR_DATA(UR_RECV, buf->fd));
+    buf->armed = 1;
+}
+
+static void ur_cancel_recv(reactor_t *r, sock_buffer_t *buf) {
+    if (!buf->armed || buf->canceling)
+        return;
+    uring_prep_cancel(ur_sqe(r), UR_DATA(UR_RECV, buf->fd), UR_DATA(UR_CANCEL, buf->fd));
+    buf->canceling = 1;
+}
+
+// recv 가 살아 있으면 취소부터 (마지막 recv CQE 에서 close). 칸은 close 가 끝나야 비므로
+// 그 전에 같은 칸으로 새 연결이 들어오지 않음
+static void ur_close(reactor_t *r, sock_buffer_t *buf) {
+    if (buf->closing)
+        return;
+    buf->closing = 1;
+    tw_cancel(&r->wheel, &buf->timer);
+    stall_del(r, buf);
+    if (buf->armed)
+        ur_cancel_recv(r, buf);
+    else
+        uring_prep_close_fixed(ur_sqe(r), buf->fd, UR_DATA(UR_CLOSE, buf->fd));
+}
+
+// backpressure 로 recv 를 취소해도 이미 끝났거나 취소와 엇갈린 CQE 는 계속 옴. 링이 최대
+// 크기로 차 있으면 그 provided buffer 를 돌려주지 않고 연결에 잡아 둠 (끊지 않음).
+// 잡아 둘 수 있는 수는 취소 전에 받은 CQE 수로 제한됨
+static void ur_hold(reactor_t *r, sock_buffer_t *buf, unsigned bid, int len) {
+    r->held_next[bid] = UR_NO_BUF;
+    r->held_len[bid] = (uint16_t)len;
+    if (buf->held_tail >= 0)
+        r->held_next[buf->held_tail] = (uint16_t)bid;
+    else
+        buf->held_head = (int)bid;
+    buf->held_tail = (int)bid;
+}
+
+// 잡아 둔 buffer 를 들어가는 만큼 링으로 옮기고 커널에 돌려줌. 반환 = 옮긴 수
+static int ur_unhold(reactor_t *r, sock_buffer_t *buf) {
+    int moved = 0;
+
+    while (buf->held_head >= 0) {
+        unsigned bid = (unsigned)buf->held_head;
+        if (rx_ring_append(&g_rx_pool, &buf->rx, uring_buf_addr(&r->bufs, bid), r->held_len[bid]) != 0)
+            break;
+        buf->held_head = r->held_next[bid] == UR_NO_BUF ? -1 : r->held_next[bid];
+        if (buf->held_head < 0)
+            buf->held_tail = -1;
+        uring_buf_recycle(&r->bufs, bid);
+        moved++;
+    }
+    return moved;
+}
+
+// 링의 프레임을 넘기고, 멈추지 않았으면 recv 를 (다시) 건다
+static void ur_continue(reactor_t *r, sock_buffer_t *buf) {
+    int rc, moved;
+
+    // 멈추지 않은 채 다 넘기면 링에는 미완성 프레임 하나만 남으므로 잡아 둔 buffer 가 줄어듦
+    do {
+        moved = ur_unhold(r, buf);
+        rc = client_drain(r, buf);
+    } while (rc > 0 && moved > 0 && buf->held_head >= 0);
+    if (rc < 0) {
+        ur_close(r, buf);
+    } else if (rc == 0) {
+        ur_cancel_recv(r, buf);     // 더 받지 않음 → 커널 버퍼가 차고 TCP 윈도가 닫힘
+    } else {
+        rx_ring_trim(&g_rx_pool, &buf->rx);
+        conn_touch(r, buf);
+        if (!buf->armed)
+            ur_arm_recv(r, buf);
+    }
+}
+
+// 휠의 timerfd 가 읽을 수 있게 될 때마다 CQE (multishot poll)
+static void ur_arm_timer(reactor_t *r) {
+    uring_prep_poll_multishot(ur_sqe(r), tw_fd(&r->wheel), UR_DATA(UR_TIMER, 0));
+}
+
+// 휠 콜백 (tw_expire 안, reactor 스레드). 설명은 연결 시간 제한 절 참고
+static void conn_timeout(tw_timer *t, void *ctx) {
+    reactor_t *r = ctx;
+    sock_buffer_t *buf = (sock_buffer_t *)((char *)t - offsetof(sock_buffer_t, timer));
+
+    if (buf->closing)
+        return;
+    if (buf->stalled) {
+        tw_arm(&r->wheel, &buf->timer,
+               buf->deadline == DEADLINE_READ ? READ_TIMEOUT_MS : IDLE_TIMEOUT_MS);
+        return;
+    }
+    alog_limited(ALOG_INFO, 100, "Client timed out (%s): fd=%d (reactor %d)",
+                 buf->deadline == DEADLINE_READ ? "partial frame" : "idle", buf->fd, r->id);
+    if (g_backend == BACKEND_URING)
+        ur_close(r, buf);
+    else
+        close_client(r, buf);
+}
+
+static void ur_on_accept(reactor_t *r, const struct io_uring_cqe *cqe) {
+    if (!(cqe->flags & IORING_CQE_F_MORE))
+        ur_arm_accept(r);           // 오류 등으로 multishot 이 끝남 → 다시 검
+    if (cqe->res < 0) {
+        alog_error("accept: %s", strerror(-cqe->res));
+        return;
+    }
+
+    sock_buffer_t *buf = slab_alloc(&g_buf_cache);
+    if (buf == NULL) {
+        // 칸만 닫음 (conns[칸] 이 NULL 이라 ur_on_close 는 할 일 없음)
+        alog_limited(ALOG_ERROR, 10, "Out of connection buffers: refusing slot=%d (reactor %d)",
+                     cqe->res, r->id);
+        uring_prep_close_fixed(ur_sqe(r), cqe->res, UR_DATA(UR_CLOSE, cqe->res));
+        return;
+    }
+    conn_init(r, buf, cqe->res);    // fd = 고정 파일 칸
+    r->conns[buf->fd] = buf;
+    alog_limited(ALOG_INFO, 100, "Client connected: slot=%d (reactor %d, io_uring)", buf->fd, r->id);
+    ur_continue(r, buf);
+}
+
+static void ur_on_recv(reactor_t *r, sock_buffer_t *buf, const struct io_uring_cqe *cqe) {
+    if (!(cqe->flags & IORING_CQE_F_MORE)) {
+        buf->armed = 0;
+        buf->canceling = 0;
+    }
+    if (cqe->flags & IORING_CQE_F_BUFFER) {
+        unsigned bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+        if (cqe->res > 0)
+            buf->rx_at = r->rx_at;
+        if (cqe->res > 0 && !buf->closing &&
+            (buf->held_head >= 0 ||
+             rx_ring_append(&g_rx_pool, &buf->rx, uring_buf_addr(&r->bufs, bid), cqe->res) != 0)) {
+            if (buf->canceling || buf->stalled || r->paused) {
+                ur_hold(r, buf, bid, cqe->res);     // 재개 때 링으로 (순서 유지)
+                bid = UR_NO_BUF;
+            } else {
+                alog_limited(ALOG_WARN, 10, "Receive ring overflow: slot=%d", buf->fd);
+                ur_close(r, buf);
+            }
+        }
+        if (bid != UR_NO_BUF)
+            uring_buf_recycle(&r->bufs, bid);
+    }
+
+    if (buf->closing) {
+        if (!buf->armed)
+            uring_prep_close_fixed(ur_sqe(r), buf->fd, UR_DATA(UR_CLOSE, buf->fd));
+        return;
+    }
+    if (cqe->res == 0) {
+        alog_limited(ALOG_INFO, 100, "Client disconnected: slot=%d", buf->fd);
+        ur_close(r, buf);
+        return;
+    }
+    // ENOBUFS: buffer 가 잠깐 바닥남 (위에서 돌려줬으므로 다시 걸면 됨), ECANCELED: backpressure 취소
+    if (cqe->res < 0 && cqe->res != -ENOBUFS && cqe->res != -ECANCELED) {
+        alog_limited(ALOG_ERROR, 10, "recv: %s", strerror(-cqe->res));
+        ur_close(r, buf);
+        return;
+    }
+    ur_continue(r, buf);
+}
+
+static void ur_on_close(reactor_t *r, int slot) {
+    sock_buffer_t *buf = r->conns[slot];
+    if (buf == NULL)
+        return;                     // 버퍼 없이 받자마자 닫은 칸
+    r->conns[slot] = NULL;
+    while (buf->held_head >= 0) {
+        unsigned bid = (unsigned)buf->held_head;
+        buf->held_head = r->held_next[bid] == UR_NO_BUF ? -1 : r->held_next[bid];
+        uring_buf_recycle(&r->bufs, bid);
+    }
+    rx_ring_release(&g_rx_pool, &buf->rx);
+    slab_free(&g_buf_cache, buf);
+}
+
+static void ur_dispatch(reactor_t *r, const struct io_uring_cqe *cqe) {
+    int op = (int)(cqe->user_data >> 32);
+    int slot = (int)(uint32_t)cqe->user_data;
+
+    switch (op) {
+    case UR_ACCEPT:
+        ur_on_accept(r, cqe);
+        break;
+    case UR_RECV:
+        if (r->conns[slot])
+            ur_on_recv(r, r->conns[slot], cqe);
+        break;
+    case UR_CLOSE:
+        ur_on_close(r, slot);
+        break;
+    case UR_TIMER:
+        if (cqe->res < 0) {
+            // 실패 CQE 로 multishot 이 끝남. 다시 안 걸면 이 reactor 의 시간 제한이 조용히 멈춤
+            if (++r->timer_errs <= TIMER_POLL_RETRY) {
+                alog_error("timer poll (reactor %d): %s, re-arming", r->id, strerror(-cqe->res));
+                ur_arm_timer(r);
+            } else {
+                alog_error("timer poll (reactor %d): %s, giving up: connection timeouts disabled",
+                           r->id, strerror(-cqe->res));
+            }
+            break;
+        }
+        r->timer_errs = 0;
+        if (!(cqe->flags & IORING_CQE_F_MORE))
+            ur_arm_timer(r);
+        tw_expire(&r->wheel);
+        break;
+    default:
+        break;      // UR_CANCEL: 결과는 해당 recv 의 마지막 CQE 로 옴
+    }
+}
+
+// 큐가 low 아래로 내려가면 멈춘 연결을 오래된 것부터 다시 읽음 (edge-triggered/취소된
+// recv 라 새 이벤트가 오지 않으므로 직접 재개해야 함)
+static void reactor_resume(reactor_t *r) {
+    while (r->stall_head && !reactor_paused(r)) {
+        sock_buffer_t *buf = r->stall_head;
+        stall_del(r, buf);
+        if (g_backend == BACKEND_URING)
+            ur_continue(r, buf);
+        else
+            reactor_read(r, buf);
+    }
+}
+
+// -n 모드: 초마다 처리량과 메시지당 syscall 수
+static void reactor_stats(reactor_t *r) {
+    if (!g_sink)
+        return;
+    long now = now_us();
+    if (now - r->stat_at < 1000000)
+        return;
+    long sys = g_backend == BACKEND_URING ? (long)r->ring.nenter : r->nsys;
+    long msgs = r->nmsg - r->stat_msg;
+    if (msgs > 0)
+        alog_info("reactor %d [%s]: %.0f msgs/s, %.4f syscalls/msg", r->id,
+               g_backend == BACKEND_URING ? "io_uring" : "epoll",
+               msgs * 1e6 / (now - r->stat_at), (double)(sys - r->stat_sys) / msgs);
+    r->stat_at = now;
+    r->stat_msg = r->nmsg;
+    r->stat_sys = sys;
+}
+
+// 단계별 p50/p99/p999 (기록된 단계만)
+static void lat_dump(void) {
+    for (int i = 0; i < LAT_NSTAGES; i++) {
+        lat_summary ls;
+        lat_summarize(&g_lat, i, &ls);
+        if (ls.count == 0)
+            continue;
+        alog_info("latency %-6s n=%llu mean=%.1fus p50=%.1fus p99=%.1fus p999=%.1fus max=%.1fus",
+                  LAT_NAMES[i], (unsigned long long)ls.count, ls.mean / 1e3, ls.p50 / 1e3,
+                  ls.p99 / 1e3, ls.p999 / 1e3, ls.max / 1e3);
+    }
+}
+
+// 모든 스레드가 SIGUSR1 을 막아 두고 이 스레드만 sigwait → 핸들러 제약 없이 집계·로그
+static void *lat_signal_main(void *arg) {
+    sigset_t *set = (sigset_t *)arg;
+    int sig;
+    while (sigwait(set, &sig) == 0)
+        lat_dump();
+    return NULL;
+}
+
+static void *ur_main(reactor_t *r) {
+    int rc = uring_init(&r->ring, URING_ENTRIES, g_uring_flags);
+    r->conns = calloc(URING_FILES, sizeof(sock_buffer_t *));
+    r->held_next = malloc(URING_BUFS * sizeof(uint16_t));
+    r->held_len = malloc(URING_BUFS * sizeof(uint16_t));
+    if (r->conns == NULL || r->held_next == NULL || r->held_len == NULL)
+        rc = -ENOMEM;
+    if (rc == 0)
+        rc = uring_register_files_sparse(&r->ring, URING_FILES);
+    if (rc == 0)
+        rc = uring_bufs_init(&r->ring, &r->bufs, URING_BGID, URING_BUFS, URING_BUF_SIZE);
+    if (rc < 0) {
+        alog_error("io_uring init failed (reactor %d): %s", r->id, strerror(-rc));
+        return NULL;
+    }
+
+    ur_arm_accept(r);
+    ur_arm_timer(r);
+    while (1) {
+        // 제출 + 완료 대기를 한 번에. 멈춘 연결이 있으면 큐가 비는 것을 보러 깨어남
+        rc = uring_submit_wait(&r->ring, 1, r->stall_head ? STALL_POLL_MS : -1);
+        r->rx_at = lat_now();       // 이번에 받은 CQE 들의 프레임 도착 시각
+        if (rc < 0 && rc != -ETIME && rc != -EINTR && rc != -EBUSY) {
+            alog_error("io_uring_enter: %s", strerror(-rc));
+            break;
+        }
+        struct io_uring_cqe *cqe;
+        while ((cqe = uring_peek(&r->ring)) != NULL) {
+            struct io_uring_cqe c = *cqe;
+            uring_advance(&r->ring, 1);
+            ur_dispatch(r, &c);
+        }
+        if (r->stall_head)
+            reactor_resume(r);
+        reactor_stats(r);
+    }
+    uring_bufs_destroy(&r->ring, &r->bufs);
+    uring_exit(&r->ring);
     return NULL;
 }
 
-int set_nonblock(int fd) {
-    int flags = fcntl(fd, F_GETFL, 0);
-    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+static void *reactor_main(void *arg) {
+    reactor_t *r = (reactor_t *)arg;
+    struct epoll_event events[MAX_EVENTS];
+
+    if (r->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(r->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    r->stat_at = now_us();
+    r->lat = lat_register(&g_lat);
+    if (g_backend == BACKEND_URING)
+        return ur_main(r);
+
+    if (g_async)
+        async_kick(r);
+    while (1) {
+        // 멈춘 연결이 있으면 큐가 비는 것을 보러, async 는 끊긴 DB 커넥션 재시도를 위해 깨어남
+        int timeout = r->stall_head ? STALL_POLL_MS : g_async ? ASYNC_RETRY_MS : -1;
+        int n = epoll_wait(r->epfd, events, MAX_EVENTS, timeout);
+        r->nsys++;
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            alog_error("epoll_wait: %s", strerror(errno));
+            break;
+        }
+
+        int ticked = 0;
+        for (int i = 0; i < n; i++) {
+            void *ptr = events[i].data.ptr;
+            if (ptr == NULL)
+                reactor_accept(r);
+            else if (*(int *)ptr == EV_CLIENT)
+                reactor_read(r, (sock_buffer_t *)ptr);
+            else if (*(int *)ptr == EV_TIMER)
+                ticked = 1;
+            else
+                adb_on_event(r, (async_db_t *)ptr, events[i].events);
+        }
+        // 만료 처리는 배치가 끝난 뒤 (콜백이 닫은 연결의 이벤트가 같은 배치에 남아 있을 수 있음)
+        if (ticked) {
+            tw_expire(&r->wheel);
+            r->nsys++;
+        }
+        if (g_async)
+            async_kick(r);
+        if (r->stall_head)
+            reactor_resume(r);
+        reactor_stats(r);
+    }
+    return NULL;
 }
 
-int main() {
+// 사용법: server [-a] [-u] [-n] [-j dir] [reactor 수]
+//   -a : DB 워커 없이 reactor 가 non-blocking libpq 로 직접 저장
+//   -u : io_uring 백엔드 (안 되는 커널이면 epoll 로)
+//   -n : DB 없이 받은 프레임을 세고 버림 (I/O 벤치)
+//   -j : DB 가 밀리면 읽기를 멈추는 대신 dir 의 spill 저널로 (재시작하면 남은 것부터 재생)
+//   ALOG_LEVEL=debug 면 받은 프레임마다 로그 (기본 info)
+//   kill -USR1 <pid> 로 단계별 지연 p50/p99/p999 를 로그
+int main(int argc, char **argv) {
+    int nreactor = 0;
+    const char *spill_dir = NULL;
+    pthread_t replayer, lat_thread_id;
+    static sigset_t lat_sigs;
+
+    // 이후 만드는 스레드(로그 flusher 포함)가 모두 물려받도록 가장 먼저
+    sigemptyset(&lat_sigs);
+    sigaddset(&lat_sigs, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &lat_sigs, NULL);
+    lat_set_init(&g_lat, LAT_NSTAGES, LAT_NAMES);
+    pthread_create(&lat_thread_id, NULL, lat_signal_main, &lat_sigs);
+    pthread_detach(lat_thread_id);
+
+    // 로그는 flusher 스레드가 씀. 어느 return 으로 끝나도 남은 기록을 비우도록 atexit
+    if (alog_init(STDOUT_FILENO, STDERR_FILENO) == 0)
+        atexit(alog_shutdown);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-a") == 0)
+            g_async = 1;
+        else if (strcmp(argv[i], "-u") == 0)
+            g_backend = BACKEND_URING;
+        else if (strcmp(argv[i], "-n") == 0)
+            g_sink = 1;
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+            spill_dir = argv[++i];
+        else
+            nreactor = atoi(argv[i]);
+    }
+    if (g_sink)
+        g_async = 0;
+    if (g_backend == BACKEND_URING && g_async) {
+        // libpq 소켓은 readiness 기반이라 epoll 루프에서만 구동
+        alog_warn("io_uring backend does not drive async DB connections, using epoll");
+        g_backend = BACKEND_EPOLL;
+    }
+    if (g_backend == BACKEND_URING) {
+        int rc = ur_probe();
+        if (rc < 0) {
+            alog_warn("io_uring unavailable (%s), using epoll", strerror(-rc));
+            g_backend = BACKEND_EPOLL;
+        }
+    }
+
     //db pool
-    pthread_t workers[4];
-    {
+    pthread_t workers[DB_WORKERS];
+    slab_init(&g_buf_cache, sizeof(sock_buffer_t));
+    slab_init(&g_msg_cache, sizeof(db_msg_t));
+    if (rx_pool_init(&g_rx_pool) != 0) {
+        alog_error("rx buffer pool init failed");
+        return 1;
+    }
+    if (!g_sink) {
 
-        // PostgreSQL 연결 풀 초기화
-        g_pool = init_pg_pool();
-        printf("PostgreSQL connection pool initialized (%d connections)\n", POOL_SIZE);
-        
-        // 작업 큐 초기화
-        g_queue = init_task_queue();
+        // PostgreSQL 연결 풀 초기화 (async 모드는 테이블 준비에만 씀)
+        snprintf(g_conninfo, sizeof(g_conninfo),
+                "host=%s port=%s dbname=%s user=%s password=%s",
+                DB_HOST, DB_PORT, DB_NAME, DB_USER, DB_PASS);
+        g_pool = conn_pool_create(g_conninfo);
+        if (g_pool == NULL) {
+            alog_error("Connection to database failed: no connection available");
+            return 1;
+        }
+        // 실패/끊긴 커넥션은 하우스키퍼가 재연결해 대기 중인 워커를 깨움
+        conn_pool_housekeeper_start(g_pool, HK_INTERVAL_MS);
+        alog_info("PostgreSQL connection pool initialized (%d connections)", CONN_SIZE);
         
-        // 워커 스레드 생성
-        for (int i = 0; i < 4; i++) {
-            pthread_create(&workers[i], NULL, db_worker, NULL);
+        if (!g_async) {
+            // 작업 큐 초기화
+            if (mpmc_init(&g_queue, QUEUE_SIZE) != 0) {
+                alog_error("task queue init failed");
+                return 1;
+            }
+
+            // 워커 스레드 생성 (COPY 버퍼는 미리 다 할당해 두고 실패하면 시작하지 않음)
+            char *copy_bufs[DB_WORKERS];
+            for (int i = 0; i < DB_WORKERS; i++) {
+                copy_bufs[i] = malloc((size_t)BATCH_MAX * COPY_ROW_MAX);
+                if (copy_bufs[i] == NULL) {
+                    alog_error("COPY buffer allocation failed");
+                    return 1;
+                }
+            }
+            for (int i = 0; i < DB_WORKERS; i++) {
+                pthread_create(&workers[i], NULL, db_worker, copy_bufs[i]);
+            }
+            alog_info("DB worker threads started (%d threads, COPY escape: %s)",
+                   DB_WORKERS, copy_escape_impl());
         }
-        printf("DB worker threads started (4 threads)\n");
         
         // 테이블 생성 (없으면)
-        PGconn *conn = get_pg_conn(g_pool);
+        PGconn *conn = get_conn(g_pool);
         PGresult *res = PQexec(conn,
             "CREATE TABLE IF NOT EXISTS messages ("
             "id SERIAL PRIMARY KEY, "
             "client_fd INT, "
             "data TEXT, "
-            "timestamp TIMESTAMP)");
+            "timestamp TIMESTAMP DEFAULT NOW())");
             
         if (PQresultStatus(res) != PGRES_COMMAND_OK) {
-            fprintf(stderr, "CREATE TABLE failed: %s", PQerrorMessage(conn));
+            const char *err = PQerrorMessage(conn);
+            alog_error("CREATE TABLE failed: %.*s", pq_errlen(err), err);
         }
         PQclear(res);
-        release_pg_conn(g_pool, conn);
-    }
-    
-    // 서버 소켓 설정
-    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    set_nonblock(server_fd);
-    
-    int opt = 1;
-    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        // 기존 테이블에도 COPY 가 생략하는 timestamp 기본값을 보장
+        res = PQexec(conn, "ALTER TABLE messages ALTER COLUMN timestamp SET DEFAULT NOW()");
+        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+            const char *err = PQerrorMessage(conn);
+            alog_error("ALTER TABLE failed: %.*s", pq_errlen(err), err);
+        }
+        PQclear(res);
+        release_conn(g_pool, conn);
 
-    struct sockaddr_in addr;
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(PORT);
+        if (g_async) {
+            conn_pool_destroy(g_pool);
+            g_pool = NULL;
+            alog_info("Async DB mode (%d connections per reactor)", ASYNC_DB_CONNS);
+        }
 
-    bind(server_fd, (struct sockaddr*)&addr, sizeof(addr));
-    listen(server_fd, 128);
+        if (spill_dir) {
+            if (spill_open(&g_spill, spill_dir, SPILL_SEG_SIZE) != 0) {
+                alog_error("spill journal open failed (%s): %s", spill_dir, strerror(errno));
+                return 1;
+            }
+            char *replay_buf = malloc((size_t)BATCH_MAX * COPY_ROW_MAX);
+            if (replay_buf == NULL) {
+                alog_error("COPY buffer allocation failed");
+                return 1;
+            }
+            g_spill_on = 1;
+            pthread_create(&replayer, NULL, spill_replayer, replay_buf);
+            alog_info("Spill journal at %s (%s)", spill_dir,
+                      spill_pending(&g_spill) ? "replaying backlog" : "empty");
+        }
+    } else if (spill_dir) {
+        alog_warn("-j ignored with -n (no DB)");
+    }
     
-    printf("Server listening on port %d\n", PORT);
-
-    int epfd = epoll_create1(0);
-    struct epoll_event ev, events[MAX_EVENTS];
-
-    ev.events = EPOLLIN;
-    ev.data.fd = server_fd;
-    epoll_ctl(epfd, EPOLL_CTL_ADD, server_fd, &ev);
+    // 코어마다 reactor 하나 (SO_REUSEPORT 로 커널이 accept 를 나눠 줌)
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nreactor <= 0)
+        nreactor = ncpu > 0 ? (int)ncpu : 1;
+    if (nreactor > MAX_REACTORS)
+        nreactor = MAX_REACTORS;
 
-    while (1) {
-        int n = epoll_wait(epfd, events, MAX_EVENTS, -1);
-
-        for (int i = 0; i < n; i++) {
-            if (events[i].data.fd == server_fd) {
-                int client_fd = accept(server_fd, NULL, NULL);
-                set_nonblock(client_fd);
+    // reactor 마다 async 대기열이 있어 스택 대신 힙에 둠
+    reactor_t *reactors = calloc(nreactor, sizeof(reactor_t));
+    if (reactors == NULL) {
+        alog_error("calloc: %s", strerror(errno));
+        return 1;
+    }
+    for (int i = 0; i < nreactor; i++) {
+        reactors[i].id = i;
+        reactors[i].cpu = ncpu > 0 ? i % (int)ncpu : -1;
+        if (reactor_init(&reactors[i]) < 0) {
+            alog_error("reactor_init: %s", strerror(errno));
+            return 1;
+        }
+    }
+    for (int i = 0; i < nreactor; i++) {
+        pthread_create(&reactors[i].thread, NULL, reactor_main, &reactors[i]);
+    }
+    alog_info("Server listening on port %d (%d reactors, %s%s)", PORT, nreactor,
+           g_backend == BACKEND_URING ? "io_uring" : "epoll", g_sink ? ", no DB" : "");
 
-                sock_buffer_t *buf = malloc(sizeof(sock_buffer_t));
-                buf->fd = client_fd;
-                buf->buf_len = 0;
+    for (int i = 0; i < nreactor; i++) {
+        pthread_join(reactors[i].thread, NULL);
+    }
 
-                ev.events = EPOLLIN | EPOLLET;
-                ev.data.ptr = buf;
-                epoll_ctl(epfd, EPOLL_CTL_ADD, client_fd, &ev);
+    lat_dump();
+    if (g_spill_on) {
+        atomic_store(&g_spill_stop, 1);
+        pthread_join(replayer, NULL);
+        spill_close(&g_spill);
+    }
+    if (!g_async && !g_sink) {
+        // 종료 처리: 남은 메시지를 다 처리한 워커부터 NULL 을 받고 끝남
+        mpmc_close(&g_queue);
 
-                printf("Client connected: fd=%d\n", client_fd);
-            } else {
-                sock_buffer_t *buf = (sock_buffer_t *)events[i].data.ptr;
-                int fd = buf->fd;
-
-                while (1) {
-                    ssize_t r = recv(fd, buf->buf, BUF_SIZE, 0);
-                    if (r > 0) {
-                        buf->buf_len = r;
-                        buf->buf[r] = '\0'; // null-terminate
-                        printf("recv(fd=%d): %.*s\n", fd, (int)r, buf->buf);
-                        
-                        // DB에 비동기 저장
-                        if (enqueue_task(g_queue, buf->buf, r, fd) < 0) {
-                            fprintf(stderr, "Task queue full!\n");
-                        }
-                    } else if (r == 0) {
-                        printf("Client disconnected: fd=%d\n", fd);
-                        close(fd);
-                        epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL);
-                        free(buf);
-                        break;
-                    } else {
-                        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                            break;
-                        } else {
-                            perror("recv");
-                            close(fd);
-                            epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL);
-                            free(buf);
-                            break;
-                        }
-                    }
-                }
-            }
+        for (int i = 0; i < DB_WORKERS; i++) {
+            pthread_join(workers[i], NULL);
         }
+        mpmc_destroy(&g_queue);
+        conn_pool_destroy(g_pool);
     }
 
-    // 종료 처리
-    pthread_mutex_lock(&g_queue->lock);
-    g_queue->shutdown = 1;
-    pthread_cond_broadcast(&g_queue->cond);
-    pthread_mutex_unlock(&g_queue->lock);
-    
-    for (int i = 0; i < 4; i++) {
-        pthread_join(workers[i], NULL);
+    for (int i = 0; i < nreactor; i++) {
+        for (int j = 0; j < ASYNC_DB_CONNS; j++) {
+            if (reactors[i].db[j].conn)
+                PQfinish(reactors[i].db[j].conn);
+        }
+        if (reactors[i].epfd >= 0)
+            close(reactors[i].epfd);
+        close(reactors[i].listen_fd);
+        free(reactors[i].conns);
+        free(reactors[i].held_next);
+        free(reactors[i].held_len);
+        tw_destroy(&reactors[i].wheel);
     }
-
-    close(server_fd);
+    free(reactors);
+    rx_pool_destroy(&g_rx_pool);
     return 0;
 }
\ No newline at end of file
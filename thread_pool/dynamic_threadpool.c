@@ -11,15 +11,21 @@
 #include <sys/ipc.h>
 #include <sys/msg.h>
 #include <sys/time.h>
+#include <poll.h>
+#include "../connection_cas/slab.h"
+#include "../connection_cas/async_log.h"
+#include "../connection_cas/timer_wheel.h"
 #define mq_key 2024
 
 #define MAX 20
 #define MIN 4
+#define IDLE_TIMEOUT_MS 60000                                                       // 이 시간 동안 아무것도 안 보내면 연결 끊음
+#define TW_TICK_MS 100
 
 static int running = 0;
 static int waiting = 0;
-static int thread_id[MAX] = {0};
-static long end_time[MAX] = {0};
+static int thread_id[MAX + 1] = {0};                                                // 쓰레드 index (thread_que 는 MIN..MAX)
+static long end_time[MAX + 1] = {0};
 
 pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
@@ -38,39 +44,56 @@ struct Queue
 };
 static struct Queue* client_que;
 static struct Queue* thread_que;
+static slab_cache node_cache;                                                       // Node 할당 (append 마다 malloc 하지 않음)
+
+static timer_wheel idle_wheel;                                                      // 쓰레드별 idle 타이머 (reaper 쓰레드가 tick 처리)
+static pthread_mutex_t wheel_mutex = PTHREAD_MUTEX_INITIALIZER;
+static tw_timer idle_timer[MAX + 1];
+static int idle_sock[MAX + 1];
 
 int queue_len(struct Queue* que);
 struct Queue* queue_init();
-void append(struct Queue* que, int data);
+int append(struct Queue* que, int data);
 int popleft(struct Queue* que);
 void free_queue(struct  Queue* que);
 void error_handling(char *message);
-void* get_message(void* args);
+void* get_message_thread(void* args);
 void* gc(void* args);
+void* idle_reaper(void* args);
+void idle_timeout(tw_timer* t, void* ctx);
 
-int main(int argc, char *argv[]){
+int main(void){
 	int serv_sock;
 	int clnt_sock;
-    int str_len;
 	int pthread_id;
-	int input[2];
-	char message1[30] = "max connection";
-	char message2[30] = "plez wait";
 	
+	alog_init(STDOUT_FILENO, STDERR_FILENO);								// 로그는 flusher 스레드가 씀 (쓰레드를 만들기 전에)
+    slab_init(&node_cache, sizeof(struct Node));
     client_que = queue_init();
 	thread_que = queue_init();
 
-    pthread_t gc;                                                                       //msg_id 2l로 thread index 받기
+	pthread_t reaper;
 	pthread_t pthread_list[MAX + 1];
-	for(int i =0; i < MAX; i++){
+	for(int i =0; i < MAX + 1; i++){
 		thread_id[i] = i;
-	}												    //thread MAX개 생성 준비
+	}
+	for(int i = 0; i < MAX + 1; i++){
+		tw_timer_init(&idle_timer[i], idle_timeout);
+	}
+	if(tw_init(&idle_wheel, TW_TICK_MS, NULL) != 0){
+		error_handling("timerfd_create() error");
+		return 0;
+	}
+	pthread_create(&reaper, NULL, idle_reaper, NULL);												    //thread MAX개 생성 준비
 	for (int i = 0; i < MIN; i++){
-		pthread_create(&pthread_list[i], NULL, get_message_thread, (void*)thread_id + i);             // 최소 유지되는 쓰레드 생성
+		pthread_create(&pthread_list[i], NULL, get_message_thread, &thread_id[i]);             // 최소 유지되는 쓰레드 생성
         waiting++;
 	}
 	for (int i = MIN; i < MAX + 1; i++){                                                //생성할 수 있는 쓰레드 index 큐에 넣기
-		append(thread_que, i);
+		if (append(thread_que, i) < 0){
+			error_handling("append() error");
+			return 0;
+		}
 	}
 	struct sockaddr_in serv_addr;
 	struct sockaddr_in clnt_addr;
@@ -95,7 +118,7 @@ int main(int argc, char *argv[]){
 		return 0;
 	}
 
-	printf("server is listening!\n", clnt_sock);	
+	alog_info("server is listening!");
 	while(1) {
 	    clnt_sock=accept(serv_sock, (struct sockaddr*)&clnt_addr, &clnt_addr_size); 	// 연결요청이 있을 때 까지 함수는 반환되지 않음
         pthread_mutex_lock(&mutex);
@@ -107,70 +130,86 @@ int main(int argc, char *argv[]){
         if(running == MAX){
 			close(clnt_sock);
 		}else{
-            if (running == waiting++){                                                     //대기중인 쓰레드 없으면 생성
-				pthread_id = popoleft(thread_que);
-                pthread_create(&pthread_list[pthread_id], NULL, get_message_thread, (void*)thread_id + pthread_id);
+            if (running == waiting){                                                       //대기중인 쓰레드 없으면 생성
+				pthread_id = popleft(thread_que);
+                pthread_create(&pthread_list[pthread_id], NULL, get_message_thread, &thread_id[pthread_id]);
+                waiting++;
             }
-			running++;
-			append(client_que, clnt_sock);												//clnt_sock 큐에 넣기
-			pthread_cond_signal(&cond);
+			if (append(client_que, clnt_sock) < 0){									//clnt_sock 큐에 넣기
+				error_handling("append() error");
+				close(clnt_sock);
+			}else{
+				running++;
+				pthread_cond_signal(&cond);
+			}
 		}
 		pthread_mutex_unlock(&mutex);
     }
-	printf("server close\n");
+	alog_info("server close");
+	alog_shutdown();
 	close(serv_sock);
 	pthread_mutex_destroy(&mutex);
 	return 0;
 }
 void error_handling(char *message){
-	fputs(message, stderr);
-	fputc('\n', stderr);
+	alog_error("%s", message);
 }
 void* get_message_thread(void* args){
 	int pthread_id = *(int*) args;
+	pthread_detach(pthread_self());
     int str_len;
-    int temp;
 	int clnt_sock;  																	// client_sock 정보 받기
 	while(1){
     	pthread_mutex_lock(&mutex);
-		pthread_cond_wait(&cond, &mutex);
+		while(queue_len(client_que) == 0)												// signal 이 대기 전에 오면 놓치지 않도록
+			pthread_cond_wait(&cond, &mutex);
 		clnt_sock = popleft(client_que);												//클라이언트 큐에서 소켓 id pop
-        if (clnt_sock == 0){                                                    		//gc종료 스레드 큐에 스레드 index 넣기
-		    close(clnt_sock);
-			append(thread_que, pthread_id);
-    	    printf("socket id %d closed \n", clnt_sock);
-            end_time[running--] = (long)time(NULL);
+        if (clnt_sock == 0){                                                    		//gc종료 스레드 큐에 스레드 index 넣고 종료
+			if (append(thread_que, pthread_id) < 0)
+				error_handling("append() error");                                      	// index 는 다시 못 씀 (쓰레드만 줄어듦)
+            waiting--;
+    	    alog_info("thread %d exit", pthread_id);
             pthread_mutex_unlock(&mutex);
-            continue;
+            return NULL;
         }
 		pthread_mutex_unlock(&mutex);
 
-    	printf("socket id: %d thread id: %lu\n", clnt_sock, pthread_self());
+    	alog_info("socket id: %d thread id: %lu", clnt_sock, (unsigned long)pthread_self());
+		pthread_mutex_lock(&wheel_mutex);
+		idle_sock[pthread_id] = clnt_sock;
+		tw_arm(&idle_wheel, &idle_timer[pthread_id], IDLE_TIMEOUT_MS);
+		pthread_mutex_unlock(&wheel_mutex);
 		char message[30];													
 		while(1){
 		    str_len=read(clnt_sock, message, sizeof(message)-1);
 		    if(str_len==-1) {error_handling("read() error"); break;}
+		    if(str_len==0) break;                                                     	// 연결 끊김 (또는 idle_timeout 의 shutdown)
+			pthread_mutex_lock(&wheel_mutex);
+			tw_arm(&idle_wheel, &idle_timer[pthread_id], IDLE_TIMEOUT_MS);            	// O(1) 옮기기
+			pthread_mutex_unlock(&wheel_mutex);
+		    alog_debug("socket id %d: %.*s", clnt_sock, str_len, message);
 			str_len = send(clnt_sock, message, sizeof(message)-1, MSG_DONTWAIT);
     	    if(str_len == 0) error_handling("send error");
-    	    printf("socket id %d:", clnt_sock);
-    	    printf("%s\n", message);
     	}
+		pthread_mutex_lock(&wheel_mutex);
+		tw_cancel(&idle_wheel, &idle_timer[pthread_id]);                              	// close 뒤 같은 번호의 새 소켓을 끊지 않도록 먼저
+		pthread_mutex_unlock(&wheel_mutex);
 		pthread_mutex_lock(&mutex);
 		close(clnt_sock);
-    	printf("socket id %d closed \n", clnt_sock);                            		//쓰레드 대기
-		append(thread_que, thread_id); 
+    	alog_info("socket id %d closed", clnt_sock);                            		//쓰레드 대기 (index 는 쓰레드가 끝날 때까지 계속 씀)
         end_time[running--] = (long)time(NULL);                                            	//종료시간 현재 시간으로 변경
 		pthread_mutex_unlock(&mutex);
 	}
 	return NULL;
 }
 void* gc(void* args){
+	(void)args;
 	while(1){
 		pthread_mutex_lock(&mutex);
     	while (1){
     	    if(waiting == MIN || waiting == running) break;
     	    if((long)time(NULL) - end_time[waiting--] > 60){                                   // 현재 시간 받아서 비교
-				append(client_que, 0);
+				if (append(client_que, 0) < 0) break;
     	    }else{
     	        break;
     	    }
@@ -180,6 +219,26 @@ void* gc(void* args){
 	}
 }
 
+// timerfd 가 울릴 때만 깨어나 만료된 타이머의 콜백을 부름 (연결을 하나씩 보지 않음)
+void* idle_reaper(void* args){
+	(void)args;
+	struct pollfd pfd = { tw_fd(&idle_wheel), POLLIN, 0 };
+	while(1){
+		if(poll(&pfd, 1, -1) <= 0) continue;
+		pthread_mutex_lock(&wheel_mutex);
+		tw_expire(&idle_wheel);
+		pthread_mutex_unlock(&wheel_mutex);
+	}
+	return NULL;
+}
+// wheel_mutex 를 잡은 채로 불림. read 에 막혀 있는 쓰레드를 깨움 (read 가 0 을 반환 → close 는 쓰레드가)
+void idle_timeout(tw_timer* t, void* ctx){
+	(void)ctx;
+	int idx = (int)(t - idle_timer);
+	alog_info("socket id %d idle timeout", idle_sock[idx]);
+	shutdown(idle_sock[idx], SHUT_RDWR);
+}
+
 int queue_len(struct Queue* que){
     return que->node_cnt;
 }
@@ -190,8 +249,11 @@ struct Queue* queue_init(){
     new_queue->node_cnt = 0;
     return new_queue;
 };
-void append(struct Queue* que, int data){
-    struct Node* new_node = malloc(sizeof(struct Node));
+int append(struct Queue* que, int data){                                            // 0 = 성공, -1 = Node 할당 실패
+    struct Node* new_node = slab_alloc(&node_cache);
+    if (new_node == NULL)
+        return -1;
+    new_node->next = NULL;
     new_node->data = data;
     if (que->head == NULL){
         que->head = new_node;
@@ -202,6 +264,7 @@ void append(struct Queue* que, int data){
         que->tail = new_node;
         que->node_cnt++;
     }
+    return 0;
 }
 int popleft(struct Queue* que){
     if (que->head == NULL)
@@ -210,7 +273,7 @@ int popleft(struct Queue* que){
     que->head = poped_node->next;
     que->node_cnt--;
     int res = poped_node->data;
-    free(poped_node);
+    slab_free(&node_cache, poped_node);
     return res;
 }
 void free_queue(struct  Queue* que){
@@ -218,7 +281,7 @@ void free_queue(struct  Queue* que){
         struct Node* poped_node = que->head;
         que->head = poped_node->next;
         que->node_cnt--;
-        free(poped_node);        
+        slab_free(&node_cache, poped_node);        
     }
     free(que);   
 };